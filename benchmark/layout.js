@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+// Layout benchmark harness. Times the Yoga Node bindings on synthetic trees (deep nesting, wide flex rows, wrapped
+// grids and text lists with native and JS measure functions), then runs the native layout-benchmark executable, if it
+// has been built (node-gyp rebuild --with_benchmark=true), and writes all results as JSON.
+//
+// Usage: yarn benchmark [--iterations N] [--nodes N] [--out file.json]
+
+import fs from 'fs'
+import path from 'path'
+import os from 'os'
+import { spawnSync } from 'child_process'
+import { performance } from 'perf_hooks'
+import {
+  Node,
+  DIRECTION_LTR,
+  EDGE_ALL,
+  EDGE_HORIZONTAL,
+  FLEX_DIRECTION_ROW,
+  WRAP_WRAP,
+  ALIGN_FLEX_START,
+  UNIT_POINT,
+  UNIT_PERCENT,
+  UNIT_UNDEFINED,
+  STYLE_ALIGN_CONTENT,
+  STYLE_BORDER,
+  STYLE_FLEX_BASIS,
+  STYLE_FLEX_DIRECTION,
+  STYLE_FLEX_GROW,
+  STYLE_FLEX_SHRINK,
+  STYLE_FLEX_WRAP,
+  STYLE_HEIGHT,
+  STYLE_MARGIN,
+  STYLE_PADDING,
+  STYLE_WIDTH,
+  getInstanceCount,
+  getPoolStats,
+  reservePool,
+  shrinkPool
+} from '../lib/Core/Util/Yoga'
+import { loadFont, TextLayout } from '../lib/Core/Util/small-screen-lib'
+
+const DEFAULT_ITERATIONS = 20
+const DEFAULT_NODE_COUNT = 1000
+const WARMUP_ITERATIONS = 2
+const DEEP_CHAIN_LENGTH = 100
+const FONT_FILE = path.join(__dirname, '..', 'test', 'resources', 'OpenSans-Regular.ttf')
+const NATIVE_BENCHMARK = path.join(__dirname, '..', 'build', 'Release', 'layout-benchmark')
+const WORDS = [ 'lorem', 'ipsum', 'dolor', 'sit', 'amet', 'consectetur', 'adipiscing', 'elit' ]
+const PHASES = [ 'create', 'style', 'layout', 'relayout', 'release' ]
+
+function packStyle (...records) {
+  return new Float32Array([].concat(...records))
+}
+
+const ROOT_ROW_STYLE = packStyle(
+  [ STYLE_FLEX_DIRECTION, 0, UNIT_UNDEFINED, FLEX_DIRECTION_ROW ],
+  [ STYLE_WIDTH, 0, UNIT_POINT, 1280 ],
+  [ STYLE_HEIGHT, 0, UNIT_POINT, 720 ])
+const DEEP_STYLE = packStyle([ STYLE_PADDING, EDGE_ALL, UNIT_POINT, 1 ])
+const WIDE_CHILD_STYLE = packStyle(
+  [ STYLE_FLEX_GROW, 0, UNIT_UNDEFINED, 1 ],
+  [ STYLE_FLEX_BASIS, 0, UNIT_POINT, 0 ],
+  [ STYLE_MARGIN, EDGE_HORIZONTAL, UNIT_POINT, 1 ])
+const GRID_STYLE = packStyle(
+  [ STYLE_FLEX_DIRECTION, 0, UNIT_UNDEFINED, FLEX_DIRECTION_ROW ],
+  [ STYLE_FLEX_WRAP, 0, UNIT_UNDEFINED, WRAP_WRAP ],
+  [ STYLE_ALIGN_CONTENT, 0, UNIT_UNDEFINED, ALIGN_FLEX_START ],
+  [ STYLE_WIDTH, 0, UNIT_POINT, 1280 ])
+const GRID_CHILD_STYLE = packStyle(
+  [ STYLE_WIDTH, 0, UNIT_POINT, 120 ],
+  [ STYLE_HEIGHT, 0, UNIT_PERCENT, 10 ],
+  [ STYLE_MARGIN, EDGE_ALL, UNIT_POINT, 4 ],
+  [ STYLE_BORDER, EDGE_ALL, UNIT_POINT, 1 ])
+const LIST_STYLE = packStyle([ STYLE_WIDTH, 0, UNIT_POINT, 640 ])
+const ROW_STYLE = packStyle(
+  [ STYLE_FLEX_DIRECTION, 0, UNIT_UNDEFINED, FLEX_DIRECTION_ROW ],
+  [ STYLE_PADDING, EDGE_ALL, UNIT_POINT, 4 ])
+const TEXT_STYLE = packStyle([ STYLE_FLEX_SHRINK, 0, UNIT_UNDEFINED, 1 ])
+
+function words (i) {
+  const result = []
+
+  for (let w = 0; w < 4 + i % 12; w++) {
+    result.push(WORDS[(i + w) % WORDS.length])
+  }
+
+  return result.join(' ')
+}
+
+// Each suite builds a tree of Node objects and returns { root, styled: [ [ node, style ] ], leaf, nodes }.
+const SUITES = {
+  'deep' (count) {
+    const root = Node.create()
+    const styled = [ [ root, ROOT_ROW_STYLE ] ]
+    let parent
+
+    for (let i = 1; i < count; i++) {
+      const child = Node.create();
+
+      (i % DEEP_CHAIN_LENGTH === 1 ? root : parent).pushChild(child)
+      styled.push([ child, DEEP_STYLE ])
+      parent = child
+    }
+
+    return { root, styled, leaf: parent, nodes: count }
+  },
+
+  'wide' (count) {
+    const root = Node.create()
+    const styled = [ [ root, ROOT_ROW_STYLE ] ]
+    let child
+
+    for (let i = 1; i < count; i++) {
+      root.pushChild(child = Node.create())
+      styled.push([ child, WIDE_CHILD_STYLE ])
+    }
+
+    return { root, styled, leaf: child, nodes: count }
+  },
+
+  'grid' (count) {
+    const root = Node.create()
+    const styled = [ [ root, GRID_STYLE ] ]
+    let child
+
+    for (let i = 1; i < count; i++) {
+      root.pushChild(child = Node.create())
+      styled.push([ child, GRID_CHILD_STYLE ])
+    }
+
+    return { root, styled, leaf: child, nodes: count }
+  },
+
+  'text-native' (count, sample) {
+    return textList(count, (node, text) => node.setTextMeasure(new TextLayout(), sample, text, 0, false))
+  },
+
+  'text-js' (count, sample) {
+    return textList(count, (node, text) => {
+      const layout = new TextLayout()
+
+      node.setMeasureFunc((width, widthMode, height, heightMode) =>
+        layout.layout(text, sample, 0, false, width, widthMode, height, heightMode))
+    })
+  }
+}
+
+function textList (count, setMeasure) {
+  const root = Node.create()
+  const styled = [ [ root, LIST_STYLE ] ]
+  const rows = Math.max(count >> 1, 1)
+  let text
+
+  for (let i = 0; i < rows; i++) {
+    const row = Node.create()
+
+    text = Node.create()
+    setMeasure(text, words(i))
+    row.pushChild(text)
+    root.pushChild(row)
+    styled.push([ row, ROW_STYLE ], [ text, TEXT_STYLE ])
+  }
+
+  return { root, styled, leaf: text, nodes: rows * 2 + 1 }
+}
+
+function stats (suite, phase, nodes, samples) {
+  const sorted = samples.slice().sort((a, b) => a - b)
+  const sum = sorted.reduce((total, value) => total + value, 0)
+  const median = sorted[sorted.length >> 1]
+
+  return {
+    suite,
+    phase,
+    nodes,
+    iterations: sorted.length,
+    meanMs: sum / sorted.length,
+    medianMs: median,
+    minMs: sorted[0],
+    maxMs: sorted[sorted.length - 1],
+    nsPerNode: median * 1e6 / nodes
+  }
+}
+
+function runSuite (name, build, iterations, nodeCount, sample) {
+  const samples = PHASES.reduce((result, phase) => Object.assign(result, { [phase]: [] }), {})
+  let nodes = 0
+  let toggle = 0
+
+  for (let i = 0; i < WARMUP_ITERATIONS + iterations; i++) {
+    // Nodes come from the pool released by the previous iteration, exercising release / re-create.
+    const t0 = performance.now()
+    const tree = build(nodeCount, sample)
+    const t1 = performance.now()
+
+    for (const [ node, style ] of tree.styled) {
+      node.applyStyle(style, true)
+    }
+
+    const t2 = performance.now()
+
+    // calculateLayout() includes SyncComputedFields(). The native benchmark reports layout and sync separately.
+    tree.root.calculateLayout(NaN, NaN, DIRECTION_LTR, true)
+
+    const t3 = performance.now()
+
+    if (name.startsWith('text')) {
+      tree.leaf.markDirty()
+    } else {
+      tree.leaf.setMinHeight(toggle ^= 1)
+    }
+
+    tree.root.calculateLayout(NaN, NaN, DIRECTION_LTR, true)
+
+    const t4 = performance.now()
+
+    tree.root.release(true)
+
+    const t5 = performance.now()
+
+    if (i >= WARMUP_ITERATIONS) {
+      samples.create.push(t1 - t0)
+      samples.style.push(t2 - t1)
+      samples.layout.push(t3 - t2)
+      samples.relayout.push(t4 - t3)
+      samples.release.push(t5 - t4)
+    }
+
+    nodes = tree.nodes
+  }
+
+  return PHASES.map(phase => stats(name, phase, nodes, samples[phase]))
+}
+
+function runNative (iterations, nodeCount) {
+  if (!fs.existsSync(NATIVE_BENCHMARK)) {
+    return null
+  }
+
+  const result = spawnSync(NATIVE_BENCHMARK, [ String(iterations), String(nodeCount) ], { encoding: 'utf8' })
+
+  if (result.status !== 0) {
+    throw Error(`layout-benchmark failed: ${result.stderr}`)
+  }
+
+  return JSON.parse(result.stdout).results
+}
+
+function parseArgs (argv) {
+  const options = { iterations: DEFAULT_ITERATIONS, nodes: DEFAULT_NODE_COUNT, out: null }
+
+  for (let i = 0; i < argv.length; i++) {
+    switch (argv[i]) {
+      case '--iterations':
+        options.iterations = Math.max(parseInt(argv[++i], 10) || DEFAULT_ITERATIONS, 1)
+        break
+      case '--nodes':
+        options.nodes = Math.max(parseInt(argv[++i], 10) || DEFAULT_NODE_COUNT, 2)
+        break
+      case '--out':
+        options.out = argv[++i]
+        break
+      default:
+        throw Error(`Unknown argument: ${argv[i]}`)
+    }
+  }
+
+  return options
+}
+
+async function main () {
+  const options = parseArgs(process.argv.slice(2))
+  const fonts = await loadFont(FONT_FILE)
+  const sample = await fonts[0].createSample(16)
+  const results = []
+
+  reservePool(options.nodes)
+
+  for (const name of Object.keys(SUITES)) {
+    results.push(...runSuite(name, SUITES[name], options.iterations, options.nodes, sample))
+  }
+
+  const pool = getPoolStats()
+
+  shrinkPool()
+
+  if (getInstanceCount() !== 0) {
+    throw Error(`Benchmark leaked ${getInstanceCount()} nodes.`)
+  }
+
+  const report = {
+    benchmark: 'layout',
+    version: require('../package.json').version,
+    timestamp: new Date().toISOString(),
+    node: process.version,
+    platform: process.platform,
+    arch: process.arch,
+    cpu: (os.cpus()[0] || {}).model,
+    iterations: options.iterations,
+    pool,
+    results,
+    native: runNative(options.iterations, options.nodes)
+  }
+  const json = JSON.stringify(report, null, 2)
+
+  if (options.out) {
+    fs.writeFileSync(options.out, json + '\n')
+  } else {
+    console.log(json)
+  }
+}
+
+main().catch(e => {
+  console.error(e)
+  process.exit(1)
+})
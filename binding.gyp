@@ -2,6 +2,7 @@
   "variables": {
     "with_sdl_mixer%": "false",
     "with_cec%": "false",
+    "with_benchmark%": "false",
     "sdl_library_path%": "/usr/local/lib",
     "sdl_include_path%": "/usr/local/include/SDL2",
     "sdl_mixer_include_path%": "<(sdl_include_path)",
@@ -9,6 +10,11 @@
     "cec_include_path%": "/usr/include",
     "cec_library_path%": "/usr/lib"
   },
+  "target_defaults": {
+    "defines": [
+      "NAPI_VERSION=6"
+    ]
+  },
   "targets": [
     {
       "target_name": "common",
@@ -52,11 +58,17 @@
         "src/common/Util.cc",
         "src/common/Font.cc",
         "src/common/FontSample.cc",
+        "src/common/MappedFile.cc",
         "src/common/TextLayout.cc",
         "src/common/CapInsets.cc",
         "src/common/YogaValue.cc",
         "src/common/YogaNode.cc",
+        "src/common/ComputedFields.cc",
+        "src/common/FocusIndex.cc",
+        "src/common/ImageResample.cc",
+        "src/common/PixelPool.cc",
         "src/common/YogaGlobal.cc",
+        "src/common/CalculateLayoutAsyncWorker.cc",
       ]
     },
     {
@@ -106,7 +118,13 @@
       "sources": [
         "src/small-screen-lib/StbFont.cc",
         "src/small-screen-lib/StbFontSample.cc",
-        "src/small-screen-lib/LoadImageAsyncWorker.cc",
+        "src/small-screen-lib/FontSampleCache.cc",
+        "src/small-screen-lib/ImageDecodeTask.cc",
+        "src/small-screen-lib/ImageDecoder.cc",
+        "src/small-screen-lib/ImageCache.cc",
+        "src/small-screen-lib/ImageStream.cc",
+        "src/small-screen-lib/SvgCache.cc",
+        "src/small-screen-lib/DirectoryIndex.cc",
         "src/small-screen-lib/LoadStbFontAsyncWorker.cc",
         "src/small-screen-lib/LoadStbFontSampleAsyncWorker.cc",
         "src/small-screen-lib/Global.cc",
@@ -149,6 +167,7 @@
       "sources": [
         "src/small-screen-sdl/RoundedRectangleEffect.cc",
         "src/small-screen-sdl/SDLClient.cc",
+        "src/small-screen-sdl/FontTextureAtlas.cc",
         "src/small-screen-sdl/SDLRenderingContext.cc",
         "src/small-screen-sdl/SDLAudioContext.cc",
         "src/small-screen-sdl/SDLGamepad.cc",
@@ -211,6 +230,36 @@
         ]
       }
     ],
+    [
+      "with_benchmark==\"true\"",
+      {
+        "targets": [
+          {
+            "target_name": "layout-benchmark",
+            "type": "executable",
+            "include_dirs": [
+              "deps/yoga/lib",
+              "src/include"
+            ],
+            "dependencies": [
+              "deps/yoga/yoga.gyp:yoga"
+            ],
+            "cflags_cc!": [
+              "-fno-exceptions"
+            ],
+            "xcode_settings": {
+              "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+              "CLANG_CXX_LIBRARY": "libc++",
+              "MACOSX_DEPLOYMENT_TARGET": "10.7"
+            },
+            "sources": [
+              "src/benchmark/LayoutBenchmark.cc",
+              "src/common/ComputedFields.cc"
+            ]
+          }
+        ]
+      }
+    ],
     [
       "with_cec==\"true\"",
       {
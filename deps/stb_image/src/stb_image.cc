@@ -4,6 +4,8 @@
  * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
  */
 
+#include <PixelPool.h>
+
 #define STBI_NO_FAILURE_STRINGS
 #define STBI_NO_PSD
 #define STBI_NO_PIC
@@ -11,5 +13,9 @@
 #define STBI_NO_HDR
 #define STBI_NO_TGA
 #define STBI_NO_LINEAR
+// Decoded images, and the decoder's own buffers, come from the pixel pool.
+#define STBI_MALLOC(size) PixelPoolAlloc(size)
+#define STBI_REALLOC(pointer, size) PixelPoolRealloc(pointer, size)
+#define STBI_FREE(pointer) PixelPoolFree(pointer)
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
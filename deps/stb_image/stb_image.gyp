@@ -4,7 +4,8 @@
       "target_name": "stb_image",
       "type": "static_library",
       "include_dirs": [
-        "include"
+        "include",
+        "../../src/include"
       ],
       "cflags_cc!": [
         "-fno-exceptions"
@@ -16,19 +16,26 @@ import { InputManager } from '../Input/InputManager'
 import { ResourceManager } from '../Resource/ResourceManager'
 import { AnimationManager } from '../Animated/AnimationManager'
 import { FontStore } from '../Resource/FontStore'
+import { reservePool, shrinkPool } from '../Util/Yoga'
 
 let { now } = performance
 
+// Number of consecutive frames without drawing before the Yoga node pool is trimmed.
+const SHRINK_NODE_POOL_IDLE_FRAMES = 120
+
 export class Application extends FastEventEmitter {
   static Events = {
     frame: 'frame',
     closing: 'closing'
   }
 
-  constructor ({ platform, input, resource, animation, fontStore }) {
+  constructor ({ platform, input, resource, animation, fontStore, nodePoolSize, asyncLayout }) {
     super()
     this._mainLoopId = undefined
 
+    // Pre-create Yoga nodes, so the first mounts do not allocate.
+    nodePoolSize > 0 && reservePool(nodePoolSize)
+
     const window = platform.createWindow()
     const audio = platform.createAudioContext()
 
@@ -51,7 +58,7 @@ export class Application extends FastEventEmitter {
 
     this.window.onQuit = () => this.close()
 
-    this.layout = new LayoutManager()
+    this.layout = new LayoutManager({ async: asyncLayout })
     this.focus = new FocusManager()
 
     this.root = new RootView(this)
@@ -91,6 +98,7 @@ export class Application extends FastEventEmitter {
     const { window, animation, resource, layout } = this
     const { frame } = Application.Events
     let previousTick = now()
+    let idleFrames = 0
 
     // TODO: set fps from refresh rate
     if (!fps || fps < 0 || fps > 60) {
@@ -117,9 +125,13 @@ export class Application extends FastEventEmitter {
 
       this.emit(frame, delta)
 
+      // While an asynchronous layout is pending, frames are drawn from the last published layout.
       if (dirty || root.isDirty()) {
         root.draw(window.getContext(), width, height)
         window.present()
+        idleFrames = 0
+      } else if (++idleFrames === SHRINK_NODE_POOL_IDLE_FRAMES) {
+        shrinkPool()
       }
 
       previousTick = frameStartTick
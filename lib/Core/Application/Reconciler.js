@@ -15,6 +15,7 @@ import { TextView } from '../Views/TextView'
 import { BoxView } from '../Views/BoxView'
 import { ImageView } from '../Views/ImageView'
 import { performance } from 'perf_hooks'
+import { mutations } from '../Util/MutationLog'
 
 let TEXT = 'text'
 let BOX = 'box'
@@ -73,7 +74,10 @@ export function Reconciler (app) {
     },
 
     prepareForCommit () {
-      // noop
+      // Commits do not nest. If a previous commit threw before resetAfterCommit(), apply its mutations first.
+      mutations.reset()
+      // Yoga tree mutations made during the commit are applied in one native call in resetAfterCommit().
+      mutations.begin()
     },
 
     prepareUpdate (wordElement, type, oldProps, newProps) {
@@ -81,7 +85,7 @@ export function Reconciler (app) {
     },
 
     resetAfterCommit () {
-      // noop
+      mutations.end()
     },
 
     resetTextContent (wordElement) {
@@ -47,7 +47,7 @@ export class SDLWindow {
     this._SDL = SDL
     this.caps = SDL.capabilities()
 
-    const { defaultResolution, vsync, textureFormat } = this.caps
+    const { defaultResolution, vsync, textureFormat, packedTextureFormats } = this.caps
     const { width, height } = defaultResolution
 
     this.client = null
@@ -61,6 +61,10 @@ export class SDLWindow {
     this.vsync = vsync
     this.title = ''
     this.textureFormat = textureFormat
+    // 16 bit texture formats the renderer supports natively, selectable per image.
+    this.packedTextureFormats = packedTextureFormats || []
+    // Request premultiplied alpha textures. On attach, set to whether the renderer supports them.
+    this.premultipliedAlpha = true
     this.inputReceiver = {
       onDeviceKeyUp: emptyFunction,
       onDeviceKeyDown: emptyFunction,
@@ -161,13 +165,15 @@ export class SDLWindow {
       this.fullscreen,
       this.vsync,
       this.textureFormat,
-      this.caps.texturePixelFormat)
+      this.caps.texturePixelFormat,
+      this.premultipliedAlpha)
 
     this.width = this.client.getWidth()
     this.height = this.client.getHeight()
     this.screenWidth = this.client.getScreenWidth()
     this.screenHeight = this.client.getScreenHeight()
     this.fullscreen = this.client.isFullscreen()
+    this.premultipliedAlpha = this.client.isPremultipliedAlpha()
 
     this._context = new SDLRenderingContext(this.client)
     this.keyboard._resetKeys()
@@ -264,8 +270,8 @@ export class SDLWindow {
     }
   }
 
-  createTexture ({ width, height, buffer }) {
-    return this.client.createTexture(width, height, buffer)
+  createTexture ({ width, height, buffer, format, levelCount }) {
+    return this.client.createTexture(width, height, buffer, format, levelCount)
   }
 
   createFontTexture (font) {
@@ -276,6 +282,10 @@ export class SDLWindow {
     texturePtr && this.client.destroyTexture(texturePtr)
   }
 
+  destroyFontTexture (fontTexturePtr) {
+    fontTexturePtr && this.client.destroyFontTexture(fontTexturePtr)
+  }
+
   _onJoyDeviceAdded (index, timestamp) {
     if (this.gamepadsById.has(SDLGamepad.getIdForIndex(index))) {
       return
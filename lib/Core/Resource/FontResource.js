@@ -54,7 +54,7 @@ export class FontResource extends Resource {
   _detach ({ graphics }) {
     if (this.isAttached) {
       if (this.texture) {
-        graphics.destroyTexture(this.texture)
+        graphics.destroyFontTexture(this.texture)
         this.texture = undefined
       }
       this._transition(INIT)
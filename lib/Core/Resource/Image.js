@@ -4,46 +4,64 @@
  * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
  */
 
-import { loadImage, releaseImage } from '../Util/small-screen-lib'
+import {
+  loadImage,
+  cancelImage,
+  setImagePriority,
+  setImageConcurrency,
+  releaseImage,
+  ImageStream
+} from '../Util/small-screen-lib'
 import emptyObject from 'fbjs/lib/emptyObject'
-import { Queue } from '../Util/Queue'
 
-const queue = new Queue()
-let inflight = 0
-let concurrency = 2
+let concurrency = 0
 
 export class Image {
   /**
-   * The maximum number of concurrent image load requests that javascript will have open at any given time.
-   *
-   * When the maximum number of active requests is hit, subsequent requests will be queued in javascript. These
-   * queued requests are cancellable. The native layer has a queue and thread pool, but once an image loading request
-   * goes into the native code, it cannot be cancelled.
+   * Decode priority of images on screen. Decoded first.
+   */
+  static PRIORITY_VISIBLE = 0
+
+  /**
+   * Decode priority of images expected to be on screen soon.
+   */
+  static PRIORITY_PREFETCH = 1
+
+  /**
+   * Decode priority of images that are not needed soon.
+   */
+  static PRIORITY_BACKGROUND = 2
+
+  /**
+   * The number of native threads decoding images.
    *
-   * Note, at this stage of development, the javscript queue helps with image grid performance. But, it may be
-   * overkill if the grid can better throttle image requests.
+   * Images are decoded on threads dedicated to image loading, so decodes do not compete with file system requests
+   * on the libuv thread pool. Queued load requests are taken in priority order and remain cancellable until their
+   * decode starts. ImageStream sources are decoded on a separate, capped set of threads, so waiting for a download
+   * never holds these threads.
    *
-   * @returns {number} Maximum number of concurrent image requests.
+   * @returns {number} Number of decode threads. 0 means the default.
    */
   static get concurrency () {
     return concurrency
   }
 
   /**
-   * Set the maximum number of concurrent image load requests that javascript will have open at any given time.
+   * Set the number of native threads decoding images.
    *
-   * If size = 0, image load requests will never be queued in javascript.
+   * If size = 0, the default number of threads is used.
    *
-   * If size > 0, this will be the new maximum number of outstanding image load requests.
+   * If size > 0, this will be the new number of decode threads.
    *
    * If size < 0, an Error is thrown.
    *
-   * @param size {Number} New maximum.
+   * @param size {Number} New number of threads.
    */
   static set concurrency (size) {
     if (typeof size !== 'number' || size < 0) {
       throw Error('size must be an integer value >= 0.')
     }
+    setImageConcurrency(size)
     concurrency = size
   }
 
@@ -66,12 +84,25 @@ export class Image {
      * @type {Buffer}
      */
     this.buffer = null
+    /**
+     * Texture format of buffer. Available after the image is loaded.
+     *
+     * @type {number}
+     */
+    this.format = undefined
+    /**
+     * Number of mip levels in buffer, including the full size image. Available after the image is loaded.
+     *
+     * @type {number}
+     */
+    this.levelCount = 1
     /**
      * Was this image's load request cancelled?
      *
      * @type {boolean}
      */
     this.wasCancelled = false
+    this._request = null
   }
 
   /**
@@ -80,92 +111,91 @@ export class Image {
    * The image source can be a filename, a base64 encoded image file string or an SVG XML string. Use options.sourceType
    * to inform the load request what source is.
    *
-   * @param source Image load path.
+   * Concurrent loads of the same file or string, with the same options, share a single decode.
+   *
+   * The source can also be an ImageStream, for an image that is still being read, such as a download. Write chunks
+   * with stream.write(buffer) and finish with stream.end(), or stream.abort() to give up. The decode starts with the
+   * first chunk and runs while the rest arrives. A streamed image is not cached on disk.
+   *
+   * @param source Image load path, encoded image Buffer or ImageStream.
    * @param options.sourceType base64, xml (svg) or file path (default)
-   * @param options.width Resize loaded image to this width. SVG is the only image format that supports resizing.
-   * @param options.height Resize loaded image to this height. SVG is the only image format that supports resizing.
+   * @param options.width Resize loaded image to this width. If only one of width or height is set, the other is
+   * derived from the image's aspect ratio.
+   * @param options.height Resize loaded image to this height.
+   * @param options.priority Decode priority, one of the Image.PRIORITY_* values. Defaults to PRIORITY_VISIBLE.
+   * @param options.premultipliedAlpha If true, colors are premultiplied by alpha, for drawing with a premultiplied
+   * alpha blend mode.
+   * @param options.format Texture format of the decoded pixels. The 16 bit formats (10 = RGB565, 11 = RGBA4444,
+   * 12 = RGBA5551) halve the image's memory.
+   * @param options.dither If true, ordered dithering is applied when reducing pixels to a 16 bit format, trading
+   * banding in gradients for a fine, regular pattern.
+   * @param options.mipmaps If true, buffer is followed by a chain of levels, each half the width and height of the
+   * previous level, down to 8 pixels. Drawing a scaled down image from a smaller level is faster and smoother.
    * @returns {Promise<any>}
    */
   load (source, options) {
     options = options || emptyObject
 
-    if (concurrency !== 0 && inflight >= concurrency) {
-      return new Promise((resolve, reject) => {
-        queue.enqueue({
-          resolve,
-          reject,
-          image: this,
-          source,
-          options
-        })
+    return new Promise((resolve, reject) => {
+      const id = loadImage(source, options, (err, buffer, width, height, levelCount) => {
+        // The caller of this callback (in the native code) does not like exceptions..
+        try {
+          this._request = null
+
+          if (err) {
+            this.release()
+            reject(err)
+          } else {
+            this.buffer = buffer
+            this.width = width
+            this.height = height
+            this.format = options.format
+            this.levelCount = levelCount
+            resolve()
+          }
+        } catch (err) {
+          console.log('Something bad happened in the image loading callback!', err)
+        }
       })
-    } else {
-      return loadImageInternal(this, source, options)
-    }
+
+      this._request = { id, source, reject }
+    })
+  }
+
+  /**
+   * Change the decode priority of a pending load request.
+   *
+   * @param priority One of the Image.PRIORITY_* values.
+   */
+  setPriority (priority) {
+    this._request && setImagePriority(this._request.id, priority)
   }
 
   /**
    * Cancel the image loading request and release any native resources.
+   *
+   * A pending load request is removed from the native decode queue and its Promise is rejected. A streamed source
+   * is aborted, so a running decode does not wait for the rest of the stream.
    */
   release () {
+    const { _request } = this
+
     this.wasCancelled = true
 
-    if (this.buffer) {
-      releaseImage(this.buffer)
-      this.buffer = undefined
-    }
-  }
-}
+    if (_request) {
+      this._request = null
+      cancelImage(_request.id)
 
-function processNextLoadRequest () {
-  inflight--
+      if (_request.source instanceof ImageStream) {
+        _request.source.abort()
+      }
 
-  while (queue.length) {
-    const work = queue.dequeue()
+      _request.reject(Error(`Cancelled image load: ${_request.source}`))
+    }
 
-    if (!work.image.wasCancelled) {
-      loadImageInternal(work.image, work.source, work.options)
-        .then(() => {
-          if (!work.image.wasCancelled) {
-            work.resolve()
-          } else {
-            work.image.release()
-            work.reject(Error(`Cancelled image load: ${work.source}`))
-          }
-        })
-        .catch((err) => {
-          work.reject(err)
-        })
-      break
-    } else {
-      // Even though this request was cancelled, the Promise needs to be finished. reject() will notify listeners, so
-      // they will need to guard against callbacks from this request.
-      work.reject(Error(`Cancelled image load: ${work.source}`))
+    if (this.buffer) {
+      releaseImage(this.buffer)
+      this.buffer = undefined
     }
   }
 }
-
-function loadImageInternal (image, source, options) {
-  inflight++
-
-  return new Promise((resolve, reject) => {
-    loadImage(source, options, (err, buffer, width, height) => {
-      // The caller of this callback (in the native code) does not like exceptions..
-      try {
-        if (err) {
-          image.release()
-          reject(err)
-        } else {
-          image.buffer = buffer
-          image.width = width
-          image.height = height
-          resolve()
-        }
-
-        processNextLoadRequest()
-      } catch (err) {
-        console.log('Something bad happened in the image loading callback!', err)
-      }
-    })
-  })
-}
@@ -8,12 +8,29 @@ import { Resource } from './Resource'
 import { Image } from './Image'
 import fetch from 'node-fetch'
 import { SmallScreenError } from '../Util/SmallScreenError'
-import { CapInsets } from '../Util/small-screen-lib'
+import { CapInsets, ImageStream } from '../Util/small-screen-lib'
 import { abortController, SourceType } from '../Util'
 
 let { INIT, LOADING, LOADED, ATTACHED, ERROR } = Resource
 let { REMOTE, FILE, UTF8, BASE64 } = SourceType
 
+// Values of the textureFormat image option, mapped to native TextureFormat.
+const PACKED_TEXTURE_FORMATS = {
+  rgb565: 10,
+  rgba4444: 11,
+  rgba5551: 12
+}
+
+function streamBody (body) {
+  const stream = new ImageStream()
+
+  body.on('data', chunk => stream.write(chunk))
+  body.on('end', () => stream.end())
+  body.on('error', () => stream.abort())
+
+  return stream
+}
+
 export class ImageResource extends Resource {
   static EMPTY = new ImageResource({})
 
@@ -47,12 +64,8 @@ export class ImageResource extends Resource {
             return
           }
 
-          source = await res.buffer()
-
-          // If state changed after await, bail.
-          if (this._state !== LOADING) {
-            return
-          }
+          // The image is decoded as it downloads, rather than after the whole body is read.
+          source = streamBody(res.body)
         } catch (err) {
           if (err.name !== 'AbortError' && this._state === LOADING) {
             this._clearImage()
@@ -81,7 +94,13 @@ export class ImageResource extends Resource {
     const image = this._image = new Image()
 
     try {
-      await image.load(source, { ...this._src, format: graphics.textureFormat })
+      await image.load(source, {
+        ...this._src,
+        format: this._getTextureFormat(graphics),
+        premultipliedAlpha: graphics.premultipliedAlpha,
+        dither: !!this._src.dither,
+        mipmaps: !!this._src.mipmaps
+      })
 
       // If state changed after await, bail.
       if (this._state !== LOADING) {
@@ -108,6 +127,17 @@ export class ImageResource extends Resource {
     this._transition(LOADED)
   }
 
+  _getTextureFormat (graphics) {
+    const format = PACKED_TEXTURE_FORMATS[this._src.textureFormat]
+
+    // A 16 bit format the renderer cannot sample natively would be converted back to 32 bits on upload.
+    if (format !== undefined && (graphics.packedTextureFormats || []).includes(format)) {
+      return format
+    }
+
+    return graphics.textureFormat
+  }
+
   _attach ({ graphics }) {
     try {
       this.texture = graphics.createTexture(this._image)
@@ -131,6 +161,14 @@ export class ImageResource extends Resource {
     }
   }
 
+  _cancel () {
+    // Dropping the image cancels its decode, if it has not started, and rejects the pending load.
+    if (this._state === LOADING || this._state === LOADED) {
+      this._state = INIT
+      this._clearImage()
+    }
+  }
+
   _clearImage () {
     this._image && this._image.release()
     this._image = undefined
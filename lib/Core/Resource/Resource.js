@@ -41,6 +41,12 @@ export class Resource extends FastEventEmitter {
     return this._state === ERROR
   }
 
+  /**
+   * Stop an in-progress load. Called when the last reference to an unattached resource is released.
+   */
+  _cancel () {
+  }
+
   _transition (state, ...args) {
     const event = EVENT_NAMES.get(this._state = state)
 
@@ -21,6 +21,7 @@ const ATTACH = 2
 const SKIP = 3
 
 const RESOURCE_ERROR = Resource.ERROR
+const RESOURCE_LOADED = Resource.LOADED
 
 export class ResourceManager {
   constructor (devices) {
@@ -93,6 +94,8 @@ export class ResourceManager {
 
       if (isAttached && resource.isAttached) {
         resource._detach(_devices)
+      } else {
+        resource._cancel()
       }
 
       const item = _workQueue.find(item => item.id === id)
@@ -173,7 +176,7 @@ export class ResourceManager {
   _loadResource (id, resource) {
     resource._load(this._devices)
       .then(() => {
-        if (this.isAttached) {
+        if (this.isAttached && resource._state === RESOURCE_LOADED) {
           this._workQueue.enqueue({ id, resource, type: ATTACH })
         }
       })
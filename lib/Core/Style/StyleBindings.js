@@ -37,9 +37,36 @@ import {
   WRAP_NO_WRAP,
   WRAP_WRAP,
   WRAP_WRAP_REVERSE,
-  Node
+  STYLE_ALIGN_CONTENT,
+  STYLE_ALIGN_ITEMS,
+  STYLE_ALIGN_SELF,
+  STYLE_BORDER,
+  STYLE_DISPLAY,
+  STYLE_FLEX,
+  STYLE_FLEX_BASIS,
+  STYLE_FLEX_DIRECTION,
+  STYLE_FLEX_GROW,
+  STYLE_FLEX_SHRINK,
+  STYLE_FLEX_WRAP,
+  STYLE_HEIGHT,
+  STYLE_JUSTIFY_CONTENT,
+  STYLE_MARGIN,
+  STYLE_MAX_HEIGHT,
+  STYLE_MAX_WIDTH,
+  STYLE_MIN_HEIGHT,
+  STYLE_MIN_WIDTH,
+  STYLE_OVERFLOW,
+  STYLE_PADDING,
+  STYLE_POSITION,
+  STYLE_POSITION_TYPE,
+  STYLE_RECORD_SIZE,
+  STYLE_WIDTH,
+  UNIT_AUTO,
+  UNIT_PERCENT,
+  UNIT_POINT
 } from '../../Core/Util/Yoga'
 import { Value } from './Value'
+import { HINT_ANIMATED_PROPERTIES } from './Constants'
 
 const ALIGN = {
   auto: ALIGN_AUTO,
@@ -90,170 +117,148 @@ const OVERFLOW = {
   scroll: OVERFLOW_SCROLL
 }
 
-function getMethodNames (method) {
-  const { name } = method
+// Value types, which determine how a style value is validated and encoded.
+const TYPE_ENUM = 0
+const TYPE_NUMBER = 1
+const TYPE_NUMBER_OR_STRING = 2
+const TYPE_NUMBER_PERCENT = 3
+const TYPE_NUMBER_PERCENT_AUTO = 4
 
-  return [
-    name,
-    name + 'Percent',
-    name + 'Auto'
-  ]
+// style property -> [ Yoga style property id, edge, value type, enum lookup ]
+const BINDINGS = {
+  alignItems: [ STYLE_ALIGN_ITEMS, 0, TYPE_ENUM, ALIGN ],
+  alignContent: [ STYLE_ALIGN_CONTENT, 0, TYPE_ENUM, ALIGN ],
+  alignSelf: [ STYLE_ALIGN_SELF, 0, TYPE_ENUM, ALIGN ],
+  border: [ STYLE_BORDER, EDGE_ALL, TYPE_NUMBER_OR_STRING ],
+  borderLeft: [ STYLE_BORDER, EDGE_LEFT, TYPE_NUMBER_OR_STRING ],
+  borderTop: [ STYLE_BORDER, EDGE_TOP, TYPE_NUMBER_OR_STRING ],
+  borderRight: [ STYLE_BORDER, EDGE_RIGHT, TYPE_NUMBER_OR_STRING ],
+  borderBottom: [ STYLE_BORDER, EDGE_BOTTOM, TYPE_NUMBER_OR_STRING ],
+  display: [ STYLE_DISPLAY, 0, TYPE_ENUM, DISPLAY ],
+  flex: [ STYLE_FLEX, 0, TYPE_NUMBER ],
+  flexBasis: [ STYLE_FLEX_BASIS, 0, TYPE_NUMBER_PERCENT ],
+  flexGrow: [ STYLE_FLEX_GROW, 0, TYPE_NUMBER ],
+  flexShrink: [ STYLE_FLEX_SHRINK, 0, TYPE_NUMBER ],
+  flexWrap: [ STYLE_FLEX_WRAP, 0, TYPE_ENUM, FLEX_WRAP ],
+  flexDirection: [ STYLE_FLEX_DIRECTION, 0, TYPE_ENUM, FLEX_DIRECTION ],
+  height: [ STYLE_HEIGHT, 0, TYPE_NUMBER_PERCENT_AUTO ],
+  justifyContent: [ STYLE_JUSTIFY_CONTENT, 0, TYPE_ENUM, JUSTIFY ],
+  margin: [ STYLE_MARGIN, EDGE_ALL, TYPE_NUMBER_PERCENT_AUTO ],
+  marginLeft: [ STYLE_MARGIN, EDGE_LEFT, TYPE_NUMBER_PERCENT_AUTO ],
+  marginTop: [ STYLE_MARGIN, EDGE_TOP, TYPE_NUMBER_PERCENT_AUTO ],
+  marginRight: [ STYLE_MARGIN, EDGE_RIGHT, TYPE_NUMBER_PERCENT_AUTO ],
+  marginBottom: [ STYLE_MARGIN, EDGE_BOTTOM, TYPE_NUMBER_PERCENT_AUTO ],
+  maxHeight: [ STYLE_MAX_HEIGHT, 0, TYPE_NUMBER_PERCENT ],
+  maxWidth: [ STYLE_MAX_WIDTH, 0, TYPE_NUMBER_PERCENT ],
+  minHeight: [ STYLE_MIN_HEIGHT, 0, TYPE_NUMBER_PERCENT ],
+  minWidth: [ STYLE_MIN_WIDTH, 0, TYPE_NUMBER_PERCENT ],
+  overflow: [ STYLE_OVERFLOW, 0, TYPE_ENUM, OVERFLOW ],
+  padding: [ STYLE_PADDING, EDGE_ALL, TYPE_NUMBER_PERCENT ],
+  paddingLeft: [ STYLE_PADDING, EDGE_LEFT, TYPE_NUMBER_PERCENT ],
+  paddingTop: [ STYLE_PADDING, EDGE_TOP, TYPE_NUMBER_PERCENT ],
+  paddingRight: [ STYLE_PADDING, EDGE_RIGHT, TYPE_NUMBER_PERCENT ],
+  paddingBottom: [ STYLE_PADDING, EDGE_BOTTOM, TYPE_NUMBER_PERCENT ],
+  left: [ STYLE_POSITION, EDGE_LEFT, TYPE_NUMBER_PERCENT ],
+  top: [ STYLE_POSITION, EDGE_TOP, TYPE_NUMBER_PERCENT ],
+  right: [ STYLE_POSITION, EDGE_RIGHT, TYPE_NUMBER_PERCENT ],
+  bottom: [ STYLE_POSITION, EDGE_BOTTOM, TYPE_NUMBER_PERCENT ],
+  position: [ STYLE_POSITION_TYPE, 0, TYPE_ENUM, POSITION_TYPE ],
+  width: [ STYLE_WIDTH, 0, TYPE_NUMBER_PERCENT_AUTO ]
 }
 
-function makeSetNumberFunc (method) {
-  const [ point ] = getMethodNames(method)
+const BINDING_COUNT = Object.keys(BINDINGS).length
 
-  return (node, value) => {
-    if (typeof value === 'number') {
-      node[point](value)
-    }
-  }
-}
+// Style -> packed Float32Array for Node.applyStyle(). Styles are frozen, so the compiled buffer never goes stale.
+const compiledStyles = new WeakMap()
 
-function makeSetNumberPercentFunc (method) {
-  const [ point, percent ] = getMethodNames(method)
+// Buffers for compiling a style and binding a single (animated) property.
+const STYLE_BUFFER = new Float32Array(BINDING_COUNT * STYLE_RECORD_SIZE)
+const PROPERTY_BUFFER = new Float32Array(STYLE_RECORD_SIZE)
 
-  return (node, value) => {
-    const type = typeof value
+// Encode a style value as a record in target at offset. Returns the number of floats written, 0 if the value is invalid.
+function encode (target, offset, binding, value) {
+  const [ property, edge, type, lookup ] = binding
+  let unit = UNIT_POINT
 
-    if (type === 'number') {
-      node[point](value)
-    } else if (type === 'string' && value.endsWith('%')) {
-      const parsed = parseFloat(value)
+  switch (type) {
+    case TYPE_ENUM:
+      value = lookup[value]
 
-      if (!isNaN(parsed)) {
-        node[percent](parsed)
+      if (typeof value !== 'number') {
+        return 0
       }
-    }
-  }
-}
-
-function makeSetNumberPercentAutoFunc (method) {
-  const [ point, percent, auto ] = getMethodNames(method)
-
-  return (node, value) => {
-    const type = typeof value
-
-    if (type === 'number') {
-      node[point](value)
-    } else if (value === 'auto') {
-      node[auto](value)
-    } else if (type === 'string' && value.endsWith('%')) {
-      const parsed = parseFloat(value)
-
-      if (!isNaN(parsed)) {
-        node[percent](parsed)
+      break
+    case TYPE_NUMBER:
+      if (typeof value !== 'number') {
+        return 0
       }
-    }
-  }
-}
-
-function makeSetEdgeNumberFunc (edge, method) {
-  const [ point ] = getMethodNames(method)
-
-  return (node, value) => {
-    const type = typeof value
-
-    if (type === 'number') {
-      node[point](edge, value)
-    } else if (type === 'string') {
-      const parsed = parseFloat(value)
-
-      if (!isNaN(parsed)) {
-        node[point](edge, parsed)
+      break
+    case TYPE_NUMBER_OR_STRING:
+      if (typeof value === 'string') {
+        value = parseFloat(value)
+
+        if (isNaN(value)) {
+          return 0
+        }
+      } else if (typeof value !== 'number') {
+        return 0
       }
-    }
-  }
-}
-
-function makeSetEdgeNumberPercentFunc (edge, method) {
-  const [ point, percent ] = getMethodNames(method)
-
-  return (node, value) => {
-    const type = typeof value
-
-    if (type === 'number') {
-      node[point](edge, value)
-    } else if (type === 'string' && value.endsWith('%')) {
-      const parsed = parseFloat(value)
-
-      if (!isNaN(parsed)) {
-        node[percent](edge, parsed)
+      break
+    default:
+      if (typeof value === 'string') {
+        if (type === TYPE_NUMBER_PERCENT_AUTO && value === 'auto') {
+          unit = UNIT_AUTO
+          value = 0
+        } else if (value.endsWith('%') && !isNaN(value = parseFloat(value))) {
+          unit = UNIT_PERCENT
+        } else {
+          return 0
+        }
+      } else if (typeof value !== 'number') {
+        return 0
       }
-    }
+      break
   }
-}
 
-function makeSetEdgeNumberPercentAutoFunc (edge, method) {
-  const [ point, percent, auto ] = getMethodNames(method)
+  target[offset] = property
+  target[offset + 1] = edge
+  target[offset + 2] = unit
+  target[offset + 3] = value
 
-  return (node, value) => {
-    const type = typeof value
+  return STYLE_RECORD_SIZE
+}
 
-    if (type === 'number') {
-      node[point](edge, value)
-    } else if (value === 'auto') {
-      node[auto](edge, value)
-    } else if (type === 'string' && value.endsWith('%')) {
-      const parsed = parseFloat(value)
+// Compile the Yoga properties of a style into a packed buffer. Animated values are not included, as they can change
+// after compilation.
+function compileStyle (style) {
+  let offset = 0
+  let binding
+  let value
 
-      if (!isNaN(parsed)) {
-        node[percent](edge, parsed)
-      }
+  for (const property in style) {
+    if ((binding = BINDINGS[property]) && (value = style[property]) !== undefined && !(value instanceof Value)) {
+      offset += encode(STYLE_BUFFER, offset, binding, value)
     }
   }
-}
 
-const BINDINGS = {
-  alignItems: (node, value) => node.setAlignItems(ALIGN[value]),
-  alignContent: (node, value) => node.setAlignContent(ALIGN[value]),
-  alignSelf: (node, value) => node.setAlignSelf(ALIGN[value]),
-  border: makeSetEdgeNumberFunc(EDGE_ALL, Node.prototype.setBorder),
-  borderLeft: makeSetEdgeNumberFunc(EDGE_LEFT, Node.prototype.setBorder),
-  borderTop: makeSetEdgeNumberFunc(EDGE_TOP, Node.prototype.setBorder),
-  borderRight: makeSetEdgeNumberFunc(EDGE_RIGHT, Node.prototype.setBorder),
-  borderBottom: makeSetEdgeNumberFunc(EDGE_BOTTOM, Node.prototype.setBorder),
-  display: (node, value) => node.setDisplay(DISPLAY[value]),
-  flex: makeSetNumberFunc(Node.prototype.setFlex),
-  flexBasis: makeSetNumberPercentFunc(Node.prototype.setFlexBasis),
-  flexGrow: makeSetNumberFunc(Node.prototype.setFlexGrow),
-  flexShrink: makeSetNumberFunc(Node.prototype.setFlexShrink),
-  flexWrap: (node, value) => node.setFlexWrap(FLEX_WRAP[value]),
-  flexDirection: (node, value) => node.setFlexDirection(FLEX_DIRECTION[value]),
-  height: makeSetNumberPercentAutoFunc(Node.prototype.setHeight),
-  justifyContent: (node, value) => node.setJustifyContent(JUSTIFY[value]),
-  margin: makeSetEdgeNumberPercentAutoFunc(EDGE_ALL, Node.prototype.setMargin),
-  marginLeft: makeSetEdgeNumberPercentAutoFunc(EDGE_LEFT, Node.prototype.setMargin),
-  marginTop: makeSetEdgeNumberPercentAutoFunc(EDGE_TOP, Node.prototype.setMargin),
-  marginRight: makeSetEdgeNumberPercentAutoFunc(EDGE_RIGHT, Node.prototype.setMargin),
-  marginBottom: makeSetEdgeNumberPercentAutoFunc(EDGE_BOTTOM, Node.prototype.setMargin),
-  maxHeight: makeSetNumberPercentFunc(Node.prototype.setMaxHeight),
-  maxWidth: makeSetNumberPercentFunc(Node.prototype.setMaxWidth),
-  minHeight: makeSetNumberPercentFunc(Node.prototype.setMinHeight),
-  minWidth: makeSetNumberPercentFunc(Node.prototype.setMinWidth),
-  overflow: (node, value) => node.setOverflow(OVERFLOW[value]),
-  padding: makeSetEdgeNumberPercentFunc(EDGE_ALL, Node.prototype.setPadding),
-  paddingLeft: makeSetEdgeNumberPercentFunc(EDGE_LEFT, Node.prototype.setPadding),
-  paddingTop: makeSetEdgeNumberPercentFunc(EDGE_TOP, Node.prototype.setPadding),
-  paddingRight: makeSetEdgeNumberPercentFunc(EDGE_RIGHT, Node.prototype.setPadding),
-  paddingBottom: makeSetEdgeNumberPercentFunc(EDGE_BOTTOM, Node.prototype.setPadding),
-  left: makeSetEdgeNumberPercentFunc(EDGE_LEFT, Node.prototype.setPosition),
-  top: makeSetEdgeNumberPercentFunc(EDGE_TOP, Node.prototype.setPosition),
-  right: makeSetEdgeNumberPercentFunc(EDGE_RIGHT, Node.prototype.setPosition),
-  bottom: makeSetEdgeNumberPercentFunc(EDGE_BOTTOM, Node.prototype.setPosition),
-  position: (node, value) => node.setPositionType(POSITION_TYPE[value]),
-  width: makeSetNumberPercentAutoFunc(Node.prototype.setWidth)
+  return STYLE_BUFFER.slice(0, offset)
 }
 
 export function bindStyle (node, style) {
-  node.resetStyle()
+  let compiled = compiledStyles.get(style)
 
-  let binding
-  let value
+  if (!compiled) {
+    compiledStyles.set(style, (compiled = compileStyle(style)))
+  }
 
-  for (const property in style) {
-    if ((binding = BINDINGS[property]) && (value = style[property]) !== undefined) {
-      binding(node, value instanceof Value ? value._value : value)
+  // One native call resets the node style and applies all static properties.
+  node.applyStyle(compiled, true)
+
+  const animatedProperties = style[HINT_ANIMATED_PROPERTIES]
+
+  if (animatedProperties) {
+    for (const property of animatedProperties) {
+      bindStyleProperty(node, property, style[property])
     }
   }
 }
@@ -261,7 +266,8 @@ export function bindStyle (node, style) {
 export function bindStyleProperty (node, property, value) {
   let binding
 
-  if (value !== undefined && (binding = BINDINGS[property])) {
-    binding(node, value instanceof Value ? value._value : value)
+  if (value !== undefined && (binding = BINDINGS[property]) &&
+      encode(PROPERTY_BUFFER, 0, binding, value instanceof Value ? value._value : value)) {
+    node.applyStyle(PROPERTY_BUFFER, false)
   }
 }
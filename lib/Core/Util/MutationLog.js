@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+import {
+  MUTATION_INSERT_CHILD,
+  MUTATION_PUSH_CHILD,
+  MUTATION_RECORD_SIZE,
+  MUTATION_RELEASE,
+  MUTATION_REMOVE,
+  MUTATION_SEND_TO_BACK,
+  Node
+} from './Yoga'
+
+const INITIAL_CAPACITY = 256 * MUTATION_RECORD_SIZE
+
+/**
+ * Records Yoga tree mutations (push, insert, remove, send to back and release) during a React commit and applies
+ * them with a single native call at the end of the commit.
+ *
+ * Nodes are referenced by slot. A released node is not returned to the node pool until the log is flushed, so a slot
+ * cannot be reused while a record still refers to it.
+ *
+ * Redundant operations are coalesced against the previous record as they are recorded:
+ *
+ * - remove(child) + pushChild(parent, child) becomes sendToBack(child)
+ * - remove(child) + release(child) becomes release(child)
+ * - pushChild(parent, child) or insertChild(parent, child) + remove(child) cancel out
+ * - sendToBack(child) + sendToBack(child) becomes sendToBack(child)
+ *
+ * Outside of begin() / end(), mutations are applied to the node immediately.
+ *
+ * A batch that throws must still be ended, or later mutations would be recorded forever. batch() ends the batch in a
+ * finally block. Where begin() and end() are separate callbacks (React's prepareForCommit() and resetAfterCommit()),
+ * reset() recovers from a batch that was never ended.
+ */
+export class MutationLog {
+  constructor () {
+    this._records = new Int32Array(INITIAL_CAPACITY)
+    this._length = 0
+    this._depth = 0
+  }
+
+  get length () {
+    return this._length / MUTATION_RECORD_SIZE
+  }
+
+  begin () {
+    this._depth++
+  }
+
+  end () {
+    if (this._depth > 0 && --this._depth === 0) {
+      this.flush()
+    }
+  }
+
+  /**
+   * Run fn in a batch. The batch is ended, and its mutations applied, even if fn throws.
+   */
+  batch (fn) {
+    this.begin()
+
+    try {
+      return fn()
+    } finally {
+      this.end()
+    }
+  }
+
+  /**
+   * End all open batches and apply their mutations. The recorded mutations are applied, rather than discarded, as
+   * they mirror changes already made to the view tree.
+   */
+  reset () {
+    if (this._depth > 0) {
+      this._depth = 0
+      this.flush()
+    }
+  }
+
+  flush () {
+    if (this._length > 0) {
+      const length = this._length
+
+      this._length = 0
+      Node.applyMutations(this._records, length)
+    }
+  }
+
+  pushChild (node, child) {
+    if (!this._depth) {
+      node.pushChild(child)
+      return
+    }
+
+    if (this._isLast(MUTATION_REMOVE, child.slot, node.slot)) {
+      this._pop()
+      this._sendToBack(child)
+    } else {
+      this._push(MUTATION_PUSH_CHILD, node.slot, child.slot, 0)
+    }
+  }
+
+  insertChild (node, child, index) {
+    if (!this._depth) {
+      node.insertChild(child, index)
+      return
+    }
+
+    this._push(MUTATION_INSERT_CHILD, node.slot, child.slot, index)
+  }
+
+  remove (node, parent) {
+    if (!this._depth) {
+      node.remove()
+      return
+    }
+
+    const records = this._records
+    const last = this._length - MUTATION_RECORD_SIZE
+
+    if (last >= 0 && records[last + 2] === node.slot &&
+        (records[last] === MUTATION_PUSH_CHILD || records[last] === MUTATION_INSERT_CHILD)) {
+      this._pop()
+    } else {
+      // The parent slot is only used for coalescing. Native code removes the node from its current parent.
+      this._push(MUTATION_REMOVE, node.slot, parent ? parent.slot : -1, 0)
+    }
+  }
+
+  sendToBack (node) {
+    if (!this._depth) {
+      node.sendToBack()
+      return
+    }
+
+    this._sendToBack(node)
+  }
+
+  release (node) {
+    if (!this._depth) {
+      node.release(true)
+      return
+    }
+
+    if (this._isLast(MUTATION_REMOVE, node.slot)) {
+      this._pop()
+    }
+
+    this._push(MUTATION_RELEASE, node.slot, -1, 0)
+  }
+
+  _sendToBack (node) {
+    if (!this._isLast(MUTATION_SEND_TO_BACK, node.slot)) {
+      this._push(MUTATION_SEND_TO_BACK, node.slot, -1, 0)
+    }
+  }
+
+  _isLast (command, slot, child) {
+    const records = this._records
+    const last = this._length - MUTATION_RECORD_SIZE
+
+    return last >= 0 && records[last] === command && records[last + 1] === slot &&
+      (child === undefined || records[last + 2] === child)
+  }
+
+  _pop () {
+    this._length -= MUTATION_RECORD_SIZE
+  }
+
+  _push (command, slot, child, index) {
+    let records = this._records
+    const length = this._length
+
+    if (length + MUTATION_RECORD_SIZE > records.length) {
+      records = new Int32Array(records.length * 2)
+      records.set(this._records)
+      this._records = records
+    }
+
+    records[length] = command
+    records[length + 1] = slot
+    records[length + 2] = child
+    records[length + 3] = index
+
+    this._length = length + MUTATION_RECORD_SIZE
+  }
+}
+
+export const mutations = new MutationLog()
@@ -88,6 +88,55 @@ export const COMPUTED_MARGIN_RIGHT = 15
 export const COMPUTED_MARGIN_BOTTOM = 16
 export const COMPUTED_MARGIN_LEFT = 17
 
+// Number of computed fields per node in the Node.layout Float32Array. A node's fields start at
+// node.slot * COMPUTED_FIELD_COUNT. Node.layout is replaced when the array grows, so read it at the time of use.
+export const COMPUTED_FIELD_COUNT = 18
+
+// Style property ids for Node.applyStyle(). A packed style is a Float32Array of STYLE_RECORD_SIZE float records:
+// property, edge, unit and value.
+export const STYLE_ALIGN_CONTENT = 0
+export const STYLE_ALIGN_ITEMS = 1
+export const STYLE_ALIGN_SELF = 2
+export const STYLE_DISPLAY = 3
+export const STYLE_FLEX_DIRECTION = 4
+export const STYLE_FLEX_WRAP = 5
+export const STYLE_JUSTIFY_CONTENT = 6
+export const STYLE_OVERFLOW = 7
+export const STYLE_POSITION_TYPE = 8
+
+export const STYLE_FLEX = 9
+export const STYLE_FLEX_GROW = 10
+export const STYLE_FLEX_SHRINK = 11
+export const STYLE_FLEX_BASIS = 12
+
+export const STYLE_WIDTH = 13
+export const STYLE_HEIGHT = 14
+export const STYLE_MIN_WIDTH = 15
+export const STYLE_MIN_HEIGHT = 16
+export const STYLE_MAX_WIDTH = 17
+export const STYLE_MAX_HEIGHT = 18
+
+export const STYLE_BORDER = 19
+export const STYLE_MARGIN = 20
+export const STYLE_PADDING = 21
+export const STYLE_POSITION = 22
+
+export const STYLE_RECORD_SIZE = 4
+
+// Tree mutation commands for Node.applyMutations(). A mutation log is an Int32Array of MUTATION_RECORD_SIZE int
+// records: command, node slot, child slot and index.
+export const MUTATION_PUSH_CHILD = 0
+export const MUTATION_INSERT_CHILD = 1
+export const MUTATION_REMOVE = 2
+export const MUTATION_SEND_TO_BACK = 3
+export const MUTATION_RELEASE = 4
+
+export const MUTATION_RECORD_SIZE = 4
+
 export const getInstanceCount = lib.Yoga.getInstanceCount
+export const reservePool = lib.Yoga.reservePool
+export const shrinkPool = lib.Yoga.shrinkPool
+export const getPoolStats = lib.Yoga.getPoolStats
 export const Value = lib.Yoga.Value
 export const Node = lib.Yoga.Node
+export const FocusIndex = lib.Yoga.FocusIndex
@@ -10,6 +10,18 @@ const lib = bindings('small-screen-lib')
 
 export const CapInsets = lib.CapInsets
 export const TextLayout = lib.TextLayout
+export const ImageStream = lib.ImageStream
 export const loadImage = lib.loadImage
+export const cancelImage = lib.cancelImage
+export const setImagePriority = lib.setImagePriority
+export const setImageConcurrency = lib.setImageConcurrency
 export const releaseImage = lib.releaseImage
 export const loadFont = lib.loadFont
+export const setFontCacheDirectory = lib.setFontCacheDirectory
+export const getFontCacheDirectory = lib.getFontCacheDirectory
+export const setImageCacheDirectory = lib.setImageCacheDirectory
+export const getImageCacheDirectory = lib.getImageCacheDirectory
+export const getPixelPoolStats = lib.getPixelPoolStats
+export const setPixelPoolCacheLimit = lib.setPixelPoolCacheLimit
+export const trimPixelPool = lib.trimPixelPool
+export const getMappedFileStats = lib.getMappedFileStats
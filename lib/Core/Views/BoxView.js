@@ -10,10 +10,12 @@ import emptyObject from 'fbjs/lib/emptyObject'
 import { ImageResource } from '../Resource/ImageResource'
 import { getSourceId } from '../Util'
 import {
+  COMPUTED_FIELD_COUNT,
   COMPUTED_BORDER_BOTTOM, COMPUTED_BORDER_LEFT, COMPUTED_BORDER_RIGHT, COMPUTED_BORDER_TOP,
   COMPUTED_LAYOUT_HEIGHT, COMPUTED_LAYOUT_LEFT, COMPUTED_LAYOUT_TOP, COMPUTED_LAYOUT_WIDTH,
   COMPUTED_PADDING_BOTTOM, COMPUTED_PADDING_LEFT, COMPUTED_PADDING_RIGHT, COMPUTED_PADDING_TOP,
   EDGE_ALL,
+  Node,
   OVERFLOW_HIDDEN
 } from '../Util/Yoga'
 import {
@@ -43,7 +45,7 @@ export class BoxView extends View {
     const { focusDelegate, focusable, onKeyUp, onKeyDown, onFocus, onBlur } = this.props
 
     this.focusDelegate = focusDelegate
-    this.focusable = focusable
+    this._setFocusable(focusable)
     this.onKeyUp = onKeyUp
     this.onKeyDown = onKeyDown
     this.onFocus = onFocus
@@ -61,9 +63,11 @@ export class BoxView extends View {
   draw (ctx) {
     const { node, style } = this
     const clip = node.getOverflow() === OVERFLOW_HIDDEN
+    const { layout } = Node
+    const i = node.slot * COMPUTED_FIELD_COUNT
 
     ctx.pushStyle(style)
-    clip && ctx.pushClipRect(node[COMPUTED_LAYOUT_LEFT], node[COMPUTED_LAYOUT_TOP], node[COMPUTED_LAYOUT_WIDTH], node[COMPUTED_LAYOUT_HEIGHT])
+    clip && ctx.pushClipRect(layout[i + COMPUTED_LAYOUT_LEFT], layout[i + COMPUTED_LAYOUT_TOP], layout[i + COMPUTED_LAYOUT_WIDTH], layout[i + COMPUTED_LAYOUT_HEIGHT])
 
     if (!style[HINT_LAYOUT_ONLY]) {
       style[HINT_HAS_BORDER_RADIUS] ? this._drawRoundedBackground(ctx) : this._drawBackground(ctx)
@@ -114,8 +118,9 @@ export class BoxView extends View {
   updateProps (props) {
     super.updateProps(props)
 
-    const { onKeyUp, onKeyDown, onFocus, onBlur } = this.props
+    const { focusable, onKeyUp, onKeyDown, onFocus, onBlur } = this.props
 
+    this._setFocusable(focusable)
     this.onKeyUp = onKeyUp
     this.onKeyDown = onKeyDown
     this.onFocus = onFocus
@@ -148,11 +153,13 @@ export class BoxView extends View {
   _drawBackground (ctx) {
     const { style, node, _res } = this
     const { borderColor, backgroundColor, backgroundImage } = style
-    const [ dx, dy, dw, dh ] = getBackgroundClipOffsets(style, node)
-    const left = node[COMPUTED_LAYOUT_LEFT]
-    const top = node[COMPUTED_LAYOUT_TOP]
-    const width = node[COMPUTED_LAYOUT_WIDTH]
-    const height = node[COMPUTED_LAYOUT_HEIGHT]
+    const { layout } = Node
+    const i = node.slot * COMPUTED_FIELD_COUNT
+    const [ dx, dy, dw, dh ] = getBackgroundClipOffsets(style, layout, i)
+    const left = layout[i + COMPUTED_LAYOUT_LEFT]
+    const top = layout[i + COMPUTED_LAYOUT_TOP]
+    const width = layout[i + COMPUTED_LAYOUT_WIDTH]
+    const height = layout[i + COMPUTED_LAYOUT_HEIGHT]
 
     if (backgroundImage && _res.isAttached) {
       // TODO: add opacity, size, position and tint color support
@@ -182,10 +189,10 @@ export class BoxView extends View {
         top,
         width,
         height,
-        node[COMPUTED_BORDER_TOP],
-        node[COMPUTED_BORDER_RIGHT],
-        node[COMPUTED_BORDER_BOTTOM],
-        node[COMPUTED_BORDER_LEFT])
+        layout[i + COMPUTED_BORDER_TOP],
+        layout[i + COMPUTED_BORDER_RIGHT],
+        layout[i + COMPUTED_BORDER_BOTTOM],
+        layout[i + COMPUTED_BORDER_LEFT])
     }
   }
 
@@ -200,10 +207,12 @@ export class BoxView extends View {
       borderRadiusBottomRight,
       borderRadiusBottomLeft
     } = style
-    const left = node[COMPUTED_LAYOUT_LEFT]
-    const top = node[COMPUTED_LAYOUT_TOP]
-    const width = node[COMPUTED_LAYOUT_WIDTH]
-    const height = node[COMPUTED_LAYOUT_HEIGHT]
+    const { layout } = Node
+    const i = node.slot * COMPUTED_FIELD_COUNT
+    const left = layout[i + COMPUTED_LAYOUT_LEFT]
+    const top = layout[i + COMPUTED_LAYOUT_TOP]
+    const width = layout[i + COMPUTED_LAYOUT_WIDTH]
+    const height = layout[i + COMPUTED_LAYOUT_HEIGHT]
     const shouldDrawBorder = style[HINT_HAS_BORDER] && borderColor >= 0
     const topLeft = borderRadiusTopLeft || borderRadius || 0
     const topRight = borderRadiusTopRight || borderRadius || 0
@@ -211,7 +220,7 @@ export class BoxView extends View {
     const bottomLeft = borderRadiusBottomLeft || borderRadius || 0
 
     if (backgroundColor >= 0) {
-      const [ dx, dy, dw, dh ] = getBackgroundClipOffsets(style, node)
+      const [ dx, dy, dw, dh ] = getBackgroundClipOffsets(style, layout, i)
 
       // When the SVG renderer draws the border, the outer edges have anti-aliased pixels where the background
       // can be seen (creating a slight halo effect). So, shrink the background just a little to avoid poke through.
@@ -244,15 +253,15 @@ export class BoxView extends View {
   }
 }
 
-function getBackgroundClipOffsets (style, node) {
+function getBackgroundClipOffsets (style, layout, i) {
   if (style.backgroundClip === BACKGROUND_CLIP_PADDING_BOX) {
-    const dx = node[COMPUTED_PADDING_LEFT] + node[COMPUTED_BORDER_LEFT]
-    const dy = node[COMPUTED_PADDING_TOP] + node[COMPUTED_BORDER_TOP]
+    const dx = layout[i + COMPUTED_PADDING_LEFT] + layout[i + COMPUTED_BORDER_LEFT]
+    const dy = layout[i + COMPUTED_PADDING_TOP] + layout[i + COMPUTED_BORDER_TOP]
 
     OFFSETS[0] = dx
     OFFSETS[1] = dy
-    OFFSETS[2] = -(dx + node[COMPUTED_PADDING_RIGHT] + node[COMPUTED_BORDER_RIGHT])
-    OFFSETS[3] = -(dy + node[COMPUTED_PADDING_BOTTOM] + node[COMPUTED_BORDER_BOTTOM])
+    OFFSETS[2] = -(dx + layout[i + COMPUTED_PADDING_RIGHT] + layout[i + COMPUTED_BORDER_RIGHT])
+    OFFSETS[3] = -(dy + layout[i + COMPUTED_PADDING_BOTTOM] + layout[i + COMPUTED_BORDER_BOTTOM])
 
     return OFFSETS
   }
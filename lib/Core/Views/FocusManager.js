@@ -6,6 +6,7 @@
 
 import { Navigate } from './Navigate'
 import { Direction } from './Direction'
+import { FocusIndex } from '../Util/Yoga'
 
 let { DONE, SYNC_CHILD, ABORT, CONTINUE } = Navigate
 let { RIGHT } = Direction
@@ -13,6 +14,42 @@ let { RIGHT } = Direction
 export class FocusManager {
   focused = null
   _keyFinisher = null
+  _index = new FocusIndex()
+  _viewsByNode = new Map()
+
+  /**
+   * Add a focusable view to the spatial index used for directional navigation. The index tracks the view's absolute
+   * border box through layout changes until the view is unregistered. Views register themselves while they are
+   * focusable, visible and attached to the root view.
+   */
+  register (view) {
+    const { node } = view
+
+    this._viewsByNode.set(node, view)
+    this._index.add(node)
+  }
+
+  unregister (view) {
+    const { node } = view
+
+    if (this._viewsByNode.get(node) === view) {
+      this._viewsByNode.delete(node)
+      this._index.remove(node)
+    }
+  }
+
+  /**
+   * Find the nearest registered focusable view from view in a direction, using the laid out positions of the views.
+   *
+   * @param view Source view. It does not have to be registered.
+   * @param direction Direction.LEFT, RIGHT, UP or DOWN
+   * @returns {View|null}
+   */
+  findNext (view, direction) {
+    const node = view.node && this._index.findNext(view.node, direction)
+
+    return (node && this._viewsByNode.get(node)) || null
+  }
 
   _resolveFocusDelegate (view, navigate) {
     let chain = view
@@ -122,7 +159,15 @@ export class FocusManager {
         walker = walker.parent
       }
 
-      focusChanged = navigate.pending ? this._setFocus(navigate.pending, navigate) : false
+      // No focus delegate claimed the navigation. Take the candidate suggested by a delegate, falling back to the
+      // spatially nearest focusable view.
+      if (navigate.pending) {
+        focusChanged = this._setFocus(navigate.pending, navigate)
+      } else {
+        const next = this.findNext(this.focused, direction)
+
+        focusChanged = next ? this._setFocus(next, navigate, true) : false
+      }
 
       this._keyFinisher && this._keyFinisher(keyEvent.key, focusChanged)
     } else {
@@ -140,7 +185,8 @@ export class FocusManager {
   }
 
   destroy () {
-
+    this._viewsByNode.clear()
+    this._index.clear()
   }
 }
 
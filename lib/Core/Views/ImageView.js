@@ -10,8 +10,10 @@ import { ImageResource } from '../Resource/ImageResource'
 import { getSourceId } from '../Util'
 import emptyObject from 'fbjs/lib/emptyObject'
 import {
+  COMPUTED_FIELD_COUNT,
   COMPUTED_LAYOUT_HEIGHT, COMPUTED_LAYOUT_LEFT, COMPUTED_LAYOUT_TOP, COMPUTED_LAYOUT_WIDTH,
   COMPUTED_PADDING_BOTTOM, COMPUTED_PADDING_LEFT, COMPUTED_PADDING_RIGHT, COMPUTED_PADDING_TOP,
+  Node,
   OVERFLOW_HIDDEN
 } from '../Util/Yoga'
 import { TYPE_POINT, TYPE_PERCENT, TYPE_RIGHT, TYPE_BOTTOM } from '../Style/ObjectPosition'
@@ -40,7 +42,7 @@ export class ImageView extends View {
     const { focusDelegate, focusable, onKeyUp, onKeyDown, onFocus, onBlur, onLoad, onError, src } = this.props
 
     this.focusDelegate = focusDelegate
-    this.focusable = focusable
+    this._setFocusable(focusable)
     this.onKeyUp = onKeyUp
     this.onKeyDown = onKeyDown
     this.onFocus = onFocus
@@ -75,12 +77,14 @@ export class ImageView extends View {
     }
 
     const clip = node.getOverflow() === OVERFLOW_HIDDEN
-    const paddingLeft = node[COMPUTED_PADDING_LEFT]
-    const paddingTop = node[COMPUTED_PADDING_TOP]
-    const left = node[COMPUTED_LAYOUT_LEFT] + paddingLeft
-    const top = node[COMPUTED_LAYOUT_TOP] + paddingTop
-    const width = node[COMPUTED_LAYOUT_WIDTH] - (paddingLeft + node[COMPUTED_PADDING_RIGHT])
-    const height = node[COMPUTED_LAYOUT_HEIGHT] - (paddingTop + node[COMPUTED_PADDING_BOTTOM])
+    const { layout } = Node
+    const i = node.slot * COMPUTED_FIELD_COUNT
+    const paddingLeft = layout[i + COMPUTED_PADDING_LEFT]
+    const paddingTop = layout[i + COMPUTED_PADDING_TOP]
+    const left = layout[i + COMPUTED_LAYOUT_LEFT] + paddingLeft
+    const top = layout[i + COMPUTED_LAYOUT_TOP] + paddingTop
+    const width = layout[i + COMPUTED_LAYOUT_WIDTH] - (paddingLeft + layout[i + COMPUTED_PADDING_RIGHT])
+    const height = layout[i + COMPUTED_LAYOUT_HEIGHT] - (paddingTop + layout[i + COMPUTED_PADDING_BOTTOM])
 
     ctx.setStyle(style)
     clip && ctx.pushClipRect(left, top, width, height)
@@ -158,7 +162,7 @@ export class ImageView extends View {
     const { focusDelegate, focusable, onKeyUp, onKeyDown, onFocus, onBlur, onLoad, onError } = this.props
 
     this.focusDelegate = focusDelegate
-    this.focusable = focusable
+    this._setFocusable(focusable)
     this.onKeyUp = onKeyUp
     this.onKeyDown = onKeyDown
     this.onFocus = onFocus
@@ -4,65 +4,124 @@
  * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
  */
 
-import { DIRECTION_LTR } from '../Util/Yoga'
+import {
+  COMPUTED_FIELD_COUNT, COMPUTED_LAYOUT_HEIGHT, COMPUTED_LAYOUT_LEFT, COMPUTED_LAYOUT_TOP, COMPUTED_LAYOUT_WIDTH,
+  DIRECTION_LTR,
+  Node
+} from '../Util/Yoga'
 
 export class LayoutManager {
   // Add LayoutController (static to view?)
 
-  _listeners = new Set()
-  _layoutSnapshots = new Map()
+  // Yoga Node -> View
+  _listeners = new Map()
+
+  /**
+   * @param {boolean} [async] Calculate layout on a worker thread. See Node.calculateLayoutAsync(). Trees containing
+   * javascript measure functions (ImageView) are still laid out synchronously.
+   */
+  constructor ({ async } = {}) {
+    this._async = !!async
+    this._pending = null
+    this._published = false
+  }
+
+  /**
+   * @returns {boolean} true while an asynchronous layout is running. Until it completes, the tree is drawn using the
+   * last published layout.
+   */
+  isPending () {
+    return !!this._pending
+  }
 
+  /**
+   * Lay out the tree of node, if it is dirty.
+   *
+   * In async mode, the layout is started on a worker thread and published by a later run.
+   *
+   * @returns {boolean} true if a new layout was published since the last run, either by this run or by a completed
+   * asynchronous layout, so the frame needs to be redrawn. Otherwise, false.
+   */
   run (node, width, height) {
-    if (!node.isDirty()) {
-      return
+    if (this._pending) {
+      return false
     }
 
-    const hasListeners = this._listeners.size > 0
+    if (this._published) {
+      // An asynchronous layout was published since the last run. Draw it before starting another layout.
+      this._published = false
+      return true
+    }
 
-    if (hasListeners) {
-      this._beforeLayout()
+    if (!node.isDirty()) {
+      return false
     }
 
-    node.calculateLayout(width, height, DIRECTION_LTR)
+    const returnChangedNodes = this._listeners.size > 0
 
-    if (hasListeners) {
-      this._afterLayout()
-    }
-  }
+    if (this._async) {
+      this._pending = node.calculateLayoutAsync(width, height, DIRECTION_LTR, returnChangedNodes)
+        .then(changed => {
+          this._pending = null
+          this._published = true
+          this._listeners && this._notify(changed)
+        }, e => {
+          // The layout fence has already been lowered by the native layer.
+          this._pending = null
+          console.log('Asynchronous layout failed. Falling back to synchronous layout.', e)
 
-  _beforeLayout () {
-    const snapshots = this._layoutSnapshots
+          const changed = node.calculateLayout(width, height, DIRECTION_LTR, returnChangedNodes)
 
-    snapshots.clear()
+          this._published = true
+          this._listeners && this._notify(changed)
+        })
 
-    for (const view of this._listeners) {
-      snapshots.set(view, view.node.getBorderBox())
+      return false
     }
-  }
 
-  _afterLayout () {
-    const snapshots = this._layoutSnapshots
+    if (!returnChangedNodes) {
+      node.calculateLayout(width, height, DIRECTION_LTR)
+      return true
+    }
 
-    for (const view of this._listeners) {
-      const before = snapshots.get(view)
-      const after = view.node.getBorderBox()
+    // calculateLayout() returns the nodes whose computed layout actually changed.
+    this._notify(node.calculateLayout(width, height, DIRECTION_LTR, true))
 
-      if (before[0] !== after[0] || before[1] !== after[1] || before[2] !== after[2] || before[3] !== after[3]) {
-        view.onLayout(...after)
-      }
-    }
+    return true
   }
 
   on (view) {
-    this._listeners.add(view)
+    this._listeners.set(view.node, view)
   }
 
   off (view) {
-    this._listeners.delete(view)
+    this._listeners.delete(view.node)
   }
 
   destroy () {
     this._listeners = undefined
-    this._layoutSnapshots = undefined
+  }
+
+  _notify (changed) {
+    if (!changed || changed.length === 0) {
+      return
+    }
+
+    const listeners = this._listeners
+    const { layout } = Node
+
+    for (const changedNode of changed) {
+      const view = listeners.get(changedNode)
+
+      if (view) {
+        const i = changedNode.slot * COMPUTED_FIELD_COUNT
+
+        view.onLayout(
+          layout[i + COMPUTED_LAYOUT_LEFT],
+          layout[i + COMPUTED_LAYOUT_TOP],
+          layout[i + COMPUTED_LAYOUT_WIDTH],
+          layout[i + COMPUTED_LAYOUT_HEIGHT])
+      }
+    }
   }
 }
@@ -19,6 +19,7 @@ export class RootView extends View {
   constructor (app) {
     super({ style: Style({ position: 'absolute', top: 0, right: 0, bottom: 0, left: 0 }) }, app, true)
     this._isDirty = true
+    this._isDisplayed = true
   }
 
   getViewById (id) {
@@ -9,7 +9,9 @@ import { TEXT_OVERFLOW_ELLIPSIS, TEXT_TRANSFORM_LOWERCASE, TEXT_TRANSFORM_UPPERC
 import { Style } from '../Style/Style'
 import { TextLayout } from '../Util/small-screen-lib'
 import { Value } from '../Style/Value'
-import { COMPUTED_LAYOUT_HEIGHT, COMPUTED_LAYOUT_LEFT, COMPUTED_LAYOUT_TOP, COMPUTED_LAYOUT_WIDTH } from '../Util/Yoga'
+import {
+  COMPUTED_FIELD_COUNT, COMPUTED_LAYOUT_HEIGHT, COMPUTED_LAYOUT_LEFT, COMPUTED_LAYOUT_TOP, COMPUTED_LAYOUT_WIDTH, Node
+} from '../Util/Yoga'
 
 const FONT_STYLE_KEYS = [ 'fontFamily', 'fontWeight', 'fontStyle', 'fontSize' ]
 const FONT_DISPLAY_KEYS = [ 'maxLines', 'textOverflow', 'lineHeight' ]
@@ -18,27 +20,6 @@ export class TextView extends View {
   constructor (props, app) {
     super(props, app, false)
 
-    this.node.setMeasureFunc((width, widthMeasureMode, height, heightMeasureMode) => {
-      const { _res, style, _layout, text } = this
-
-      if (!_res || !_res.font) {
-        return // undefined equivalent to { width: 0, height: 0 }
-      }
-
-      const { maxLines, textOverflow } = style
-
-      return _layout.layout(
-        text,
-        _res.font,
-        maxLines,
-        textOverflow === TEXT_OVERFLOW_ELLIPSIS,
-        width,
-        widthMeasureMode,
-        height,
-        heightMeasureMode
-      )
-    })
-
     this.text = ''
     this._res = null
     this._layout = new TextLayout()
@@ -55,15 +36,17 @@ export class TextView extends View {
 
     const { node, _layout, style } = this
     const { maxLines, textOverflow, textAlign, rotate } = style
+    const { layout } = Node
+    const i = node.slot * COMPUTED_FIELD_COUNT
 
     ctx.setStyle(style)
 
     ctx.drawText(
       text,
-      node[COMPUTED_LAYOUT_LEFT],
-      node[COMPUTED_LAYOUT_TOP],
-      node[COMPUTED_LAYOUT_WIDTH],
-      node[COMPUTED_LAYOUT_HEIGHT],
+      layout[i + COMPUTED_LAYOUT_LEFT],
+      layout[i + COMPUTED_LAYOUT_TOP],
+      layout[i + COMPUTED_LAYOUT_WIDTH],
+      layout[i + COMPUTED_LAYOUT_HEIGHT],
       _res,
       _layout,
       textAlign || 0,
@@ -105,6 +88,7 @@ export class TextView extends View {
       } else {
         font.once('loaded', (resource) => {
           if (resource === this._res) {
+            this._syncTextMeasure()
             this.node.markDirty()
           }
         })
@@ -116,6 +100,15 @@ export class TextView extends View {
 
     this.style = style
     this.text = text
+    this._syncTextMeasure()
+  }
+
+  _syncTextMeasure () {
+    const { _res, style, _layout, text } = this
+    const { maxLines, textOverflow } = style
+
+    // Yoga measures the text natively, without calling back into javascript.
+    this.node.setTextMeasure(_layout, (_res && _res.font) || null, text, maxLines, textOverflow === TEXT_OVERFLOW_ELLIPSIS)
   }
 
   updateProps (props) {
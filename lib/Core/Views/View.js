@@ -4,9 +4,10 @@
  * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
  */
 
-import { COMPUTED_LAYOUT_LEFT, COMPUTED_LAYOUT_TOP, Node } from '../Util/Yoga'
+import { COMPUTED_FIELD_COUNT, COMPUTED_LAYOUT_LEFT, COMPUTED_LAYOUT_TOP, Node } from '../Util/Yoga'
 import { Style } from '../Style'
 import { bindStyle, bindStyleProperty } from '../Style/StyleBindings'
+import { mutations } from '../Util/MutationLog'
 import emptyObject from 'fbjs/lib/emptyObject'
 import { HINT_ANIMATED_PROPERTIES } from '../Style/Constants'
 
@@ -26,6 +27,9 @@ export class View {
     this.visible = visible === undefined ? true : !!visible
     this.id = id
     this.valuesListeners = null
+    this._isFocusIndexed = false
+    // true if this view and its ancestors are visible and attached to the root view.
+    this._isDisplayed = false
 
     if ((this.onLayout = onLayout)) {
       this._addLayoutListener()
@@ -42,10 +46,15 @@ export class View {
     const { children, node } = this
 
     if (children.length) {
-      ctx.shift(node[COMPUTED_LAYOUT_LEFT], node[COMPUTED_LAYOUT_TOP])
+      const { layout } = Node
+      const i = node.slot * COMPUTED_FIELD_COUNT
+
+      ctx.shift(layout[i + COMPUTED_LAYOUT_LEFT], layout[i + COMPUTED_LAYOUT_TOP])
 
       for (const child of children) {
-        child.visible && child.draw(ctx)
+        // A child added while an asynchronous layout is running has not been laid out yet (undefined layout).
+        child.visible && !isNaN(layout[child.node.slot * COMPUTED_FIELD_COUNT + COMPUTED_LAYOUT_LEFT]) &&
+          child.draw(ctx)
       }
 
       ctx.unshift()
@@ -60,16 +69,17 @@ export class View {
       // If React wants to move an existing child to the end, it will just call append without calling
       // remove. Lets move the child to the end. For the Yoga node, we are not allowed to call markDirty,
       // to the node must be removed and re-added to ensure a re-layout later.
-      child.node.sendToBack()
+      mutations.sendToBack(child.node)
       children.splice(children.indexOf(child), 1)
     } else if (!parent) {
       child.parent = this
-      node.pushChild(child.node)
+      mutations.pushChild(node, child.node)
     } else {
       throw Error('Cannot append child that already has a parent!')
     }
 
     children.push(child)
+    child._setDisplayed(this._isDisplayed)
 
     _app.root._isDirty = true
   }
@@ -84,7 +94,8 @@ export class View {
 
     children.splice(beforeIndex, 0, child)
     child.parent = this
-    node.insertChild(child.node, beforeIndex)
+    mutations.insertChild(node, child.node, beforeIndex)
+    child._setDisplayed(this._isDisplayed)
 
     _app.root._isDirty = true
   }
@@ -99,9 +110,10 @@ export class View {
 
     children.splice(index, 1)
     child.parent = undefined
+    child._setDisplayed(false)
 
     // Let the caller decide to release Yoga resources with destroy() to allow attach-reattach use cases.
-    child.node.remove()
+    mutations.remove(child.node, this.node)
 
     _app.root._isDirty = true
   }
@@ -115,6 +127,7 @@ export class View {
     }
 
     this.visible = (visible === undefined ? true : !!visible)
+    this._setDisplayed(this.parent ? this.parent._isDisplayed : this === this._app.root)
 
     // TODO: Check if props have actually changed before marking dirty.
     this._app.root._isDirty = true
@@ -145,12 +158,13 @@ export class View {
       try {
         this._destroyHook()
       } finally {
-        node.release(true)
+        mutations.release(node)
       }
     }
   }
 
   _destroyHook () {
+    this._isFocusIndexed && this._app.focus.unregister(this)
     this._removeLayoutListener()
     this._clearValuesListeners()
 
@@ -166,6 +180,35 @@ export class View {
     this._app.focus.setFocus(this)
   }
 
+  _setFocusable (focusable) {
+    this.focusable = focusable
+    this._updateFocusIndex()
+  }
+
+  _updateFocusIndex () {
+    // Displayed focusable views are tracked by the focus manager's spatial index for directional navigation.
+    const indexed = this._isDisplayed && !!this.focusable
+
+    if (indexed !== this._isFocusIndexed) {
+      this._isFocusIndexed = indexed
+      indexed ? this._app.focus.register(this) : this._app.focus.unregister(this)
+    }
+  }
+
+  _setDisplayed (parentDisplayed) {
+    const displayed = parentDisplayed && this.visible
+
+    // The subtree is already in sync when this view's state does not change.
+    if (displayed !== this._isDisplayed) {
+      this._isDisplayed = displayed
+      this._updateFocusIndex()
+
+      for (const child of this.children) {
+        child._setDisplayed(displayed)
+      }
+    }
+  }
+
   _addLayoutListener () {
     this._app.layout.on(this)
   }
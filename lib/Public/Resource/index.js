@@ -6,6 +6,22 @@
 
 import { resource } from '..'
 import { join, isAbsolute } from 'path'
+import {
+  setFontCacheDirectory,
+  getFontCacheDirectory,
+  setImageCacheDirectory,
+  getImageCacheDirectory,
+  getPixelPoolStats,
+  setPixelPoolCacheLimit,
+  trimPixelPool
+} from '../../Core/Util/small-screen-lib'
+import { SDL } from '../../Core/Platform/small-screen-sdl'
+
+// Each native addon links its own pixel pool: small-screen-lib decodes images, small-screen-sdl rasterizes effects.
+const pixelPools = [
+  { getPixelPoolStats, setPixelPoolCacheLimit, trimPixelPool },
+  SDL.getPixelPoolStats ? SDL : null
+].filter(pool => pool)
 
 export class Resource {
   /**
@@ -22,6 +38,80 @@ export class Resource {
     return resource().path
   }
 
+  /**
+   * Set the directory where rendered font samples are cached between runs. Relative paths are resolved against the
+   * resource path. Pass null to disable the cache (the default).
+   *
+   * Fonts added after this call use the cache.
+   */
+  static setFontCachePath (path) {
+    setFontCacheDirectory(path && (isAbsolute(path) ? path : join(resource().path, path)))
+  }
+
+  /**
+   * Get the font sample cache directory, or null if the cache is disabled.
+   */
+  static getFontCachePath () {
+    return getFontCacheDirectory()
+  }
+
+  /**
+   * Set the directory where decoded images are cached between runs. Relative paths are resolved against the resource
+   * path. Pass null to disable the cache (the default).
+   *
+   * Images are cached resized and converted to the texture format, so a cached image loads without decoding. When
+   * the cache grows past maxSize bytes (default 128MB), the least recently used images are removed.
+   *
+   * Images loaded after this call use the cache.
+   */
+  static setImageCachePath (path, maxSize) {
+    setImageCacheDirectory(path && (isAbsolute(path) ? path : join(resource().path, path)), maxSize)
+  }
+
+  /**
+   * Get the image cache directory, or null if the cache is disabled.
+   */
+  static getImageCachePath () {
+    return getImageCacheDirectory()
+  }
+
+  /**
+   * Get the occupancy of the pools that decoded image and rasterized effect pixels are allocated from.
+   *
+   * Returns { usedBlocks, usedBytes, peakUsedBytes, cachedBlocks, cachedBytes, hits, misses }, summed over the
+   * pools of all loaded native modules. Used blocks hold pixels of images that are loading or not yet uploaded to a
+   * texture. Cached blocks were freed and are kept for reuse by the next image of a similar size. Hits and misses
+   * count allocations served from and missing the cache. peakUsedBytes is the sum of the peaks of each pool.
+   */
+  static getImageMemoryStats () {
+    const total = {}
+
+    for (const pool of pixelPools) {
+      const stats = pool.getPixelPoolStats()
+
+      for (const key in stats) {
+        total[key] = (total[key] || 0) + stats[key]
+      }
+    }
+
+    return total
+  }
+
+  /**
+   * Set the maximum number of bytes of freed image memory kept for reuse by each pool (default 32MB). Memory over the
+   * limit is returned to the system.
+   */
+  static setImageMemoryCacheSize (size) {
+    pixelPools.forEach(pool => pool.setPixelPoolCacheLimit(size))
+  }
+
+  /**
+   * Return all freed image memory kept for reuse to the system.
+   */
+  static trimImageMemory () {
+    pixelPools.forEach(pool => pool.trimPixelPool())
+  }
+
   /**
    * Add a font face.
    */
@@ -10,7 +10,7 @@ import { Application } from '../Core/Application'
 let application
 let applicationHolder
 
-export function init () {
+export function init ({ nodePoolSize, asyncLayout } = {}) {
   if (application) {
     throw Error('application has already been initialized!')
   }
@@ -48,7 +48,7 @@ export function init () {
     console.warn('Failed to load SDL. %s', err.message)
   }
 
-  application = new Application({ platform })
+  application = new Application({ platform, nodePoolSize, asyncLayout })
 }
 
 export function app () {
@@ -0,0 +1,460 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+// Native layout benchmark. Builds synthetic Yoga trees and times tree construction, style application, layout,
+// computed field sync, incremental relayout and release. Measure functions are native only; the JS measure path and
+// the Node bindings are covered by benchmark/layout.js, which also runs this executable when it has been built.
+//
+// Each suite runs twice: with nodes allocated and freed per tree, and with nodes taken from, and returned to, a pool,
+// as Node.create() and Node.release() do (and as benchmark/layout.js measures). Computed fields are synced to a slot
+// per node in a shared layout buffer, with the Yoga::SyncComputedFields() that the addon uses.
+//
+// Usage: layout-benchmark [iterations] [nodes]
+//
+// Results are written to stdout as JSON.
+
+#include <Yoga.h>
+#include <YGNode.h>
+#include "ComputedFields.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define DEFAULT_ITERATIONS 20
+#define DEFAULT_NODE_COUNT 1000
+#define WARMUP_ITERATIONS 2
+#define DEEP_CHAIN_LENGTH 100
+// Average glyph advance and line height used by the synthetic text measure function.
+#define GLYPH_ADVANCE 8.f
+#define LINE_HEIGHT 18.f
+
+using namespace Yoga;
+
+typedef std::chrono::steady_clock Clock;
+
+enum Phase {
+    PHASE_CREATE,
+    PHASE_STYLE,
+    PHASE_LAYOUT,
+    PHASE_SYNC,
+    PHASE_RELAYOUT,
+    PHASE_RELEASE,
+    PHASE_COUNT
+};
+
+static const char *sPhaseNames[PHASE_COUNT] = { "create", "style", "layout", "sync", "relayout", "release" };
+
+struct Suite {
+    const char *name;
+    // Create the tree without styles. Returns the root.
+    std::function<YGNodeRef(int)> build;
+    // Apply styles to every node in the tree.
+    std::function<void(YGNodeRef)> style;
+};
+
+struct Timing {
+    std::vector<double> samples;
+
+    void Add(Clock::duration d) {
+        this->samples.push_back(std::chrono::duration<double, std::milli>(d).count());
+    }
+};
+
+// Stands in for the Node wrapper of a Yoga node.
+struct NodeContext {
+    uint32_t slot;
+    std::string text;
+};
+
+// Node allocation, like NodeState: layout buffer slots and, when pooled, a free list of released nodes.
+struct NodeAllocator {
+    bool pooled = false;
+    std::vector<YGNodeRef> freeNodes;
+    std::vector<uint32_t> freeSlots;
+    std::vector<float> layout;
+};
+
+static NodeAllocator sAllocator;
+
+static const char *sWords[] = { "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit" };
+
+static NodeContext *GetContext(YGNodeRef node) {
+    return static_cast<NodeContext *>(node->getContext());
+}
+
+static YGSize MeasureText(YGNodeRef node, float width, YGMeasureMode widthMode, float height, YGMeasureMode heightMode) {
+    auto text = &GetContext(node)->text;
+    float lineWidth = 0;
+    float maxWidth = 0;
+    int lines = 1;
+    size_t start = 0;
+
+    // Greedy word wrap with a fixed advance, roughly the work TextLayout does per glyph.
+    while (start < text->size()) {
+        auto end = text->find(' ', start);
+
+        if (end == std::string::npos) {
+            end = text->size();
+        }
+
+        auto wordWidth = (end - start) * GLYPH_ADVANCE;
+
+        if (widthMode != YGMeasureModeUndefined && lineWidth > 0 && lineWidth + wordWidth > width) {
+            maxWidth = std::max(maxWidth, lineWidth);
+            lineWidth = 0;
+            lines++;
+        }
+
+        lineWidth += wordWidth + GLYPH_ADVANCE;
+        start = end + 1;
+    }
+
+    maxWidth = std::max(maxWidth, lineWidth);
+
+    if (widthMode == YGMeasureModeExactly || (widthMode == YGMeasureModeAtMost && maxWidth > width)) {
+        maxWidth = width;
+    }
+
+    return { maxWidth, lines * LINE_HEIGHT };
+}
+
+static std::vector<YGNodeRef> Collect(YGNodeRef root) {
+    std::vector<YGNodeRef> nodes;
+    std::vector<YGNodeRef> stack = { root };
+
+    while (!stack.empty()) {
+        auto node = stack.back();
+
+        stack.pop_back();
+        nodes.push_back(node);
+
+        for (auto child : node->getChildren()) {
+            stack.push_back(child);
+        }
+    }
+
+    return nodes;
+}
+
+static void ResetSlot(uint32_t slot) {
+    std::fill_n(sAllocator.layout.data() + slot * COMPUTED_FIELD_COUNT, COMPUTED_FIELD_COUNT, YGUndefined);
+}
+
+static YGNodeRef AllocateNode() {
+    auto context = new NodeContext();
+
+    if (!sAllocator.freeSlots.empty()) {
+        context->slot = sAllocator.freeSlots.back();
+        sAllocator.freeSlots.pop_back();
+    } else {
+        context->slot = static_cast<uint32_t>(sAllocator.layout.size() / COMPUTED_FIELD_COUNT);
+        sAllocator.layout.resize(sAllocator.layout.size() + COMPUTED_FIELD_COUNT);
+    }
+
+    ResetSlot(context->slot);
+
+    auto node = YGNodeNew();
+
+    node->setContext(context);
+
+    return node;
+}
+
+static YGNodeRef NewNode() {
+    if (sAllocator.pooled && !sAllocator.freeNodes.empty()) {
+        auto node = sAllocator.freeNodes.back();
+
+        sAllocator.freeNodes.pop_back();
+
+        return node;
+    }
+
+    return AllocateNode();
+}
+
+static void FreeNode(YGNodeRef node) {
+    auto context = GetContext(node);
+
+    sAllocator.freeSlots.push_back(context->slot);
+    delete context;
+    YGNodeFree(node);
+}
+
+// Mirrors Node::Release(): a pooled node is reset and kept, with its slot, for the next NewNode().
+static void ReleaseTree(YGNodeRef root) {
+    auto nodes = Collect(root);
+
+    if (!sAllocator.pooled) {
+        for (auto node : nodes) {
+            YGNodeRemoveAllChildren(node);
+        }
+
+        for (auto node : nodes) {
+            FreeNode(node);
+        }
+
+        return;
+    }
+
+    for (auto node : nodes) {
+        YGNodeRemoveAllChildren(node);
+        node->setStyle(YGStyle{});
+        YGNodeSetMeasureFunc(node, nullptr);
+        GetContext(node)->text.clear();
+        ResetSlot(GetContext(node)->slot);
+        node->setDirty(false);
+        sAllocator.freeNodes.push_back(node);
+    }
+}
+
+static void ReservePool(int count) {
+    while (static_cast<int>(sAllocator.freeNodes.size()) < count) {
+        sAllocator.freeNodes.push_back(AllocateNode());
+    }
+}
+
+static void DrainPool() {
+    for (auto node : sAllocator.freeNodes) {
+        FreeNode(node);
+    }
+
+    sAllocator.freeNodes.clear();
+}
+
+// The same sync as Node::calculateLayout() runs. Returns the number of nodes whose computed fields changed.
+static int SyncComputedFields(YGNodeRef root) {
+    auto changed = 0;
+
+    Yoga::SyncComputedFields(root,
+        [](YGNodeRef node, void *context) {
+            return sAllocator.layout.data() + GetContext(node)->slot * COMPUTED_FIELD_COUNT;
+        },
+        [](YGNodeRef node, void *context) {
+            (*static_cast<int *>(context))++;
+        },
+        &changed);
+
+    return changed;
+}
+
+static void Append(YGNodeRef parent, YGNodeRef child) {
+    YGNodeInsertChild(parent, child, YGNodeGetChildCount(parent));
+}
+
+static YGNodeRef BuildDeep(int count) {
+    auto root = NewNode();
+    YGNodeRef parent = nullptr;
+
+    // Chains of DEEP_CHAIN_LENGTH nested nodes under the root.
+    for (int i = 1; i < count; i++) {
+        auto child = NewNode();
+
+        Append(i % DEEP_CHAIN_LENGTH == 1 ? root : parent, child);
+        parent = child;
+    }
+
+    return root;
+}
+
+static void StyleDeep(YGNodeRef root) {
+    for (auto node : Collect(root)) {
+        YGNodeStyleSetPadding(node, YGEdgeAll, 1);
+    }
+
+    YGNodeStyleSetFlexDirection(root, YGFlexDirectionRow);
+    YGNodeStyleSetWidth(root, 1280);
+    YGNodeStyleSetHeight(root, 720);
+}
+
+static YGNodeRef BuildWide(int count) {
+    auto root = NewNode();
+
+    for (int i = 1; i < count; i++) {
+        Append(root, NewNode());
+    }
+
+    return root;
+}
+
+static void StyleWide(YGNodeRef root) {
+    YGNodeStyleSetFlexDirection(root, YGFlexDirectionRow);
+    YGNodeStyleSetWidth(root, 1280);
+    YGNodeStyleSetHeight(root, 720);
+
+    for (auto child : root->getChildren()) {
+        YGNodeStyleSetFlexGrow(child, 1);
+        YGNodeStyleSetFlexBasis(child, 0);
+        YGNodeStyleSetMargin(child, YGEdgeHorizontal, 1);
+    }
+}
+
+static void StyleGrid(YGNodeRef root) {
+    YGNodeStyleSetFlexDirection(root, YGFlexDirectionRow);
+    YGNodeStyleSetFlexWrap(root, YGWrapWrap);
+    YGNodeStyleSetAlignContent(root, YGAlignFlexStart);
+    YGNodeStyleSetWidth(root, 1280);
+
+    for (auto child : root->getChildren()) {
+        YGNodeStyleSetWidth(child, 120);
+        YGNodeStyleSetHeightPercent(child, 10);
+        YGNodeStyleSetMargin(child, YGEdgeAll, 4);
+        YGNodeStyleSetBorder(child, YGEdgeAll, 1);
+    }
+}
+
+static YGNodeRef BuildTextList(int count) {
+    auto root = NewNode();
+    auto rows = std::max(count / 2, 1);
+
+    for (int i = 0; i < rows; i++) {
+        auto row = NewNode();
+        auto text = NewNode();
+        auto& words = GetContext(text)->text;
+
+        for (int w = 0; w < 4 + i % 12; w++) {
+            words += sWords[(i + w) % (sizeof(sWords) / sizeof(sWords[0]))];
+            words += ' ';
+        }
+
+        YGNodeSetMeasureFunc(text, MeasureText);
+        Append(row, text);
+        Append(root, row);
+    }
+
+    return root;
+}
+
+static void StyleTextList(YGNodeRef root) {
+    YGNodeStyleSetWidth(root, 640);
+
+    for (auto row : root->getChildren()) {
+        YGNodeStyleSetFlexDirection(row, YGFlexDirectionRow);
+        YGNodeStyleSetPadding(row, YGEdgeAll, 4);
+        YGNodeStyleSetFlexShrink(row->getChild(0), 1);
+    }
+}
+
+// Dirty one leaf near the end of the tree, as a single text or style change would.
+static void DirtyLeaf(YGNodeRef root) {
+    auto node = root;
+
+    while (YGNodeGetChildCount(node) > 0) {
+        node = YGNodeGetChild(node, YGNodeGetChildCount(node) - 1);
+    }
+
+    if (YGNodeHasMeasureFunc(node)) {
+        YGNodeMarkDirty(node);
+    } else {
+        YGNodeStyleSetMinHeight(node, YGNodeStyleGetMinHeight(node).value == 1 ? 0 : 1);
+    }
+}
+
+static void PrintStats(const char *suite, bool pooled, int phase, int nodes, const std::vector<double>& samples,
+        bool last) {
+    auto sorted = samples;
+    double sum = 0;
+
+    std::sort(sorted.begin(), sorted.end());
+
+    for (auto sample : sorted) {
+        sum += sample;
+    }
+
+    auto mean = sum / sorted.size();
+    auto median = sorted[sorted.size() / 2];
+
+    printf("    { \"suite\": \"%s\", \"pooled\": %s, \"phase\": \"%s\", \"nodes\": %d, \"iterations\": %d, "
+        "\"meanMs\": %.6f, \"medianMs\": %.6f, \"minMs\": %.6f, \"maxMs\": %.6f, \"nsPerNode\": %.3f }%s\n",
+        suite, pooled ? "true" : "false", sPhaseNames[phase], nodes, static_cast<int>(sorted.size()),
+        mean, median, sorted.front(), sorted.back(), (median * 1e6) / nodes, last ? "" : ",");
+}
+
+int main(int argc, char **argv) {
+    auto iterations = argc > 1 ? std::max(atoi(argv[1]), 1) : DEFAULT_ITERATIONS;
+    auto nodeCount = argc > 2 ? std::max(atoi(argv[2]), 2) : DEFAULT_NODE_COUNT;
+    std::vector<Suite> suites = {
+        { "deep", BuildDeep, StyleDeep },
+        { "wide", BuildWide, StyleWide },
+        { "grid", BuildWide, StyleGrid },
+        { "text-native", BuildTextList, StyleTextList },
+    };
+
+    printf("{\n  \"benchmark\": \"layout-native\",\n  \"results\": [\n");
+
+    for (auto pooled : { false, true }) {
+        sAllocator.pooled = pooled;
+
+        // benchmark/layout.js reserves the pool up front with reservePool().
+        if (pooled) {
+            ReservePool(nodeCount);
+        }
+
+        for (size_t s = 0; s < suites.size(); s++) {
+            auto& suite = suites[s];
+            Timing timings[PHASE_COUNT];
+            int nodes = 0;
+
+            for (int i = 0; i < WARMUP_ITERATIONS + iterations; i++) {
+                auto record = i >= WARMUP_ITERATIONS;
+                auto t0 = Clock::now();
+                auto root = suite.build(nodeCount);
+                auto t1 = Clock::now();
+
+                suite.style(root);
+
+                auto t2 = Clock::now();
+
+                YGNodeCalculateLayout(root, YGUndefined, YGUndefined, YGDirectionLTR);
+
+                auto t3 = Clock::now();
+
+                SyncComputedFields(root);
+
+                auto t4 = Clock::now();
+
+                DirtyLeaf(root);
+                YGNodeCalculateLayout(root, YGUndefined, YGUndefined, YGDirectionLTR);
+                SyncComputedFields(root);
+
+                auto t5 = Clock::now();
+
+                nodes = static_cast<int>(Collect(root).size());
+
+                auto t6 = Clock::now();
+
+                ReleaseTree(root);
+
+                auto t7 = Clock::now();
+
+                if (record) {
+                    timings[PHASE_CREATE].Add(t1 - t0);
+                    timings[PHASE_STYLE].Add(t2 - t1);
+                    timings[PHASE_LAYOUT].Add(t3 - t2);
+                    timings[PHASE_SYNC].Add(t4 - t3);
+                    timings[PHASE_RELAYOUT].Add(t5 - t4);
+                    timings[PHASE_RELEASE].Add(t7 - t6);
+                }
+            }
+
+            for (int p = 0; p < PHASE_COUNT; p++) {
+                PrintStats(suite.name, pooled, p, nodes, timings[p].samples,
+                    pooled && s == suites.size() - 1 && p == PHASE_COUNT - 1);
+            }
+        }
+
+        DrainPool();
+    }
+
+    printf("  ]\n}\n");
+
+    return 0;
+}
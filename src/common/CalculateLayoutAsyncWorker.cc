@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "CalculateLayoutAsyncWorker.h"
+#include "YogaNode.h"
+#include <exception>
+
+using namespace Napi;
+using namespace Yoga;
+
+CalculateLayoutAsyncWorker::CalculateLayoutAsyncWorker(Napi::Env env, Object root, float width, float height,
+        YGDirection direction, bool returnChangedNodes)
+    : AsyncWorker(Function::New(env, [](const CallbackInfo& info){})),
+      promise(Promise::Deferred::New(env)),
+      rootRef(Persistent(root)),
+      root(ObjectWrap<Node>::Unwrap(root)),
+      ygRoot(this->root->GetYGNode()),
+      width(width),
+      height(height),
+      direction(direction),
+      returnChangedNodes(returnChangedNodes) {
+
+}
+
+void CalculateLayoutAsyncWorker::Execute() {
+    try {
+        CalculateLayout(this->ygRoot, this->width, this->height, this->direction);
+    } catch (std::exception& e) {
+        this->SetError(e.what());
+    } catch (...) {
+        this->SetError("Unknown layout exception.");
+    }
+}
+
+void CalculateLayoutAsyncWorker::OnOK() {
+    this->promise.Resolve(this->root->PublishLayout(this->Env(), this->returnChangedNodes));
+}
+
+void CalculateLayoutAsyncWorker::OnError(const Error& e) {
+    this->root->LowerLayoutFence(this->Env());
+    this->promise.Reject(e.Value());
+}
+
+Value CalculateLayoutAsyncWorker::Promise() {
+    return this->promise.Promise();
+}
@@ -5,11 +5,10 @@
  */
 
 #include "CapInsets.h"
+#include "InstanceData.h"
 
 using namespace Napi;
 
-FunctionReference CapInsets::constructor;
-
 Object CapInsets::Init(class Env env, Object exports) {
     HandleScope scope(env);
 
@@ -20,8 +19,7 @@ Object CapInsets::Init(class Env env, Object exports) {
         InstanceAccessor("bottom", &CapInsets::Bottom, nullptr),
     });
 
-    constructor = Persistent(func);
-    constructor.SuppressDestruct();
+    InstanceData::Get(env).Constructor<CapInsets>() = Persistent(func);
 
     exports.Set("CapInsets", func);
 
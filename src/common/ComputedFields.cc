@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "ComputedFields.h"
+#include <YGNode.h>
+#include <cstring>
+
+void Yoga::SyncComputedFields(YGNodeRef ygNode, ComputedFieldsLookup lookup, ComputedFieldsChanged changed,
+        void *context) {
+    if (!ygNode->getHasNewLayout()) {
+        return;
+    }
+
+    ygNode->setHasNewLayout(false);
+
+    auto fields = lookup(ygNode, context);
+
+    if (fields) {
+        auto& layout = ygNode->getLayout();
+        auto& position = layout.position;
+        auto& dimensions = layout.dimensions;
+        float computed[COMPUTED_FIELD_COUNT];
+
+        computed[COMPUTED_LAYOUT_TOP] = position[YGEdgeTop];
+        computed[COMPUTED_LAYOUT_RIGHT] = position[YGEdgeRight];
+        computed[COMPUTED_LAYOUT_BOTTOM] = position[YGEdgeBottom];
+        computed[COMPUTED_LAYOUT_LEFT] = position[YGEdgeLeft];
+        computed[COMPUTED_LAYOUT_WIDTH] = dimensions[YGDimensionWidth];
+        computed[COMPUTED_LAYOUT_HEIGHT] = dimensions[YGDimensionHeight];
+
+        computed[COMPUTED_BORDER_TOP] = YGNodeLayoutGetBorder(ygNode, YGEdgeTop);
+        computed[COMPUTED_BORDER_RIGHT] = YGNodeLayoutGetBorder(ygNode, YGEdgeRight);
+        computed[COMPUTED_BORDER_BOTTOM] = YGNodeLayoutGetBorder(ygNode, YGEdgeBottom);
+        computed[COMPUTED_BORDER_LEFT] = YGNodeLayoutGetBorder(ygNode, YGEdgeLeft);
+
+        computed[COMPUTED_PADDING_TOP] = YGNodeLayoutGetPadding(ygNode, YGEdgeTop);
+        computed[COMPUTED_PADDING_RIGHT] = YGNodeLayoutGetPadding(ygNode, YGEdgeRight);
+        computed[COMPUTED_PADDING_BOTTOM] = YGNodeLayoutGetPadding(ygNode, YGEdgeBottom);
+        computed[COMPUTED_PADDING_LEFT] = YGNodeLayoutGetPadding(ygNode, YGEdgeLeft);
+
+        computed[COMPUTED_MARGIN_TOP] = YGNodeLayoutGetMargin(ygNode, YGEdgeTop);
+        computed[COMPUTED_MARGIN_RIGHT] = YGNodeLayoutGetMargin(ygNode, YGEdgeRight);
+        computed[COMPUTED_MARGIN_BOTTOM] = YGNodeLayoutGetMargin(ygNode, YGEdgeBottom);
+        computed[COMPUTED_MARGIN_LEFT] = YGNodeLayoutGetMargin(ygNode, YGEdgeLeft);
+
+        // The fields hold the values from the previous sync. A node visited by layout, but with an unchanged result,
+        // is not reported.
+        if (memcmp(fields, computed, sizeof(computed)) != 0) {
+            memcpy(fields, computed, sizeof(computed));
+            changed(ygNode, context);
+        }
+    }
+
+    const uint32_t childCount = YGNodeGetChildCount(ygNode);
+
+    for (uint32_t i = 0; i < childCount; i++) {
+        SyncComputedFields(YGNodeGetChild(ygNode, i), lookup, changed, context);
+    }
+}
@@ -0,0 +1,490 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "FocusIndex.h"
+#include "YogaNode.h"
+#include "InstanceData.h"
+#include <YGNode.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace Napi;
+using namespace Yoga;
+
+#define FOCUS_INDEX_DEFAULT_CELL_SIZE 128
+// Weight of the major axis distance over the minor axis distance when scoring candidates.
+#define FOCUS_MAJOR_AXIS_WEIGHT 13
+// Boxes spanning more cells than this along an axis (or far off screen) are clamped to the cell range.
+#define FOCUS_MAX_CELL_COORDINATE 4096
+
+inline int64_t CellKey(int32_t col, int32_t row) {
+    return (static_cast<int64_t>(col) << 32) | static_cast<uint32_t>(row);
+}
+
+inline bool IsHorizontal(int32_t direction) {
+    return direction == FOCUS_DIRECTION_LEFT || direction == FOCUS_DIRECTION_RIGHT;
+}
+
+// The candidate lies in the navigation direction: its near edge is past the source's trailing edge and its far edge
+// is past the source's leading edge.
+inline bool IsCandidate(const FocusBox& source, const FocusBox& box, int32_t direction) {
+    switch (direction) {
+        case FOCUS_DIRECTION_LEFT:
+            return (source.right > box.right || source.left >= box.right) && source.left > box.left;
+        case FOCUS_DIRECTION_RIGHT:
+            return (source.left < box.left || source.right <= box.left) && source.right < box.right;
+        case FOCUS_DIRECTION_UP:
+            return (source.bottom > box.bottom || source.top >= box.bottom) && source.top > box.top;
+        case FOCUS_DIRECTION_DOWN:
+            return (source.top < box.top || source.bottom <= box.top) && source.bottom < box.bottom;
+        default:
+            return false;
+    }
+}
+
+inline bool InBeam(const FocusBox& source, const FocusBox& box, int32_t direction) {
+    return IsHorizontal(direction)
+        ? box.bottom > source.top && box.top < source.bottom
+        : box.right > source.left && box.left < source.right;
+}
+
+inline float MajorDistance(const FocusBox& source, const FocusBox& box, int32_t direction) {
+    switch (direction) {
+        case FOCUS_DIRECTION_LEFT:
+            return std::max(0.f, source.left - box.right);
+        case FOCUS_DIRECTION_RIGHT:
+            return std::max(0.f, box.left - source.right);
+        case FOCUS_DIRECTION_UP:
+            return std::max(0.f, source.top - box.bottom);
+        default:
+            return std::max(0.f, box.top - source.bottom);
+    }
+}
+
+inline float MajorDistanceToFarEdge(const FocusBox& source, const FocusBox& box, int32_t direction) {
+    switch (direction) {
+        case FOCUS_DIRECTION_LEFT:
+            return std::max(1.f, source.left - box.left);
+        case FOCUS_DIRECTION_RIGHT:
+            return std::max(1.f, box.right - source.right);
+        case FOCUS_DIRECTION_UP:
+            return std::max(1.f, source.top - box.top);
+        default:
+            return std::max(1.f, box.bottom - source.bottom);
+    }
+}
+
+inline float MinorDistance(const FocusBox& source, const FocusBox& box, int32_t direction) {
+    return IsHorizontal(direction)
+        ? std::fabs((source.top + source.bottom) - (box.top + box.bottom)) * 0.5f
+        : std::fabs((source.left + source.right) - (box.left + box.right)) * 0.5f;
+}
+
+// Candidates in the beam beat candidates outside of it: always when navigating horizontally, and when vertically,
+// if the beam candidate is closer than the other candidate's far edge. Otherwise, the weighted distance decides.
+bool FocusIndex::Beats(const Candidate& candidate, const Candidate& best, bool horizontal) {
+    if (candidate.inBeam != best.inBeam) {
+        auto& inBeam = candidate.inBeam ? candidate : best;
+        auto& outOfBeam = candidate.inBeam ? best : candidate;
+        auto inBeamWins = horizontal || inBeam.major < outOfBeam.farMajor;
+
+        return candidate.inBeam == inBeamWins;
+    }
+
+    return candidate.score < best.score;
+}
+
+FocusIndex::FocusIndex(const CallbackInfo& info)
+        : ObjectWrap<FocusIndex>(info), cellSize(FOCUS_INDEX_DEFAULT_CELL_SIZE), minCol(0), maxCol(-1), minRow(0),
+          maxRow(-1), layoutGeneration(0), stale(false), visit(0) {
+    if (info[0].IsNumber()) {
+        auto cellSize = info[0].As<Number>().FloatValue();
+
+        if (!(cellSize >= 1)) {
+            throw Error::New(info.Env(), "cellSize must be a number >= 1.");
+        }
+
+        this->cellSize = cellSize;
+    }
+}
+
+Object FocusIndex::Init(Napi::Env env, Object exports) {
+    HandleScope scope(env);
+
+    auto func = DefineClass(env, "FocusIndex", {
+        InstanceMethod("add", &FocusIndex::add),
+        InstanceMethod("remove", &FocusIndex::remove),
+        InstanceMethod("findNext", &FocusIndex::findNext),
+        InstanceMethod("getSize", &FocusIndex::getSize),
+        InstanceMethod("clear", &FocusIndex::clear),
+    });
+
+    InstanceData::Get(env).Constructor<FocusIndex>() = Persistent(func);
+
+    exports.Set("FocusIndex", func);
+
+    return exports;
+}
+
+void FocusIndex::add(const CallbackInfo& info) {
+    auto object = info[0].As<Object>();
+    auto node = Node::Unwrap(object);
+
+    if (this->entryByNode.count(node)) {
+        return;
+    }
+
+    uint32_t id;
+
+    if (!this->freeEntries.empty()) {
+        id = this->freeEntries.back();
+        this->freeEntries.pop_back();
+    } else {
+        id = static_cast<uint32_t>(this->entries.size());
+        this->entries.emplace_back();
+    }
+
+    auto& entry = this->entries[id];
+
+    // The reference keeps the node from being collected (and its slot reused) while it is in the index.
+    entry.ref = Persistent(object);
+    entry.node = node;
+    entry.indexed = false;
+    entry.visit = 0;
+
+    this->entryByNode[node] = id;
+    this->stale = true;
+}
+
+void FocusIndex::remove(const CallbackInfo& info) {
+    auto p = this->entryByNode.find(Node::Unwrap(info[0].As<Object>()));
+
+    if (p != this->entryByNode.end()) {
+        this->Release(p->second);
+    }
+}
+
+Napi::Value FocusIndex::findNext(const CallbackInfo& info) {
+    auto env = info.Env();
+    auto node = Node::Unwrap(info[0].As<Object>());
+    auto direction = info[1].As<Number>().Int32Value();
+    FocusBox source;
+
+    this->Update(env);
+
+    if (!node->IsActive() || !GetBorderBox(node, source)) {
+        return env.Null();
+    }
+
+    auto entry = this->Find(source, node, direction);
+
+    return entry ? entry->ref.Value() : env.Null();
+}
+
+Napi::Value FocusIndex::getSize(const CallbackInfo& info) {
+    return Number::New(info.Env(), this->entryByNode.size());
+}
+
+void FocusIndex::clear(const CallbackInfo& info) {
+    // Destroying the entries resets their references, so the indexed nodes can be collected.
+    this->entries.clear();
+    this->freeEntries.clear();
+    this->entryByNode.clear();
+    this->cells.clear();
+    this->moved.clear();
+    this->minCol = this->minRow = 0;
+    this->maxCol = this->maxRow = -1;
+    this->stale = false;
+}
+
+void FocusIndex::Update(Napi::Env env) {
+    auto generation = Node::GetLayoutGeneration(env);
+
+    if (!this->stale && generation == this->layoutGeneration) {
+        return;
+    }
+
+    for (uint32_t id = 0; id < this->entries.size(); id++) {
+        auto& entry = this->entries[id];
+
+        if (!entry.node) {
+            continue;
+        }
+
+        // A released node may be recycled for an unrelated view.
+        if (!entry.node->IsActive()) {
+            this->Release(id);
+            continue;
+        }
+
+        // Computed fields are relative to the parent, so an entry moves only if its node or an ancestor changed.
+        if (entry.indexed && !this->IsMoved(entry.node)) {
+            continue;
+        }
+
+        FocusBox box;
+
+        if (!GetBorderBox(entry.node, box)) {
+            this->Erase(id);
+        } else if (!entry.indexed || memcmp(&box, &entry.box, sizeof(box)) != 0) {
+            this->Erase(id);
+            entry.box = box;
+            this->Insert(id);
+        }
+    }
+
+    this->moved.clear();
+    this->layoutGeneration = generation;
+    this->stale = false;
+}
+
+bool FocusIndex::IsMoved(Node *node) {
+    if (node->GetChangedGeneration() > this->layoutGeneration) {
+        return true;
+    }
+
+    auto owner = node->GetYGNode()->getOwner();
+    auto parent = owner ? Node::FromYGNode(owner) : nullptr;
+
+    if (!parent) {
+        return false;
+    }
+
+    // Entries usually share ancestors, so each ancestor is checked once per update.
+    auto p = this->moved.find(parent);
+
+    if (p != this->moved.end()) {
+        return p->second;
+    }
+
+    auto result = this->IsMoved(parent);
+
+    this->moved[parent] = result;
+
+    return result;
+}
+
+void FocusIndex::Insert(uint32_t id) {
+    auto& entry = this->entries[id];
+
+    entry.minCol = this->ToCell(entry.box.left);
+    entry.maxCol = this->ToCell(entry.box.right);
+    entry.minRow = this->ToCell(entry.box.top);
+    entry.maxRow = this->ToCell(entry.box.bottom);
+
+    for (auto col = entry.minCol; col <= entry.maxCol; col++) {
+        for (auto row = entry.minRow; row <= entry.maxRow; row++) {
+            this->cells[CellKey(col, row)].push_back(id);
+        }
+    }
+
+    if (this->minCol > this->maxCol) {
+        this->minCol = entry.minCol;
+        this->maxCol = entry.maxCol;
+        this->minRow = entry.minRow;
+        this->maxRow = entry.maxRow;
+    } else {
+        this->minCol = std::min(this->minCol, entry.minCol);
+        this->maxCol = std::max(this->maxCol, entry.maxCol);
+        this->minRow = std::min(this->minRow, entry.minRow);
+        this->maxRow = std::max(this->maxRow, entry.maxRow);
+    }
+
+    entry.indexed = true;
+}
+
+void FocusIndex::Erase(uint32_t id) {
+    auto& entry = this->entries[id];
+
+    if (!entry.indexed) {
+        return;
+    }
+
+    for (auto col = entry.minCol; col <= entry.maxCol; col++) {
+        for (auto row = entry.minRow; row <= entry.maxRow; row++) {
+            auto p = this->cells.find(CellKey(col, row));
+
+            if (p == this->cells.end()) {
+                continue;
+            }
+
+            auto& ids = p->second;
+
+            ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+
+            if (ids.empty()) {
+                this->cells.erase(p);
+            }
+        }
+    }
+
+    entry.indexed = false;
+
+    if (this->cells.empty()) {
+        this->minCol = this->minRow = 0;
+        this->maxCol = this->maxRow = -1;
+    }
+}
+
+void FocusIndex::Release(uint32_t id) {
+    auto& entry = this->entries[id];
+
+    this->Erase(id);
+    this->entryByNode.erase(entry.node);
+    entry.node = nullptr;
+    entry.ref.Reset();
+    this->freeEntries.push_back(id);
+}
+
+int32_t FocusIndex::ToCell(float coordinate) const {
+    auto cell = std::floor(coordinate / this->cellSize);
+
+    return static_cast<int32_t>(std::max(-1.f * FOCUS_MAX_CELL_COORDINATE,
+        std::min(cell, 1.f * FOCUS_MAX_CELL_COORDINATE)));
+}
+
+const FocusIndex::Entry *FocusIndex::Find(const FocusBox& source, Node *exclude, int32_t direction) {
+    if (direction < FOCUS_DIRECTION_LEFT || direction > FOCUS_DIRECTION_DOWN || this->cells.empty()) {
+        return nullptr;
+    }
+
+    auto horizontal = IsHorizontal(direction);
+    auto forward = direction == FOCUS_DIRECTION_RIGHT || direction == FOCUS_DIRECTION_DOWN;
+    // Bands are columns for horizontal navigation and rows for vertical navigation. Candidates start past the
+    // source's trailing edge, so the scan starts at the source's trailing band.
+    auto first = this->ToCell(horizontal ? (forward ? source.left : source.right) : (forward ? source.top : source.bottom));
+    auto last = horizontal ? (forward ? this->maxCol : this->minCol) : (forward ? this->maxRow : this->minRow);
+    auto crossMin = horizontal ? this->minRow : this->minCol;
+    auto crossMax = horizontal ? this->maxRow : this->maxCol;
+    // Cells overlapping the beam, across the bands.
+    auto beamMin = std::max(crossMin, this->ToCell(horizontal ? source.top : source.left));
+    auto beamMax = std::min(crossMax, this->ToCell(horizontal ? source.bottom : source.right));
+    auto step = forward ? 1 : -1;
+    auto beamOnly = false;
+    Candidate best = { nullptr, false, 0, 0, 0 };
+
+    // Entries spanning several cells are scored once per query.
+    if (++this->visit == 0) {
+        for (auto& entry : this->entries) {
+            entry.visit = 0;
+        }
+
+        this->visit = 1;
+    }
+
+    for (auto band = first; forward ? band <= last : band >= last; band += step) {
+        // An entry first seen in this band has its near edge in the band, so no candidate from here on is closer on
+        // the major axis than the band's near edge.
+        float bound;
+
+        switch (direction) {
+            case FOCUS_DIRECTION_LEFT:
+                bound = source.left - (band + 1) * this->cellSize;
+                break;
+            case FOCUS_DIRECTION_RIGHT:
+                bound = band * this->cellSize - source.right;
+                break;
+            case FOCUS_DIRECTION_UP:
+                bound = source.top - (band + 1) * this->cellSize;
+                break;
+            default:
+                bound = band * this->cellSize - source.bottom;
+                break;
+        }
+
+        bound = std::max(bound, 0.f);
+
+        if (best.entry) {
+            auto scoreDone = FOCUS_MAJOR_AXIS_WEIGHT * bound * bound > best.score;
+
+            if (best.inBeam) {
+                if (scoreDone) {
+                    break;
+                }
+            } else {
+                // A candidate in the beam can still beat an out of beam candidate that scores better. Horizontally, it
+                // always does; vertically, only while it is closer than the out of beam candidate's far edge.
+                if (scoreDone && (!horizontal && bound >= best.farMajor)) {
+                    break;
+                }
+
+                beamOnly = scoreDone;
+            }
+        }
+
+        for (auto cross = beamOnly ? beamMin : crossMin, end = beamOnly ? beamMax : crossMax; cross <= end; cross++) {
+            auto p = this->cells.find(horizontal ? CellKey(band, cross) : CellKey(cross, band));
+
+            if (p == this->cells.end()) {
+                continue;
+            }
+
+            for (auto id : p->second) {
+                auto& entry = this->entries[id];
+
+                if (entry.visit == this->visit) {
+                    continue;
+                }
+
+                entry.visit = this->visit;
+
+                if (entry.node == exclude || !IsCandidate(source, entry.box, direction)) {
+                    continue;
+                }
+
+                auto major = MajorDistance(source, entry.box, direction);
+                auto minor = MinorDistance(source, entry.box, direction);
+                Candidate candidate = {
+                    &entry,
+                    InBeam(source, entry.box, direction),
+                    major,
+                    MajorDistanceToFarEdge(source, entry.box, direction),
+                    FOCUS_MAJOR_AXIS_WEIGHT * major * major + minor * minor
+                };
+
+                if (!best.entry || Beats(candidate, best, horizontal)) {
+                    best = candidate;
+                }
+            }
+        }
+    }
+
+    return best.entry;
+}
+
+bool FocusIndex::GetBorderBox(Node *node, FocusBox& box) {
+    auto fields = node->GetComputedFields();
+    auto left = fields[COMPUTED_LAYOUT_LEFT];
+    auto top = fields[COMPUTED_LAYOUT_TOP];
+    auto width = fields[COMPUTED_LAYOUT_WIDTH];
+    auto height = fields[COMPUTED_LAYOUT_HEIGHT];
+
+    // Computed fields are relative to the parent. The tree structure cannot change during an asynchronous layout, so
+    // walking the owners is safe while the layout thread runs.
+    for (auto owner = node->GetYGNode()->getOwner(); owner; owner = owner->getOwner()) {
+        auto parent = Node::FromYGNode(owner);
+
+        if (!parent) {
+            break;
+        }
+
+        auto parentFields = parent->GetComputedFields();
+
+        left += parentFields[COMPUTED_LAYOUT_LEFT];
+        top += parentFields[COMPUTED_LAYOUT_TOP];
+    }
+
+    // Nodes that have not been laid out yet (NaN) or that are not displayed are not focus targets.
+    if (!std::isfinite(left) || !std::isfinite(top) || !(width > 0) || !(height > 0)) {
+        return false;
+    }
+
+    box = { left, top, left + width, top + height };
+
+    return true;
+}
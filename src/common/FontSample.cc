@@ -14,10 +14,6 @@ FontSample::~FontSample() {
 
 }
 
-const unsigned char *FontSample::GetTexturePixels() const {
-    return this->texturePixels.empty() ? nullptr : &this->texturePixels[0];
-}
-
 float FontSample::GetKernAdvance(int codepoint, int nextCodePoint) {
     auto iter = this->kerningPairs.find(((codepoint & 0xFFFF) << 16) | (nextCodePoint & 0xFFFF));
 
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "ImageResample.h"
+#include "PixelPool.h"
+#include "Util.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#define NUM_IMAGE_COMPONENTS 4
+#define LANCZOS_RADIUS 3
+#define RESAMPLE_PI 3.14159265358979f
+
+// Source pixels, and their weights, that contribute to one target pixel along an axis.
+struct FilterTaps {
+    int first;
+    int count;
+    int offset;
+};
+
+struct AxisFilter {
+    std::vector<FilterTaps> taps;
+    std::vector<float> weights;
+    int maxCount;
+};
+
+inline float Sinc(float x) {
+    x *= RESAMPLE_PI;
+
+    return x == 0 ? 1.f : std::sin(x) / x;
+}
+
+inline float Lanczos(float x) {
+    return (x <= -LANCZOS_RADIUS || x >= LANCZOS_RADIUS) ? 0.f : Sinc(x) * Sinc(x / LANCZOS_RADIUS);
+}
+
+inline unsigned char ToByte(float value) {
+    return static_cast<unsigned char>(std::min(std::max(value + 0.5f, 0.f), 255.f));
+}
+
+static AxisFilter CreateAxisFilter(int sourceSize, int targetSize) {
+    AxisFilter filter;
+    std::vector<float> weights;
+
+    filter.taps.resize(targetSize);
+    filter.maxCount = 1;
+
+    for (int i = 0; i < targetSize; i++) {
+        int first;
+
+        weights.clear();
+
+        if (targetSize < sourceSize) {
+            // Area filter: the target pixel covers [start, end) of the source. Each source pixel contributes the
+            // fraction of it that is covered.
+            auto scale = static_cast<float>(sourceSize) / targetSize;
+            auto start = i * scale;
+            auto end = std::min((i + 1) * scale, static_cast<float>(sourceSize));
+            auto last = std::min(static_cast<int>(std::ceil(end)), sourceSize) - 1;
+
+            first = static_cast<int>(start);
+
+            for (auto s = first; s <= last; s++) {
+                weights.push_back(std::min(end, s + 1.f) - std::max(start, static_cast<float>(s)));
+            }
+        } else if (targetSize > sourceSize) {
+            // Lanczos-3, centered on the source position of the target pixel. Taps outside of the image are clamped
+            // to the edge pixels.
+            auto center = (i + 0.5f) * sourceSize / targetSize - 0.5f;
+            auto base = static_cast<int>(std::floor(center));
+            auto last = std::min(base + LANCZOS_RADIUS, sourceSize - 1);
+
+            first = std::max(base - LANCZOS_RADIUS + 1, 0);
+            weights.resize(last - first + 1, 0.f);
+
+            for (auto s = base - LANCZOS_RADIUS + 1; s <= base + LANCZOS_RADIUS; s++) {
+                weights[std::min(std::max(s, first), last) - first] += Lanczos(center - s);
+            }
+        } else {
+            first = i;
+            weights.push_back(1.f);
+        }
+
+        float sum = 0;
+
+        for (auto w : weights) {
+            sum += w;
+        }
+
+        filter.taps[i] = { first, static_cast<int>(weights.size()), static_cast<int>(filter.weights.size()) };
+        filter.maxCount = std::max(filter.maxCount, static_cast<int>(weights.size()));
+
+        for (auto w : weights) {
+            filter.weights.push_back(sum != 0 ? w / sum : 0.f);
+        }
+    }
+
+    return filter;
+}
+
+// Premultiply a source row and filter it horizontally. Components stay in the 0-255 range.
+static void FilterRow(const unsigned char *row, int width, const AxisFilter& filter, float *premultiplied,
+        float *target) {
+    for (int x = 0; x < width; x++) {
+        auto pixel = row + x * NUM_IMAGE_COMPONENTS;
+        auto alpha = pixel[3] * (1.f / 255.f);
+        auto p = premultiplied + x * NUM_IMAGE_COMPONENTS;
+
+        p[0] = pixel[0] * alpha;
+        p[1] = pixel[1] * alpha;
+        p[2] = pixel[2] * alpha;
+        p[3] = pixel[3];
+    }
+
+    auto weights = filter.weights.data();
+
+    for (auto& taps : filter.taps) {
+        auto source = premultiplied + taps.first * NUM_IMAGE_COMPONENTS;
+        auto w = weights + taps.offset;
+        float sum[NUM_IMAGE_COMPONENTS] = { 0, 0, 0, 0 };
+
+        // Fixed width inner loop over the four components, which compilers turn into a single vector operation.
+        for (int k = 0; k < taps.count; k++) {
+            for (int c = 0; c < NUM_IMAGE_COMPONENTS; c++) {
+                sum[c] += source[k * NUM_IMAGE_COMPONENTS + c] * w[k];
+            }
+        }
+
+        for (int c = 0; c < NUM_IMAGE_COMPONENTS; c++) {
+            target[c] = sum[c];
+        }
+
+        target += NUM_IMAGE_COMPONENTS;
+    }
+}
+
+unsigned char *ResampleImage(const unsigned char *source, int sourceWidth, int sourceHeight, int targetWidth,
+        int targetHeight, TextureFormat format, bool premultipliedAlpha) {
+    auto horizontal = CreateAxisFilter(sourceWidth, targetWidth);
+    auto vertical = CreateAxisFilter(sourceHeight, targetHeight);
+    auto rowSize = targetWidth * NUM_IMAGE_COMPONENTS;
+    auto sourceRowSize = sourceWidth * NUM_IMAGE_COMPONENTS;
+    // Horizontally filtered source rows. Vertical filter windows only move forward, so each source row is filtered
+    // once and a ring of the widest window holds every row a target row needs.
+    auto ringSize = vertical.maxCount;
+    std::vector<float> ring(ringSize * rowSize);
+    std::vector<int> ringRows(ringSize, -1);
+    std::vector<float> premultiplied(sourceRowSize);
+    std::vector<float> sum(rowSize);
+    // Byte position of the R, G, B and A components in the target format.
+    unsigned char order[NUM_IMAGE_COMPONENTS] = { 0, 1, 2, 3 };
+
+    ConvertToFormat(order, NUM_IMAGE_COMPONENTS, format);
+
+    auto target = static_cast<unsigned char *>(PixelPoolAlloc(targetWidth * targetHeight * NUM_IMAGE_COMPONENTS));
+
+    if (target == nullptr) {
+        throw std::runtime_error("Failed to allocate memory for resized image.");
+    }
+
+    auto out = target;
+
+    for (auto& taps : vertical.taps) {
+        auto w = vertical.weights.data() + taps.offset;
+
+        std::fill(sum.begin(), sum.end(), 0.f);
+
+        for (int k = 0; k < taps.count; k++) {
+            auto row = taps.first + k;
+            auto slot = row % ringSize;
+            auto filtered = &ring[slot * rowSize];
+
+            if (ringRows[slot] != row) {
+                FilterRow(source + row * sourceRowSize, sourceWidth, horizontal, premultiplied.data(), filtered);
+                ringRows[slot] = row;
+            }
+
+            for (int i = 0; i < rowSize; i++) {
+                sum[i] += filtered[i] * w[k];
+            }
+        }
+
+        // Store in the target format, unpremultiplying unless premultiplied alpha was requested.
+        for (int i = 0; i < rowSize; i += NUM_IMAGE_COMPONENTS) {
+            unsigned char pixel[NUM_IMAGE_COMPONENTS];
+
+            if (premultipliedAlpha) {
+                // Lanczos overshoot can leave a color above its alpha, which would brighten the destination.
+                auto alpha = std::min(std::max(sum[i + 3], 0.f), 255.f);
+
+                pixel[0] = ToByte(std::min(sum[i], alpha));
+                pixel[1] = ToByte(std::min(sum[i + 1], alpha));
+                pixel[2] = ToByte(std::min(sum[i + 2], alpha));
+                pixel[3] = ToByte(alpha);
+            } else {
+                // The unclamped alpha is used, so Lanczos overshoot does not shift the color.
+                auto scale = sum[i + 3] > 0 ? 255.f / sum[i + 3] : 0.f;
+
+                pixel[0] = ToByte(sum[i] * scale);
+                pixel[1] = ToByte(sum[i + 1] * scale);
+                pixel[2] = ToByte(sum[i + 2] * scale);
+                pixel[3] = ToByte(sum[i + 3]);
+            }
+
+            out[0] = pixel[order[0]];
+            out[1] = pixel[order[1]];
+            out[2] = pixel[order[2]];
+            out[3] = pixel[order[3]];
+            out += NUM_IMAGE_COMPONENTS;
+        }
+    }
+
+    return target;
+}
+
+bool GetResampleSize(int sourceWidth, int sourceHeight, int width, int height, int& targetWidth, int& targetHeight) {
+    if ((width <= 0 && height <= 0) || sourceWidth <= 0 || sourceHeight <= 0) {
+        return false;
+    }
+
+    if (width <= 0) {
+        width = std::max(1, static_cast<int>(std::lround(static_cast<double>(height) * sourceWidth / sourceHeight)));
+    } else if (height <= 0) {
+        height = std::max(1, static_cast<int>(std::lround(static_cast<double>(width) * sourceHeight / sourceWidth)));
+    }
+
+    targetWidth = width;
+    targetHeight = height;
+
+    return width != sourceWidth || height != sourceHeight;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "MappedFile.h"
+#include "Format.h"
+#include <stdexcept>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef std::pair<dev_t, ino_t> FileId;
+
+static std::mutex sRegistryMutex;
+static std::map<FileId, std::weak_ptr<MappedFile>> sRegistry;
+static uint64_t sSharedHits = 0;
+static uint64_t sSharedMisses = 0;
+
+MappedFile::MappedFile(const std::string& filename, const uint8_t *data, size_t size, const struct stat& info)
+    : filename(filename), data(data), size(size), device(info.st_dev), inode(info.st_ino), modified(info.st_mtime) {
+
+}
+
+MappedFile::~MappedFile() {
+    if (this->data) {
+        munmap(const_cast<uint8_t *>(this->data), this->size);
+    }
+}
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& filename) {
+    auto fd = open(filename.c_str(), O_RDONLY);
+
+    if (fd == -1) {
+        throw std::runtime_error(Format() << "File not found: " << filename);
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error(Format() << "File access error: " << filename);
+    }
+
+    auto size = static_cast<size_t>(info.st_size);
+    auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping holds its own reference to the file, so the descriptor is no longer needed.
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        throw std::runtime_error(Format() << "Failed to map file: " << filename);
+    }
+
+    return std::shared_ptr<MappedFile>(new MappedFile(filename, static_cast<const uint8_t *>(data), size, info));
+}
+
+std::shared_ptr<MappedFile> MappedFile::OpenShared(const std::string& filename) {
+    struct stat info;
+
+    if (stat(filename.c_str(), &info) != 0) {
+        throw std::runtime_error(Format() << "File not found: " << filename);
+    }
+
+    std::lock_guard<std::mutex> lock(sRegistryMutex);
+    auto id = FileId(info.st_dev, info.st_ino);
+    auto p = sRegistry.find(id);
+
+    if (p != sRegistry.end()) {
+        auto existing = p->second.lock();
+
+        // A file modified in place gets a new mapping. Holders of the old mapping keep it until they release it.
+        if (existing && existing->size == static_cast<size_t>(info.st_size) && existing->modified == info.st_mtime) {
+            sSharedHits++;
+            return existing;
+        }
+    }
+
+    auto file = MappedFile::Open(filename);
+
+    sSharedMisses++;
+
+    // Key by the opened file, in case the path was replaced between stat() and open().
+    sRegistry[FileId(file->device, file->inode)] = file;
+
+    // Drop entries for mappings that have been released.
+    for (auto it = sRegistry.begin(); it != sRegistry.end();) {
+        it = it->second.expired() ? sRegistry.erase(it) : std::next(it);
+    }
+
+    return file;
+}
+
+MappedFileStats MappedFile::GetSharedStats() {
+    std::lock_guard<std::mutex> lock(sRegistryMutex);
+    MappedFileStats stats = { 0, sSharedHits, sSharedMisses };
+
+    for (auto& entry : sRegistry) {
+        if (!entry.second.expired()) {
+            stats.sharedMappings++;
+        }
+    }
+
+    return stats;
+}
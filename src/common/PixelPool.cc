@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "PixelPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// Marks blocks that are not pooled: malloc()'d small blocks and individually mapped huge blocks.
+#define SIZE_CLASS_MALLOC -1
+#define SIZE_CLASS_HUGE -2
+
+// Precedes every block. Sized to keep the returned pointer 16 byte aligned.
+struct alignas(16) BlockHeader {
+    // Total size of the block, including this header.
+    size_t capacity;
+    int32_t sizeClass;
+};
+
+struct Pool {
+    std::mutex mutex;
+    std::vector<size_t> classSizes;
+    std::vector<std::vector<BlockHeader *>> freeLists;
+    size_t cacheLimit;
+    PixelPoolStats stats;
+
+    Pool() : cacheLimit(PIXEL_POOL_DEFAULT_CACHE_LIMIT), stats() {
+        size_t pageSize = sysconf(_SC_PAGESIZE);
+
+        // Four classes per power of two, each a whole number of pages.
+        for (size_t base = PIXEL_POOL_MIN_SIZE; base < PIXEL_POOL_MAX_SIZE + sizeof(BlockHeader); base *= 2) {
+            for (size_t step = 0; step < 4; step++) {
+                auto size = base + step * base / 4;
+
+                size = (size + pageSize - 1) / pageSize * pageSize;
+
+                if (this->classSizes.empty() || size > this->classSizes.back()) {
+                    this->classSizes.push_back(size);
+                }
+            }
+        }
+
+        this->freeLists.resize(this->classSizes.size());
+    }
+};
+
+// Never destroyed, so blocks can be freed by static destructors that run after this file's.
+static Pool& GetPool() {
+    static auto pool = new Pool();
+
+    return *pool;
+}
+
+inline BlockHeader *MapBlock(size_t capacity) {
+    auto p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    return p == MAP_FAILED ? nullptr : static_cast<BlockHeader *>(p);
+}
+
+inline void *ToPointer(BlockHeader *block) {
+    return block + 1;
+}
+
+inline BlockHeader *ToBlock(void *pointer) {
+    return static_cast<BlockHeader *>(pointer) - 1;
+}
+
+void *PixelPoolAlloc(size_t size) {
+    auto total = size + sizeof(BlockHeader);
+    auto& pool = GetPool();
+    BlockHeader *block;
+
+    if (total < PIXEL_POOL_MIN_SIZE) {
+        block = static_cast<BlockHeader *>(malloc(total));
+
+        if (block) {
+            block->capacity = total;
+            block->sizeClass = SIZE_CLASS_MALLOC;
+        }
+
+        return block ? ToPointer(block) : nullptr;
+    }
+
+    auto& classSizes = pool.classSizes;
+    auto sizeClass = static_cast<int32_t>(std::lower_bound(classSizes.begin(), classSizes.end(), total)
+        - classSizes.begin());
+    size_t capacity;
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        if (sizeClass < static_cast<int32_t>(classSizes.size()) && !pool.freeLists[sizeClass].empty()) {
+            block = pool.freeLists[sizeClass].back();
+            pool.freeLists[sizeClass].pop_back();
+
+            pool.stats.cachedBlocks--;
+            pool.stats.cachedBytes -= block->capacity;
+            pool.stats.usedBlocks++;
+            pool.stats.usedBytes += block->capacity;
+            pool.stats.peakUsedBytes = std::max(pool.stats.peakUsedBytes, pool.stats.usedBytes);
+            pool.stats.hits++;
+
+            return ToPointer(block);
+        }
+    }
+
+    if (sizeClass < static_cast<int32_t>(classSizes.size())) {
+        capacity = classSizes[sizeClass];
+    } else {
+        sizeClass = SIZE_CLASS_HUGE;
+        capacity = total;
+    }
+
+    block = MapBlock(capacity);
+
+    if (!block) {
+        return nullptr;
+    }
+
+    block->capacity = capacity;
+    block->sizeClass = sizeClass;
+
+    std::lock_guard<std::mutex> lock(pool.mutex);
+
+    pool.stats.usedBlocks++;
+    pool.stats.usedBytes += capacity;
+    pool.stats.peakUsedBytes = std::max(pool.stats.peakUsedBytes, pool.stats.usedBytes);
+    pool.stats.misses++;
+
+    return ToPointer(block);
+}
+
+void *PixelPoolRealloc(void *pointer, size_t size) {
+    if (!pointer) {
+        return PixelPoolAlloc(size);
+    }
+
+    auto block = ToBlock(pointer);
+    auto available = block->capacity - sizeof(BlockHeader);
+
+    // Growing within the block's size class, or shrinking, keeps the block.
+    if (size <= available) {
+        return pointer;
+    }
+
+    auto target = PixelPoolAlloc(size);
+
+    if (target) {
+        memcpy(target, pointer, available);
+        PixelPoolFree(pointer);
+    }
+
+    return target;
+}
+
+void PixelPoolFree(void *pointer) {
+    if (!pointer) {
+        return;
+    }
+
+    auto block = ToBlock(pointer);
+
+    if (block->sizeClass == SIZE_CLASS_MALLOC) {
+        free(block);
+        return;
+    }
+
+    auto& pool = GetPool();
+    auto capacity = block->capacity;
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        pool.stats.usedBlocks--;
+        pool.stats.usedBytes -= capacity;
+
+        if (block->sizeClass >= 0 && pool.stats.cachedBytes + capacity <= pool.cacheLimit) {
+            pool.freeLists[block->sizeClass].push_back(block);
+            pool.stats.cachedBlocks++;
+            pool.stats.cachedBytes += capacity;
+
+            return;
+        }
+    }
+
+    munmap(block, capacity);
+}
+
+PixelPoolStats GetPixelPoolStats() {
+    auto& pool = GetPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+
+    return pool.stats;
+}
+
+void SetPixelPoolCacheLimit(size_t limit) {
+    auto& pool = GetPool();
+    std::vector<BlockHeader *> released;
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        pool.cacheLimit = limit;
+
+        // Release the largest blocks first, as they are the least likely to be reused.
+        for (auto i = pool.freeLists.size(); i-- > 0 && pool.stats.cachedBytes > limit;) {
+            auto& freeList = pool.freeLists[i];
+
+            while (!freeList.empty() && pool.stats.cachedBytes > limit) {
+                pool.stats.cachedBlocks--;
+                pool.stats.cachedBytes -= freeList.back()->capacity;
+                released.push_back(freeList.back());
+                freeList.pop_back();
+            }
+        }
+    }
+
+    for (auto block : released) {
+        munmap(block, block->capacity);
+    }
+}
+
+void TrimPixelPool() {
+    auto& pool = GetPool();
+    size_t limit;
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        limit = pool.cacheLimit;
+    }
+
+    SetPixelPoolCacheLimit(0);
+    SetPixelPoolCacheLimit(limit);
+}
@@ -5,6 +5,7 @@
  */
 
 #include "TextLayout.h"
+#include "InstanceData.h"
 
 #include <utf8.h>
 #include <iostream>
@@ -20,14 +21,13 @@ using namespace Napi;
 #define UNICODE_ELLIPSIS 0x2026
 
 CharacterQuad CharacterQuad::NEW_LINE(true);
-FunctionReference TextLayout::constructor;
-
 inline bool CanAdvanceY(float y, float lineHeight, float heightLimit, int current, int maxLines) {
     return (maxLines == 0 || current + 1 < maxLines) && (heightLimit == 0 || y + lineHeight <= heightLimit);
 }
 
 inline void AppendCharacterQuad(std::vector<CharacterQuad> &quads, const CodepointMetrics *metrics, float ascent, float xadvance) {
    quads.push_back(CharacterQuad(
+       metrics->page,
        metrics->sourceX, metrics->sourceY, metrics->sourceWidth, metrics->sourceHeight,
        metrics->xOffset, ascent + metrics->yOffset, metrics->destWidth, metrics->destHeight,
        xadvance
@@ -73,8 +73,7 @@ Object TextLayout::Init(class Env env, Object exports) {
         InstanceMethod("getHeight", &TextLayout::GetHeight),
     });
 
-    constructor = Persistent(func);
-    constructor.SuppressDestruct();
+    InstanceData::Get(env).Constructor<TextLayout>() = Persistent(func);
 
     exports.Set("TextLayout", func);
 
@@ -95,7 +94,7 @@ float TextLayout::GetLineAlignmentOffset(int lineIndex, TextAlign textAlign) {
 }
 
 void TextLayout::Layout(
-        const std::string text,
+        const std::string& text,
         FontSample *sample,
         int maxLines,
         bool ellipsize,
@@ -269,6 +268,8 @@ Value TextLayout::Layout(const CallbackInfo& info) {
     auto height = info[6].As<Number>().Int32Value();
     auto heightMeasureMode = info[7].As<Number>().Int32Value();
 
+    std::lock_guard<std::mutex> lock(this->mutex);
+
     this->Layout(text, sample, maxLines, ellipsize, width, widthMeasureMode, height, heightMeasureMode);
 
     return NewDimensions(info.Env(), this->measuredWidth, this->measuredHeight);
@@ -279,13 +280,19 @@ bool TextLayout::IsMeasurementValid(int maxLines, bool ellipsize, int width, int
 }
 
 void TextLayout::Reset(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
     this->measured = false;
 }
 
 Value TextLayout::GetWidth(const CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
     return Number::New(info.Env(), this->measuredWidth);
 }
 
 Value TextLayout::GetHeight(const CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
     return Number::New(info.Env(), this->measuredHeight);
 }
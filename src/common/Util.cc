@@ -6,13 +6,25 @@
 
 #include "Util.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <iterator>
 #include <string>
 #include <fstream>
 #include <exception>
 #include <iostream>
+#include <stdexcept>
 #include "Format.h"
 
+std::string ToHex(uint64_t value) {
+    char buffer[17];
+
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+
+    return buffer;
+}
+
 void ReadBytesFromFile(const std::string filename, std::vector<unsigned char>& target) {
     std::ifstream file(filename, std::ios_base::binary);
 
@@ -137,3 +149,150 @@ void ConvertToFormat(unsigned char *bytes, int len, TextureFormat format) {
        ToFormatLE(bytes, len, format);
     }
 }
+
+void PremultiplyAlpha(unsigned char *bytes, int len) {
+    // The pixel is processed as two 16 bit lanes per 32 bit word (SIMD within a register): the multiply, rounding and
+    // divide by 255 are applied to two components at once. The lanes are the same in either byte order.
+    for (auto i = 0; i + NUM_IMAGE_COMPONENTS <= len; i += NUM_IMAGE_COMPONENTS) {
+        auto pixel = bytes + i;
+        uint32_t a = pixel[A];
+
+        if (a == 255) {
+            continue;
+        }
+
+        uint32_t p;
+
+        memcpy(&p, pixel, sizeof(p));
+
+        // c * a / 255, rounded: t = c * a + 128, (t + (t >> 8)) >> 8.
+        auto even = (p & 0x00FF00FF) * a + 0x00800080;
+        auto odd = ((p >> 8) & 0x00FF00FF) * a + 0x00800080;
+
+        even = ((even + ((even >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+        odd = (odd + ((odd >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+        p = even | odd;
+
+        memcpy(pixel, &p, sizeof(p));
+        pixel[A] = static_cast<unsigned char>(a);
+    }
+}
+
+// 4x4 Bayer matrix: the threshold of each position, in 16ths.
+static const uint8_t BAYER_4X4[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
+// Quantize an 8 bit component to (1 << bits) - 1 levels, rounding or dithering with a threshold in 16ths.
+inline uint32_t Quantize(uint32_t value, uint32_t bits, int32_t threshold) {
+    uint32_t max = (1 << bits) - 1;
+
+    if (threshold < 0) {
+        return (value * max + 127) / 255;
+    }
+
+    // floor(value * max / 255 + (threshold + 0.5) / 16)
+    return std::min((32 * value * max + 255 * (2 * threshold + 1)) / (255 * 32), max);
+}
+
+int PackPixels(unsigned char *bytes, int width, int height, TextureFormat format, bool dither) {
+    // Pixels shrink from 4 to 2 bytes, so packing forward never overwrites an unread pixel.
+    auto source = bytes;
+    auto target = reinterpret_cast<uint16_t *>(bytes);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int32_t t = dither ? BAYER_4X4[y & 3][x & 3] : -1;
+            uint32_t pixel;
+
+            switch (format) {
+                case TEXTURE_FORMAT_RGB565:
+                    pixel = (Quantize(source[R], 5, t) << 11) | (Quantize(source[G], 6, t) << 5)
+                        | Quantize(source[B], 5, t);
+                    break;
+                case TEXTURE_FORMAT_RGBA4444:
+                    pixel = (Quantize(source[R], 4, t) << 12) | (Quantize(source[G], 4, t) << 8)
+                        | (Quantize(source[B], 4, t) << 4) | Quantize(source[A], 4, t);
+                    break;
+                case TEXTURE_FORMAT_RGBA5551:
+                    // A dithered 1 bit alpha would speckle edges, so alpha is thresholded.
+                    pixel = (Quantize(source[R], 5, t) << 11) | (Quantize(source[G], 5, t) << 6)
+                        | (Quantize(source[B], 5, t) << 1) | (source[A] >= 128 ? 1 : 0);
+                    break;
+                default:
+                    throw std::invalid_argument(Format() << "PackPixels: Not a packed texture format: " << format
+                        >> Format::to_str);
+            }
+
+            *target++ = static_cast<uint16_t>(pixel);
+            source += NUM_IMAGE_COMPONENTS;
+        }
+    }
+
+    return width * height * 2;
+}
+
+int GetMipLevelCount(int width, int height) {
+    int levelCount = 1;
+
+    while (std::min(width, height) / 2 >= MIP_MIN_SIZE) {
+        width /= 2;
+        height /= 2;
+        levelCount++;
+    }
+
+    return levelCount;
+}
+
+int GetMipChainSize(int width, int height, int levelCount, int bytesPerPixel) {
+    int size = 0;
+
+    for (int i = 0; i < levelCount; i++) {
+        size += (width >> i) * (height >> i) * bytesPerPixel;
+    }
+
+    return size;
+}
+
+void BuildMipChain(unsigned char *bytes, int width, int height, int levelCount) {
+    auto source = bytes;
+
+    for (int i = 1; i < levelCount; i++) {
+        auto target = source + width * height * NUM_IMAGE_COMPONENTS;
+        auto sourcePitch = width * NUM_IMAGE_COMPONENTS;
+
+        // An odd last row or column is dropped.
+        width /= 2;
+        height /= 2;
+
+        auto pixel = target;
+
+        for (int y = 0; y < height; y++) {
+            auto row = source + (y * 2) * sourcePitch;
+
+            for (int x = 0; x < width; x++) {
+                uint32_t p[4];
+
+                memcpy(&p[0], row, sizeof(uint32_t) * 2);
+                memcpy(&p[2], row + sourcePitch, sizeof(uint32_t) * 2);
+
+                // As in PremultiplyAlpha(), two 16 bit lanes per 32 bit word, so each sum of four components (at
+                // most 1020) is computed for two components at once. (sum + 2) >> 2 is the rounded average.
+                auto even = (p[0] & 0x00FF00FF) + (p[1] & 0x00FF00FF) + (p[2] & 0x00FF00FF) + (p[3] & 0x00FF00FF)
+                    + 0x00020002;
+                auto odd = ((p[0] >> 8) & 0x00FF00FF) + ((p[1] >> 8) & 0x00FF00FF) + ((p[2] >> 8) & 0x00FF00FF)
+                    + ((p[3] >> 8) & 0x00FF00FF) + 0x00020002;
+                uint32_t average = ((even >> 2) & 0x00FF00FF) | ((odd << 6) & 0xFF00FF00);
+
+                memcpy(pixel, &average, sizeof(average));
+                pixel += NUM_IMAGE_COMPONENTS;
+                row += NUM_IMAGE_COMPONENTS * 2;
+            }
+        }
+
+        source = target;
+    }
+}
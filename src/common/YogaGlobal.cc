@@ -11,10 +11,29 @@ using namespace Napi;
 
 Object Yoga::Init(Env env, Object exports) {
     exports["getInstanceCount"] = Function::New(env, GetInstanceCount, "getInstanceCount");
+    exports["reservePool"] = Function::New(env, ReservePool, "reservePool");
+    exports["shrinkPool"] = Function::New(env, ShrinkPool, "shrinkPool");
+    exports["getPoolStats"] = Function::New(env, GetPoolStats, "getPoolStats");
 
     return exports;
 }
 
 Value Yoga::GetInstanceCount(const CallbackInfo& info) {
-    return Number::New(info.Env(), Yoga::Node::GetInstanceCount());
+    return Number::New(info.Env(), Yoga::Node::GetInstanceCount(info.Env()));
+}
+
+Value Yoga::ReservePool(const CallbackInfo& info) {
+    Yoga::Node::ReservePool(info.Env(), info[0].IsNumber() ? info[0].As<Number>().Int32Value() : 0);
+
+    return info.Env().Undefined();
+}
+
+Value Yoga::ShrinkPool(const CallbackInfo& info) {
+    Yoga::Node::ShrinkPool(info.Env());
+
+    return info.Env().Undefined();
+}
+
+Value Yoga::GetPoolStats(const CallbackInfo& info) {
+    return Yoga::Node::GetPoolStats(info.Env());
 }
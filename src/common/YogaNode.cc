@@ -6,17 +6,111 @@
 
 #include "YogaNode.h"
 #include "YogaValue.h"
+#include "TextLayout.h"
+#include "CalculateLayoutAsyncWorker.h"
+#include "InstanceData.h"
 #include <YGNode.h>
 #include <YGStyle.h>
-#include <map>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <functional>
+#include <new>
+#include <mutex>
 
 using namespace Napi;
 using namespace Yoga;
 
-FunctionReference Node::constructor;
-static std::map<YGNodeRef, ObjectReference> sActiveNodes;
-static std::vector<std::pair<YGNodeRef, ObjectReference>> sNodePool;
-static YGStyle sEmptyStyle = YGStyle{};
+#define NODE_ARENA_BLOCK_SIZE 256
+#define LAYOUT_BUFFER_INITIAL_SLOTS 256
+
+static std::mutex sCalculateLayoutMutex;
+
+// Yoga node state of one environment (main thread or worker_thread), owned by the addon InstanceData.
+struct Yoga::NodeState {
+    ~NodeState();
+
+    // Released nodes, linked through Node::nextFree. Pooled nodes are not garbage collected; they are recycled by
+    // Create(). ShrinkPool() unpins nodes beyond the high-water mark, so the garbage collector can reclaim them.
+    Node *freeList = nullptr;
+    int32_t freeNodeCount = 0;
+    int32_t activeNodeCount = 0;
+    int32_t highWaterMark = 0;
+    int32_t poolReserve = 0;
+
+    // YGNodes are allocated from fixed size blocks, rather than individually by YGNodeNew(). Blocks are freed with
+    // the environment. The YGNodes of garbage collected wrappers are destructed and their storage is reused.
+    std::vector<YGNode *> arenaBlocks;
+    uint32_t arenaBlockUsed = NODE_ARENA_BLOCK_SIZE;
+    std::vector<YGNode *> arenaFreeNodes;
+
+    // Raised while calculateLayoutAsync() runs Yoga on a worker thread. Tree and style mutations are either rejected
+    // (CheckLayoutFence()) or deferred (DeferIfFenced()) until the layout has been published. Reads of the computed
+    // layout and dirty flag, which the worker thread writes, are rejected; Node.layout holds the published layout.
+    bool layoutFenced = false;
+    std::vector<std::function<void(Napi::Env)>> fencedOperations;
+
+    // Computed fields of all nodes, COMPUTED_FIELD_COUNT floats per slot. The memory is owned by a javascript
+    // ArrayBuffer, exposed to javascript as the Node.layout Float32Array. When the buffer grows, a new Float32Array
+    // replaces Node.layout, so javascript should not hold onto the array across node creation.
+    ObjectReference layoutArray;
+    float *layoutData = nullptr;
+    uint32_t layoutCapacity = 0;
+    uint32_t layoutSlotCount = 0;
+    std::vector<uint32_t> freeLayoutSlots;
+    // Slot -> owning Node, for commands that reference nodes by slot (see ApplyMutations()).
+    std::vector<Node *> nodesBySlot;
+
+    // Nodes whose computed fields changed during the last calculateLayout() call.
+    std::vector<Node *> changedNodes;
+    uint32_t layoutGeneration = 0;
+
+    void CheckLayoutFence(Napi::Env env) {
+        if (this->layoutFenced) {
+            throw Error::New(env, "Cannot access a Yoga node while an asynchronous layout is running.");
+        }
+    }
+
+    // Queue an operation to run, in call order, after the running asynchronous layout has been published. Returns
+    // false, without queueing, if no asynchronous layout is running.
+    bool DeferIfFenced(std::function<void(Napi::Env)> operation) {
+        if (!this->layoutFenced) {
+            return false;
+        }
+
+        this->fencedOperations.push_back(std::move(operation));
+
+        return true;
+    }
+
+    void FreeYGNode(YGNodeRef ygNode) {
+        ygNode->~YGNode();
+        this->arenaFreeNodes.push_back(ygNode);
+    }
+
+    void ResetSlot(uint32_t slot) {
+        // Fields start out undefined (NaN), like a new Yoga node, so the first layout always reports the node as
+        // changed.
+        std::fill_n(this->layoutData + slot * COMPUTED_FIELD_COUNT, COMPUTED_FIELD_COUNT, YGUndefined);
+    }
+
+    void SyncComputedFields(YGNodeRef ygNode);
+};
+
+// Immutable, so it is shared by all environments.
+static const YGStyle sEmptyStyle = YGStyle{};
+
+NodeState::~NodeState() {
+    // Node wrappers are finalized before the instance data, so no node references the arena at this point.
+    for (auto block : this->arenaBlocks) {
+        ::operator delete(block);
+    }
+}
+
+inline NodeState& GetNodeState(Napi::Env env) {
+    return InstanceData::Get(env).State<NodeState>();
+}
 
 #define INSTANCE_METHOD(name) InstanceMethod(#name, &Node::name)
 
@@ -37,84 +131,206 @@ static YGStyle sEmptyStyle = YGStyle{};
 }
 
 #define SET_ENUM_IMPL(method, ygMethod, type) void Node::method(const CallbackInfo& info) { \
+    this->state->CheckLayoutFence(info.Env()); \
     if (info[0].IsNumber()) { \
         ygMethod(this->ygNode, static_cast<type>(info[0].As<Number>().Int32Value())); \
     } \
 }
 
 #define SET_DOUBLE_IMPL(method, ygMethod) void Node::method(const CallbackInfo& info) { \
+    this->state->CheckLayoutFence(info.Env()); \
     ygMethod(this->ygNode, info[0].As<Number>().DoubleValue()); \
 }
 
 #define SET_DOUBLE_AND_PERCENT_IMPL(method, ygMethod) SET_DOUBLE_IMPL(method, ygMethod) \
 \
 void Node::CONCAT(method, Percent)(const CallbackInfo& info) { \
+    this->state->CheckLayoutFence(info.Env()); \
     CONCAT(ygMethod, Percent)(this->ygNode, info[0].As<Number>().DoubleValue()); \
 }
 
 #define SET_DOUBLE_BY_EDGE_IMPL(method, ygMethod) void Node::method(const CallbackInfo& info) { \
+    this->state->CheckLayoutFence(info.Env()); \
     ygMethod(this->ygNode, static_cast<YGEdge>(info[0].As<Number>().Int32Value()), info[1].As<Number>().DoubleValue()); \
 }
 
 #define SET_DOUBLE_AND_PERCENT_BY_EDGE_IMPL(method, ygMethod) SET_DOUBLE_BY_EDGE_IMPL(method, ygMethod) \
 \
 void Node::CONCAT(method, Percent)(const CallbackInfo& info) { \
+    this->state->CheckLayoutFence(info.Env()); \
     CONCAT(ygMethod, Percent)(this->ygNode, static_cast<YGEdge>(info[0].As<Number>().Int32Value()), info[1].As<Number>().DoubleValue()); \
 }
 
-inline Napi::Value ToNumber(Env env, const float value, Napi::Value& zero) {
-    return value == 0 ? zero : Number::New(env, value);
+void NodeState::SyncComputedFields(YGNodeRef ygNode) {
+    Yoga::SyncComputedFields(ygNode,
+        [](YGNodeRef ygNode, void *context) -> float * {
+            auto node = Node::FromYGNode(ygNode);
+
+            return node
+                ? static_cast<NodeState *>(context)->layoutData + node->GetSlot() * COMPUTED_FIELD_COUNT : nullptr;
+        },
+        [](YGNodeRef ygNode, void *context) {
+            auto state = static_cast<NodeState *>(context);
+            auto node = Node::FromYGNode(ygNode);
+
+            state->changedNodes.push_back(node);
+            // SyncLayout() advances the generation after the sync when any node changed.
+            node->changedGeneration = state->layoutGeneration + 1;
+        },
+        this);
 }
 
-void SyncComputedFields(Env env, YGNodeRef ygNode, uint32_t generation, Napi::Value& zero) {
-    // The generation is incremented when layout is run on a dirty node. Since a node marked dirty may not result in
-    // a layout change, using the generation check will result in more syncing than necessary.
+Node::Node(const CallbackInfo& info)
+        : ObjectWrap<Node>(info), state(&GetNodeState(info.Env())), ygNode(this->AllocateYGNode()),
+          slot(this->AllocateSlot(info.Env())), changedGeneration(0), active(false), pinned(false),
+          nextFree(nullptr) {
+    // The owning Node is stored in the Yoga node, so mapping a YGNodeRef back to javascript is a pointer read.
+    this->ygNode->setContext(this);
+    info.This().As<Object>().Set("slot", Number::New(info.Env(), this->slot));
 
-    if (YGNodeLayoutGeneration(ygNode) == generation) {
-        auto it = sActiveNodes.find(ygNode);
+    auto& nodesBySlot = this->state->nodesBySlot;
 
-        if (it != sActiveNodes.end()) {
-            auto& ref = it->second;
-            auto& position = ygNode->getLayout().position;
-            auto& dimensions = ygNode->getLayout().dimensions;
+    if (this->slot >= nodesBySlot.size()) {
+        nodesBySlot.resize(this->slot + 1, nullptr);
+    }
 
-            ref.Set(COMPUTED_LAYOUT_TOP, ToNumber(env, position[YGEdgeTop], zero));
-            ref.Set(COMPUTED_LAYOUT_RIGHT, ToNumber(env, position[YGEdgeRight], zero));
-            ref.Set(COMPUTED_LAYOUT_BOTTOM, ToNumber(env, position[YGEdgeBottom], zero));
-            ref.Set(COMPUTED_LAYOUT_LEFT, ToNumber(env, position[YGEdgeLeft], zero));
-            ref.Set(COMPUTED_LAYOUT_WIDTH, ToNumber(env, dimensions[YGDimensionWidth], zero));
-            ref.Set(COMPUTED_LAYOUT_HEIGHT, ToNumber(env, dimensions[YGDimensionHeight], zero));
+    nodesBySlot[this->slot] = this;
+}
 
-            ref.Set(COMPUTED_BORDER_TOP, ToNumber(env, YGNodeLayoutGetBorder(ygNode, YGEdgeTop), zero));
-            ref.Set(COMPUTED_BORDER_RIGHT, ToNumber(env, YGNodeLayoutGetBorder(ygNode, YGEdgeRight), zero));
-            ref.Set(COMPUTED_BORDER_BOTTOM, ToNumber(env, YGNodeLayoutGetBorder(ygNode, YGEdgeBottom), zero));
-            ref.Set(COMPUTED_BORDER_LEFT, ToNumber(env, YGNodeLayoutGetBorder(ygNode, YGEdgeLeft), zero));
+Node::~Node() {
+    this->state->nodesBySlot[this->slot] = nullptr;
+    this->state->freeLayoutSlots.push_back(this->slot);
 
-            ref.Set(COMPUTED_PADDING_TOP, ToNumber(env, YGNodeLayoutGetPadding(ygNode, YGEdgeTop), zero));
-            ref.Set(COMPUTED_PADDING_RIGHT, ToNumber(env, YGNodeLayoutGetPadding(ygNode, YGEdgeRight), zero));
-            ref.Set(COMPUTED_PADDING_BOTTOM, ToNumber(env, YGNodeLayoutGetPadding(ygNode, YGEdgeBottom), zero));
-            ref.Set(COMPUTED_PADDING_LEFT, ToNumber(env, YGNodeLayoutGetPadding(ygNode, YGEdgeLeft), zero));
+    // Only unpinned nodes are outside of any tree. Nodes still pinned when the environment is torn down may be
+    // referenced by other YGNodes, so their storage is left alone.
+    if (!this->pinned) {
+        this->state->FreeYGNode(this->ygNode);
+    }
+}
 
-            ref.Set(COMPUTED_MARGIN_TOP, ToNumber(env, YGNodeLayoutGetMargin(ygNode, YGEdgeTop), zero));
-            ref.Set(COMPUTED_MARGIN_RIGHT, ToNumber(env, YGNodeLayoutGetMargin(ygNode, YGEdgeRight), zero));
-            ref.Set(COMPUTED_MARGIN_BOTTOM, ToNumber(env, YGNodeLayoutGetMargin(ygNode, YGEdgeBottom), zero));
-            ref.Set(COMPUTED_MARGIN_LEFT, ToNumber(env, YGNodeLayoutGetMargin(ygNode, YGEdgeLeft), zero));
+YGNodeRef Node::AllocateYGNode() {
+    auto state = this->state;
+    YGNode *storage;
+
+    if (!state->arenaFreeNodes.empty()) {
+        storage = state->arenaFreeNodes.back();
+        state->arenaFreeNodes.pop_back();
+    } else {
+        if (state->arenaBlockUsed == NODE_ARENA_BLOCK_SIZE) {
+            state->arenaBlocks.push_back(static_cast<YGNode *>(::operator new(NODE_ARENA_BLOCK_SIZE * sizeof(YGNode))));
+            state->arenaBlockUsed = 0;
         }
+
+        storage = state->arenaBlocks.back() + state->arenaBlockUsed++;
     }
 
-    const uint32_t childCount = YGNodeGetChildCount(ygNode);
+    // Equivalent to YGNodeNew(), without the heap allocation.
+    auto ygNode = new (storage) YGNode();
 
-    for (uint32_t i = 0; i < childCount; i++) {
-        SyncComputedFields(env, YGNodeGetChild(ygNode, i), generation, zero);
+    ygNode->setConfig(YGConfigGetDefault());
+
+    return ygNode;
+}
+
+Node *Node::NewPinned(Napi::Env env) {
+    auto node = ObjectWrap::Unwrap(InstanceData::Get(env).Constructor<Node>().New({}).As<Object>());
+
+    // Hold a strong reference to the wrapper, so pooled nodes are not collected.
+    node->Ref();
+    node->pinned = true;
+
+    return node;
+}
+
+void Node::ReservePool(Napi::Env env, int32_t count) {
+    auto& state = GetNodeState(env);
+
+    state.poolReserve = std::max(count, 0);
+
+    while (state.activeNodeCount + state.freeNodeCount < state.poolReserve) {
+        HandleScope scope(env);
+        auto node = NewPinned(env);
+
+        node->nextFree = state.freeList;
+        state.freeList = node;
+        state.freeNodeCount++;
     }
 }
 
-Node::Node(const CallbackInfo& info) : ObjectWrap<Node>(info), ygNode(YGNodeNew()) {
+void Node::ShrinkPool(Napi::Env env) {
+    auto& state = GetNodeState(env);
+    // Keep enough nodes to get back to the high-water mark (or the reserve) without creating new nodes.
+    auto keep = std::max(state.poolReserve, state.highWaterMark);
+
+    while (state.freeList && state.activeNodeCount + state.freeNodeCount > keep) {
+        auto node = state.freeList;
 
+        state.freeList = node->nextFree;
+        node->nextFree = nullptr;
+        state.freeNodeCount--;
+
+        node->pinned = false;
+        node->Unref();
+    }
+
+    state.highWaterMark = state.activeNodeCount;
 }
 
-Node::~Node() {
+Napi::Object Node::GetPoolStats(Napi::Env env) {
+    auto& state = GetNodeState(env);
+    auto stats = Object::New(env);
+    auto arenaCapacity = state.arenaBlocks.size() * NODE_ARENA_BLOCK_SIZE;
+
+    stats["active"] = Number::New(env, state.activeNodeCount);
+    stats["pooled"] = Number::New(env, state.freeNodeCount);
+    stats["highWaterMark"] = Number::New(env, state.highWaterMark);
+    stats["reserve"] = Number::New(env, state.poolReserve);
+    stats["arenaBlocks"] = Number::New(env, state.arenaBlocks.size());
+    stats["arenaCapacity"] = Number::New(env, arenaCapacity);
+    stats["arenaAvailable"] = Number::New(env, state.arenaFreeNodes.size()
+        + (state.arenaBlocks.empty() ? 0 : NODE_ARENA_BLOCK_SIZE - state.arenaBlockUsed));
+
+    return stats;
+}
+
+uint32_t Node::AllocateSlot(Napi::Env env) {
+    auto state = this->state;
+    uint32_t slot;
+
+    if (!state->freeLayoutSlots.empty()) {
+        slot = state->freeLayoutSlots.back();
+        state->freeLayoutSlots.pop_back();
+    } else {
+        slot = state->layoutSlotCount++;
+    }
+
+    if (slot >= state->layoutCapacity) {
+        HandleScope scope(env);
+        auto capacity = state->layoutCapacity == 0 ? LAYOUT_BUFFER_INITIAL_SLOTS : state->layoutCapacity * 2;
+        auto buffer = ArrayBuffer::New(env, capacity * COMPUTED_FIELD_COUNT * sizeof(float));
+        auto data = static_cast<float *>(buffer.Data());
+
+        if (state->layoutData) {
+            memcpy(data, state->layoutData, state->layoutCapacity * COMPUTED_FIELD_COUNT * sizeof(float));
+        }
+
+        auto array = Float32Array::New(env, capacity * COMPUTED_FIELD_COUNT, buffer, 0);
+
+        if (state->layoutArray.IsEmpty()) {
+            state->layoutArray = Persistent(array.As<Object>());
+        } else {
+            state->layoutArray.Reset(array.As<Object>(), 1);
+        }
+
+        state->layoutData = data;
+        state->layoutCapacity = capacity;
+
+        InstanceData::Get(env).Constructor<Node>().Value().Set("layout", array);
+    }
+
+    state->ResetSlot(slot);
 
+    return slot;
 }
 
 Object Node::Init(Napi::Env env, Object exports) {
@@ -122,6 +338,7 @@ Object Node::Init(Napi::Env env, Object exports) {
 
     auto func = DefineClass(env, "Node", {
         StaticMethod("create", Node::Create),
+        StaticMethod("applyMutations", Node::ApplyMutations),
         INSTANCE_METHOD(setPositionType),
         INSTANCE_METHOD(setPosition),
         INSTANCE_METHOD(setPositionPercent),
@@ -184,6 +401,7 @@ Object Node::Init(Napi::Env env, Object exports) {
         INSTANCE_METHOD(getPadding),
         INSTANCE_METHOD(release),
         INSTANCE_METHOD(resetStyle),
+        INSTANCE_METHOD(applyStyle),
         INSTANCE_METHOD(getParent),
         INSTANCE_METHOD(getChild),
         INSTANCE_METHOD(getChildCount),
@@ -194,9 +412,11 @@ Object Node::Init(Napi::Env env, Object exports) {
         INSTANCE_METHOD(removeChild),
         INSTANCE_METHOD(setMeasureFunc),
         INSTANCE_METHOD(unsetMeasureFunc),
+        INSTANCE_METHOD(setTextMeasure),
         INSTANCE_METHOD(markDirty),
         INSTANCE_METHOD(isDirty),
         INSTANCE_METHOD(calculateLayout),
+        INSTANCE_METHOD(calculateLayoutAsync),
         INSTANCE_METHOD(getBorderBox),
         INSTANCE_METHOD(getPaddingBox),
         INSTANCE_METHOD(getComputedBorder),
@@ -204,8 +424,7 @@ Object Node::Init(Napi::Env env, Object exports) {
         INSTANCE_METHOD(getComputedMargin)
     });
 
-    constructor = Persistent(func);
-    constructor.SuppressDestruct();
+    InstanceData::Get(env).Constructor<Node>() = Persistent(func);
 
     exports.Set("Node", func);
 
@@ -213,26 +432,31 @@ Object Node::Init(Napi::Env env, Object exports) {
 }
 
 Napi::Value Node::Create(const CallbackInfo& info) {
-    if (sNodePool.empty()) {
-        auto jsNode = constructor.New({}).As<Object>();
-        auto node = ObjectWrap::Unwrap(jsNode);
+    auto& state = GetNodeState(info.Env());
+    Node *node;
+
+    if (state.freeList) {
+        node = state.freeList;
+        state.freeList = node->nextFree;
+        node->nextFree = nullptr;
+        state.freeNodeCount--;
+    } else {
+        node = NewPinned(info.Env());
+    }
 
-        sActiveNodes[node->ygNode] = Persistent(jsNode);
-        sActiveNodes[node->ygNode].SuppressDestruct();
+    node->active = true;
 
-        return jsNode;
+    if (++state.activeNodeCount > state.highWaterMark) {
+        state.highWaterMark = state.activeNodeCount;
     }
 
-    EscapableHandleScope scope(info.Env());
-    auto& poolEntry = sNodePool.back();
-    auto jsNode = poolEntry.second.Value();
-    auto ygNode = poolEntry.first;
-
-    sActiveNodes[ygNode] = std::move(poolEntry.second);
+    return node->Value();
+}
 
-    sNodePool.pop_back();
+Node *Node::FromYGNode(YGNodeRef ygNode) {
+    auto node = ygNode ? static_cast<Node *>(ygNode->getContext()) : nullptr;
 
-    return scope.Escape(jsNode);
+    return (node && node->active) ? node : nullptr;
 }
 
 void Node::release(const CallbackInfo& info) {
@@ -243,25 +467,57 @@ void Node::release(const CallbackInfo& info) {
        throw Error::New(info.Env(), "Cannot release Node with children.");
     }
 
-    auto parent = YGNodeGetParent(ygNode);
-
-    if (parent) {
-        YGNodeRemoveChild(parent, ygNode);
+    // The node stays active, and out of the free list, until the deferred release runs.
+    if (this->state->DeferIfFenced([this](Napi::Env env) { this->RemoveFromParent(); Release(this->ygNode); })) {
+        return;
     }
 
+    this->RemoveFromParent();
     this->Release(this->ygNode);
 }
 
 void Node::resetStyle(const CallbackInfo& info) {
+    this->state->CheckLayoutFence(info.Env());
     this->ResetStyle();
     this->ygNode->markDirtyAndPropogate();
 }
 
+void Node::applyStyle(const CallbackInfo& info) {
+    auto buffer = info[0].As<Float32Array>();
+    auto reset = info[1].ToBoolean().Value();
+    auto records = buffer.Data();
+    auto length = buffer.ElementLength() - (buffer.ElementLength() % STYLE_RECORD_SIZE);
+
+    // The caller may reuse the buffer, so a deferred style works on a copy.
+    if (this->state->layoutFenced) {
+        std::vector<float> copy(records, records + length);
+
+        this->state->DeferIfFenced([this, copy, reset](Napi::Env env) { this->ApplyStyle(copy.data(), copy.size(), reset); });
+    } else {
+        this->ApplyStyle(records, length, reset);
+    }
+}
+
+void Node::ApplyStyle(const float *records, size_t length, bool reset) {
+    if (reset) {
+        this->ResetStyle();
+        this->ygNode->markDirtyAndPropogate();
+    }
+
+    for (size_t i = 0; i < length; i += STYLE_RECORD_SIZE) {
+        this->ApplyStyleProperty(
+            static_cast<uint32_t>(records[i]),
+            static_cast<YGEdge>(records[i + 1]),
+            static_cast<YGUnit>(records[i + 2]),
+            records[i + 3]);
+    }
+}
+
 Napi::Value Node::getParent(const CallbackInfo& info) {
-    auto it = sActiveNodes.find(YGNodeGetParent(this->ygNode));
+    auto parent = FromYGNode(YGNodeGetParent(this->ygNode));
 
-    if (it != sActiveNodes.end()) {
-        return it->second.Value();
+    if (parent) {
+        return parent->Value();
     }
 
     return info.Env().Undefined();
@@ -269,45 +525,56 @@ Napi::Value Node::getParent(const CallbackInfo& info) {
 
 Napi::Value Node::getChild(const CallbackInfo& info) {
     int32_t index = info[0].As<Number>();
-    auto node = YGNodeGetChild(this->ygNode, index);
-    auto it = sActiveNodes.find(node);
+    auto child = FromYGNode(YGNodeGetChild(this->ygNode, index));
 
-    if (it != sActiveNodes.end()) {
-        return it->second.Value();
+    if (child) {
+        return child->Value();
     }
 
     return info.Env().Undefined();
 }
 
 void Node::insertChild(const CallbackInfo& info) {
+    this->state->CheckLayoutFence(info.Env());
     Node *child = ObjectWrap::Unwrap(info[0].As<Object>());
     int32_t index = info[1].As<Number>();
-    auto it = sActiveNodes.find(child->ygNode);
 
-    if (it != sActiveNodes.end()) {
-        YGNodeInsertChild(this->ygNode, child->ygNode, index);
-    }
+    this->InsertChild(child, index);
 }
 
 void Node::removeChild(const CallbackInfo& info) {
+    this->state->CheckLayoutFence(info.Env());
     Node *child = ObjectWrap::Unwrap(info[0].As<Object>());
-    auto it = sActiveNodes.find(child->ygNode);
 
-    if (it != sActiveNodes.end()) {
+    if (child->active) {
         YGNodeRemoveChild(this->ygNode, child->ygNode);
     }
 }
 
 void Node::pushChild(const CallbackInfo& info) {
+    this->state->CheckLayoutFence(info.Env());
     Node *child = ObjectWrap::Unwrap(info[0].As<Object>());
-    auto it = sActiveNodes.find(child->ygNode);
 
-    if (it != sActiveNodes.end()) {
-        YGNodeInsertChild(this->ygNode, child->ygNode, YGNodeGetChildCount(this->ygNode));
-    }
+    this->InsertChild(child, YGNodeGetChildCount(this->ygNode));
 }
 
 void Node::remove(const CallbackInfo& info) {
+    this->state->CheckLayoutFence(info.Env());
+    this->RemoveFromParent();
+}
+
+void Node::sendToBack(const CallbackInfo& info) {
+    this->state->CheckLayoutFence(info.Env());
+    this->SendToBack();
+}
+
+void Node::InsertChild(Node *child, uint32_t index) {
+    if (child->active) {
+        YGNodeInsertChild(this->ygNode, child->ygNode, index);
+    }
+}
+
+void Node::RemoveFromParent() {
     YGNodeRef parent = YGNodeGetParent(this->ygNode);
 
     if (parent) {
@@ -315,15 +582,93 @@ void Node::remove(const CallbackInfo& info) {
     }
 }
 
-void Node::sendToBack(const CallbackInfo& info) {
+void Node::SendToBack() {
     YGNodeRef parent = YGNodeGetParent(this->ygNode);
 
     if (!parent) {
         return;
     }
 
+    auto childCount = YGNodeGetChildCount(parent);
+
+    // Already last. The layout does not change, so there is no need to dirty the parent.
+    if (YGNodeGetChild(parent, childCount - 1) == this->ygNode) {
+        return;
+    }
+
     YGNodeRemoveChild(parent, this->ygNode);
-    YGNodeInsertChild(parent, this->ygNode, YGNodeGetChildCount(parent));
+    YGNodeInsertChild(parent, this->ygNode, childCount - 1);
+}
+
+Napi::Value Node::ApplyMutations(const CallbackInfo& info) {
+    auto buffer = info[0].As<Int32Array>();
+    auto records = buffer.Data();
+    auto length = buffer.ElementLength();
+
+    if (info[1].IsNumber()) {
+        length = std::min(length, static_cast<size_t>(std::max(info[1].As<Number>().Int32Value(), 0)));
+    }
+
+    length -= length % MUTATION_RECORD_SIZE;
+
+    auto& state = GetNodeState(info.Env());
+
+    if (state.layoutFenced) {
+        std::vector<int32_t> copy(records, records + length);
+
+        state.DeferIfFenced([&state, copy](Napi::Env env) { ApplyMutations(state, copy.data(), copy.size()); });
+    } else {
+        ApplyMutations(state, records, length);
+    }
+
+    return info.Env().Undefined();
+}
+
+void Node::ApplyMutations(NodeState& state, const int32_t *records, size_t length) {
+    for (size_t i = 0; i < length; i += MUTATION_RECORD_SIZE) {
+        auto node = FromSlot(state, records[i + 1]);
+
+        if (!node) {
+            continue;
+        }
+
+        switch (records[i]) {
+            case MUTATION_PUSH_CHILD:
+            case MUTATION_INSERT_CHILD: {
+                auto child = FromSlot(state, records[i + 2]);
+
+                if (child) {
+                    auto childCount = static_cast<int32_t>(YGNodeGetChildCount(node->ygNode));
+                    auto index = records[i] == MUTATION_PUSH_CHILD ? childCount : std::min(records[i + 3], childCount);
+
+                    node->InsertChild(child, std::max(index, 0));
+                }
+                break;
+            }
+            case MUTATION_REMOVE:
+                node->RemoveFromParent();
+                break;
+            case MUTATION_SEND_TO_BACK:
+                node->SendToBack();
+                break;
+            case MUTATION_RELEASE:
+                node->RemoveFromParent();
+                Release(node->ygNode);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+Node *Node::FromSlot(NodeState& state, int32_t slot) {
+    if (slot < 0 || static_cast<size_t>(slot) >= state.nodesBySlot.size()) {
+        return nullptr;
+    }
+
+    auto node = state.nodesBySlot[slot];
+
+    return (node && node->active) ? node : nullptr;
 }
 
 void Node::setMeasureFunc(const Napi::CallbackInfo& info) {
@@ -334,23 +679,32 @@ void Node::setMeasureFunc(const Napi::CallbackInfo& info) {
 
     auto func = info[0].As<Function>();
 
+    if (this->state->layoutFenced) {
+        // The node's current measure function may be running on the layout thread, so it is replaced after the
+        // layout completes.
+        auto funcRef = std::make_shared<FunctionReference>(Persistent(func));
+
+        this->state->DeferIfFenced([this, funcRef](Napi::Env env) { this->SetMeasureFunc(funcRef->Value()); });
+    } else {
+        this->SetMeasureFunc(func);
+    }
+}
+
+void Node::SetMeasureFunc(Napi::Function func) {
     this->ResetMeasureFunc();
     this->measureFunc.Reset(func, 1);
 
     YGNodeSetMeasureFunc(this->ygNode, [](YGNodeRef nodeRef, float width, YGMeasureMode widthMode, float height, YGMeasureMode heightMode) -> YGSize {
         YGSize size = { 0, 0 };
-        auto it = sActiveNodes.find(nodeRef);
+        auto node = FromYGNode(nodeRef);
 
-        if (it == sActiveNodes.end()) {
+        if (!node) {
             return size;
         }
 
-        auto env = it->second.Env();
+        auto env = node->Env();
         HandleScope scope(env);
 
-        auto jsNode = it->second.Value().As<Object>();
-        Node *node = ObjectWrap::Unwrap(jsNode);
-
         auto result = node->measureFunc.Call({
             Number::New(env, width),
             Number::New(env, widthMode),
@@ -372,37 +726,239 @@ void Node::setMeasureFunc(const Napi::CallbackInfo& info) {
 }
 
 void Node::unsetMeasureFunc(const Napi::CallbackInfo& info) {
+    if (this->state->DeferIfFenced([this](Napi::Env env) { this->ResetMeasureFunc(); })) {
+        return;
+    }
+
     this->ResetMeasureFunc();
 }
 
+void Node::setTextMeasure(const Napi::CallbackInfo& info) {
+    auto layoutObject = info[0].As<Object>();
+    auto sampleValue = info[1];
+    auto text = info[2].IsString() ? info[2].As<String>().Utf8Value() : std::string();
+    auto maxLines = info[3].IsNumber() ? info[3].As<Number>().Int32Value() : 0;
+    auto ellipsize = info[4].ToBoolean().Value();
+
+    if (this->state->layoutFenced) {
+        // The text layout may be measuring on the layout thread, so the change is applied after the layout completes.
+        auto layoutRef = std::make_shared<ObjectReference>(Persistent(layoutObject));
+        auto sampleRef = std::make_shared<ObjectReference>();
+
+        if (sampleValue.IsObject()) {
+            *sampleRef = Persistent(sampleValue.As<Object>());
+        }
+
+        this->state->DeferIfFenced([this, layoutRef, sampleRef, text, maxLines, ellipsize](Napi::Env env) {
+            this->SetTextMeasure(layoutRef->Value(), sampleRef->IsEmpty() ? env.Null() : sampleRef->Value(), text,
+                maxLines, ellipsize);
+        });
+    } else {
+        this->SetTextMeasure(layoutObject, sampleValue, text, maxLines, ellipsize);
+    }
+}
+
+void Node::SetTextMeasure(Napi::Object layoutObject, Napi::Value sampleValue, const std::string& text,
+        int32_t maxLines, bool ellipsize) {
+    if (!this->textMeasure) {
+        this->ResetMeasureFunc();
+        this->textMeasure.reset(new TextMeasure());
+        this->textMeasure->layout = ObjectWrap<TextLayout>::Unwrap(layoutObject);
+        this->textMeasure->layoutRef.Reset(layoutObject, 1);
+        this->textMeasure->sample = nullptr;
+
+        YGNodeSetMeasureFunc(this->ygNode, [](YGNodeRef nodeRef, float width, YGMeasureMode widthMode, float height, YGMeasureMode heightMode) -> YGSize {
+            auto node = FromYGNode(nodeRef);
+            auto textMeasure = node ? node->textMeasure.get() : nullptr;
+            YGSize size = { 0, 0 };
+
+            // No font sample means the font has not loaded yet.
+            if (!textMeasure || !textMeasure->sample) {
+                return size;
+            }
+
+            auto layout = textMeasure->layout;
+            std::lock_guard<std::mutex> lock(layout->GetMutex());
+
+            layout->Layout(
+                textMeasure->text,
+                textMeasure->sample,
+                textMeasure->maxLines,
+                textMeasure->ellipsize,
+                std::isnan(width) ? 0 : static_cast<int>(width),
+                widthMode,
+                std::isnan(height) ? 0 : static_cast<int>(height),
+                heightMode);
+
+            size.width = layout->GetMeasuredWidth();
+            size.height = layout->GetMeasuredHeight();
+
+            return size;
+        });
+    } else if (this->textMeasure->layoutRef.Value() != layoutObject) {
+        this->textMeasure->layout = ObjectWrap<TextLayout>::Unwrap(layoutObject);
+        this->textMeasure->layoutRef.Reset(layoutObject, 1);
+    }
+
+    auto previousSample = this->textMeasure->sample;
+
+    if (sampleValue.IsObject()) {
+        auto sampleObject = sampleValue.As<Object>();
+
+        if (this->textMeasure->sampleRef.IsEmpty() || this->textMeasure->sampleRef.Value() != sampleObject) {
+            this->textMeasure->sample = ObjectWrap<FontSample>::Unwrap(sampleObject);
+            this->textMeasure->sampleRef.Reset(sampleObject, 1);
+        }
+    } else {
+        this->textMeasure->sample = nullptr;
+        this->textMeasure->sampleRef.Reset();
+    }
+
+    // A cached measurement of different text must not be reused. This matters when the change was deferred past an
+    // asynchronous layout, which may have measured the old text after javascript reset the text layout.
+    if (previousSample != this->textMeasure->sample || this->textMeasure->text != text
+            || this->textMeasure->maxLines != maxLines || this->textMeasure->ellipsize != ellipsize) {
+        this->textMeasure->layout->Invalidate();
+    }
+
+    this->textMeasure->text = text;
+    this->textMeasure->maxLines = maxLines;
+    this->textMeasure->ellipsize = ellipsize;
+}
+
 void Node::markDirty(const Napi::CallbackInfo& info) {
+    if (this->state->DeferIfFenced([this](Napi::Env env) { this->ygNode->markDirtyAndPropogate(); })) {
+        return;
+    }
+
     this->ygNode->markDirtyAndPropogate();
 }
 
 Napi::Value Node::isDirty(const Napi::CallbackInfo& info) {
+    this->state->CheckLayoutFence(info.Env());
+
     return Boolean::New(info.Env(), YGNodeIsDirty(this->ygNode));
 }
 
-void Node::calculateLayout(const Napi::CallbackInfo& info) {
+void Yoga::CalculateLayout(YGNodeRef root, float width, float height, YGDirection direction) {
+    std::lock_guard<std::mutex> lock(sCalculateLayoutMutex);
+
+    YGNodeCalculateLayout(root, width, height, direction);
+}
+
+Napi::Value Node::calculateLayout(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    EscapableHandleScope scope(env);
+    double width = info[0].As<Number>();
+    double height = info[1].As<Number>();
+    auto direction = info[2].IsNumber() ? static_cast<YGDirection>(info[2].As<Number>().Int32Value()) : YGDirectionLTR;
+    auto returnChangedNodes = info[3].ToBoolean().Value();
+
+    this->state->CheckLayoutFence(env);
+
+    CalculateLayout(this->ygNode, width, height, direction);
+
+    return scope.Escape(this->SyncLayout(env, returnChangedNodes));
+}
+
+Napi::Value Node::calculateLayoutAsync(const Napi::CallbackInfo& info) {
     auto env = info.Env();
-    HandleScope scope(env);
     double width = info[0].As<Number>();
     double height = info[1].As<Number>();
     auto direction = info[2].IsNumber() ? static_cast<YGDirection>(info[2].As<Number>().Int32Value()) : YGDirectionLTR;
-    auto zero = Number::New(env, 0);
+    auto returnChangedNodes = info[3].ToBoolean().Value();
+
+    this->state->CheckLayoutFence(env);
+
+    // Javascript measure functions can only be called on the main thread. Fall back to a synchronous layout.
+    if (HasJavascriptMeasure(this->ygNode)) {
+        auto deferred = Promise::Deferred::New(env);
+
+        CalculateLayout(this->ygNode, width, height, direction);
+        deferred.Resolve(this->SyncLayout(env, returnChangedNodes));
+
+        return deferred.Promise();
+    }
+
+    auto worker = new CalculateLayoutAsyncWorker(env, this->Value(), width, height, direction, returnChangedNodes);
+
+    this->state->layoutFenced = true;
+    worker->Queue();
+
+    return worker->Promise();
+}
+
+Napi::Value Node::PublishLayout(Napi::Env env, bool returnChangedNodes) {
+    EscapableHandleScope scope(env);
+    // Copy all results to the layout buffer in one step on the main thread, so javascript never reads a partial layout.
+    auto result = this->SyncLayout(env, returnChangedNodes);
+
+    this->LowerLayoutFence(env);
+
+    return scope.Escape(result);
+}
+
+void Node::LowerLayoutFence(Napi::Env env) {
+    std::vector<std::function<void(Napi::Env)>> operations;
+
+    this->state->layoutFenced = false;
+    operations.swap(this->state->fencedOperations);
+
+    for (auto& operation : operations) {
+        operation(env);
+    }
+}
+
+Napi::Value Node::SyncLayout(Napi::Env env, bool returnChangedNodes) {
+    // Computed fields are copied to the node's slot in the shared layout buffer. Javascript reads layout information
+    // straight from the Float32Array, without calling into native code or creating temporary objects and arrays.
+
+    auto& changed = this->state->changedNodes;
+
+    changed.clear();
+    this->state->SyncComputedFields(this->ygNode);
+
+    if (!changed.empty()) {
+        this->state->layoutGeneration++;
+    }
+
+    if (!returnChangedNodes) {
+        return env.Undefined();
+    }
+
+    auto changedNodes = Array::New(env, changed.size());
+    uint32_t i = 0;
+
+    for (auto node : changed) {
+        changedNodes[i++] = node->Value();
+    }
+
+    return changedNodes;
+}
+
+bool Node::HasJavascriptMeasure(YGNodeRef ygNode) {
+    auto node = FromYGNode(ygNode);
+
+    if (node && !node->measureFunc.IsEmpty()) {
+        return true;
+    }
 
-    YGNodeCalculateLayout(this->ygNode, width, height, direction);
+    const uint32_t childCount = YGNodeGetChildCount(ygNode);
+
+    for (uint32_t i = 0; i < childCount; i++) {
+        if (HasJavascriptMeasure(YGNodeGetChild(ygNode, i))) {
+            return true;
+        }
+    }
 
-    // Computed fields are copied to the numbered indexed fields of the node object. This avoids javascript from
-    // calling into native code to get layout information (and constructing temporary objects and arrays). This is
-    // a performance improvement for the existing design. Rendering needs to be refactored to clearly delineate
-    // javascript and native responsibilities.
-     
-    SyncComputedFields(env, this->ygNode, YGNodeCurrentLayoutGeneration(), zero);
+    return false;
 }
 
 Napi::Value Node::getBorderBox(const Napi::CallbackInfo& info) {
     auto env = info.Env();
+
+    this->state->CheckLayoutFence(env);
+
     auto layout = Array::New(env, 4);
 
     layout[0u] = Number::New(env, YGNodeLayoutGetLeft(this->ygNode));
@@ -415,6 +971,9 @@ Napi::Value Node::getBorderBox(const Napi::CallbackInfo& info) {
 
 Napi::Value Node::getPaddingBox(const Napi::CallbackInfo& info) {
     auto env = info.Env();
+
+    this->state->CheckLayoutFence(env);
+
     auto layout = Array::New(env, 4);
 
     auto paddingTop = YGNodeLayoutGetPadding(this->ygNode, YGEdgeTop);
@@ -432,6 +991,9 @@ Napi::Value Node::getPaddingBox(const Napi::CallbackInfo& info) {
 
 Napi::Value Node::getComputedBorder(const Napi::CallbackInfo& info) {
     auto env = info.Env();
+
+    this->state->CheckLayoutFence(env);
+
     auto layout = Array::New(env, 4);
 
     layout[0u] = Number::New(env, YGNodeLayoutGetBorder(this->ygNode, YGEdgeTop));
@@ -444,6 +1006,9 @@ Napi::Value Node::getComputedBorder(const Napi::CallbackInfo& info) {
 
 Napi::Value Node::getComputedPadding(const Napi::CallbackInfo& info) {
     auto env = info.Env();
+
+    this->state->CheckLayoutFence(env);
+
     auto layout = Array::New(env, 4);
 
     layout[0u] = Number::New(env, YGNodeLayoutGetPadding(this->ygNode, YGEdgeTop));
@@ -456,6 +1021,9 @@ Napi::Value Node::getComputedPadding(const Napi::CallbackInfo& info) {
 
 Napi::Value Node::getComputedMargin(const Napi::CallbackInfo& info) {
     auto env = info.Env();
+
+    this->state->CheckLayoutFence(env);
+
     auto layout = Array::New(env, 4);
 
     layout[0u] = Number::New(env, YGNodeLayoutGetMargin(this->ygNode, YGEdgeTop));
@@ -527,37 +1095,115 @@ SET_DOUBLE_AND_PERCENT_BY_EDGE_IMPL(setPadding, YGNodeStyleSetPadding)
 SET_DOUBLE_AND_PERCENT_BY_EDGE_IMPL(setMargin, YGNodeStyleSetMargin)
 
 void Node::setWidthAuto(const CallbackInfo& info) {
+    this->state->CheckLayoutFence(info.Env());
     YGNodeStyleSetWidthAuto(this->ygNode);
 }
 
 void Node::setHeightAuto(const CallbackInfo& info) {
+    this->state->CheckLayoutFence(info.Env());
     YGNodeStyleSetHeightAuto(this->ygNode);
 }
 
 void Node::setMarginAuto(const CallbackInfo& info) {
+    this->state->CheckLayoutFence(info.Env());
     YGNodeStyleSetMarginAuto(this->ygNode, static_cast<YGEdge>(info[0].As<Number>().Int32Value()));
 }
 
-int Node::GetInstanceCount() {
-    return static_cast<int32_t>(sActiveNodes.size());
+const float *Node::GetComputedFields() const {
+    return this->state->layoutData + this->slot * COMPUTED_FIELD_COUNT;
+}
+
+uint32_t Node::GetLayoutGeneration(Napi::Env env) {
+    return GetNodeState(env).layoutGeneration;
+}
+
+int Node::GetInstanceCount(Napi::Env env) {
+    return GetNodeState(env).activeNodeCount;
 }
 
 void Node::ResetStyle() {
     this->ygNode->setStyle(sEmptyStyle);
 }
 
+#define APPLY_ENUM(property, ygMethod, type) case property: \
+    ygMethod(this->ygNode, static_cast<type>(value)); \
+    break;
+
+#define APPLY_NUMBER(property, ygMethod) case property: \
+    ygMethod(this->ygNode, value); \
+    break;
+
+#define APPLY_NUMBER_PERCENT(property, ygMethod) case property: \
+    unit == YGUnitPercent ? CONCAT(ygMethod, Percent)(this->ygNode, value) : ygMethod(this->ygNode, value); \
+    break;
+
+#define APPLY_NUMBER_PERCENT_AUTO(property, ygMethod) case property: \
+    if (unit == YGUnitAuto) { \
+        CONCAT(ygMethod, Auto)(this->ygNode); \
+    } else { \
+        unit == YGUnitPercent ? CONCAT(ygMethod, Percent)(this->ygNode, value) : ygMethod(this->ygNode, value); \
+    } \
+    break;
+
+#define APPLY_EDGE_NUMBER_PERCENT(property, ygMethod) case property: \
+    unit == YGUnitPercent ? CONCAT(ygMethod, Percent)(this->ygNode, edge, value) : ygMethod(this->ygNode, edge, value); \
+    break;
+
+void Node::ApplyStyleProperty(uint32_t property, YGEdge edge, YGUnit unit, float value) {
+    switch (property) {
+        APPLY_ENUM(STYLE_ALIGN_CONTENT, YGNodeStyleSetAlignContent, YGAlign)
+        APPLY_ENUM(STYLE_ALIGN_ITEMS, YGNodeStyleSetAlignItems, YGAlign)
+        APPLY_ENUM(STYLE_ALIGN_SELF, YGNodeStyleSetAlignSelf, YGAlign)
+        APPLY_ENUM(STYLE_DISPLAY, YGNodeStyleSetDisplay, YGDisplay)
+        APPLY_ENUM(STYLE_FLEX_DIRECTION, YGNodeStyleSetFlexDirection, YGFlexDirection)
+        APPLY_ENUM(STYLE_FLEX_WRAP, YGNodeStyleSetFlexWrap, YGWrap)
+        APPLY_ENUM(STYLE_JUSTIFY_CONTENT, YGNodeStyleSetJustifyContent, YGJustify)
+        APPLY_ENUM(STYLE_OVERFLOW, YGNodeStyleSetOverflow, YGOverflow)
+        APPLY_ENUM(STYLE_POSITION_TYPE, YGNodeStyleSetPositionType, YGPositionType)
+        APPLY_NUMBER(STYLE_FLEX, YGNodeStyleSetFlex)
+        APPLY_NUMBER(STYLE_FLEX_GROW, YGNodeStyleSetFlexGrow)
+        APPLY_NUMBER(STYLE_FLEX_SHRINK, YGNodeStyleSetFlexShrink)
+        APPLY_NUMBER_PERCENT(STYLE_FLEX_BASIS, YGNodeStyleSetFlexBasis)
+        APPLY_NUMBER_PERCENT_AUTO(STYLE_WIDTH, YGNodeStyleSetWidth)
+        APPLY_NUMBER_PERCENT_AUTO(STYLE_HEIGHT, YGNodeStyleSetHeight)
+        APPLY_NUMBER_PERCENT(STYLE_MIN_WIDTH, YGNodeStyleSetMinWidth)
+        APPLY_NUMBER_PERCENT(STYLE_MIN_HEIGHT, YGNodeStyleSetMinHeight)
+        APPLY_NUMBER_PERCENT(STYLE_MAX_WIDTH, YGNodeStyleSetMaxWidth)
+        APPLY_NUMBER_PERCENT(STYLE_MAX_HEIGHT, YGNodeStyleSetMaxHeight)
+        APPLY_EDGE_NUMBER_PERCENT(STYLE_PADDING, YGNodeStyleSetPadding)
+        APPLY_EDGE_NUMBER_PERCENT(STYLE_POSITION, YGNodeStyleSetPosition)
+        case STYLE_BORDER:
+            YGNodeStyleSetBorder(this->ygNode, edge, value);
+            break;
+        case STYLE_MARGIN:
+            if (unit == YGUnitAuto) {
+                YGNodeStyleSetMarginAuto(this->ygNode, edge);
+            } else {
+                unit == YGUnitPercent ? YGNodeStyleSetMarginPercent(this->ygNode, edge, value) : YGNodeStyleSetMargin(this->ygNode, edge, value);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
 void Node::ResetMeasureFunc() {
     if (!this->measureFunc.IsEmpty()) {
         this->measureFunc.Unref();
         this->measureFunc.Reset();
         YGNodeSetMeasureFunc(this->ygNode, nullptr);
     }
+
+    if (this->textMeasure) {
+        this->textMeasure.reset();
+        YGNodeSetMeasureFunc(this->ygNode, nullptr);
+    }
 }
 
 void Node::Release(YGNodeRef ygNode) {
-    auto it = sActiveNodes.find(ygNode);
+    auto node = FromYGNode(ygNode);
 
-    if (it == sActiveNodes.end()) {
+    if (!node) {
         return;
     }
 
@@ -569,12 +1215,16 @@ void Node::Release(YGNodeRef ygNode) {
 
     YGNodeRemoveAllChildren(ygNode);
 
-    auto node = ObjectWrap::Unwrap(it->second.Value());
-
     node->ResetStyle();
     node->ResetMeasureFunc();
+    node->state->ResetSlot(node->slot);
     ygNode->setDirty(false);
 
-    sNodePool.push_back(std::make_pair(ygNode, std::move(it->second)));
-    sActiveNodes.erase(ygNode);
+    auto state = node->state;
+
+    node->active = false;
+    node->nextFree = state->freeList;
+    state->freeList = node;
+    state->freeNodeCount++;
+    state->activeNodeCount--;
 }
@@ -5,11 +5,10 @@
  */
 
 #include "YogaValue.h"
+#include "InstanceData.h"
 
 using namespace Yoga;
 
-Napi::FunctionReference Value::constructor;
-
 Value::Value(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Value>(info) {
     auto len = info.Length();
 
@@ -35,8 +34,7 @@ Napi::Object Value::Init(Napi::Env env, Napi::Object exports) {
         InstanceValue("unit", Napi::Number::New(env, YGUnitUndefined), napi_property_attributes::napi_writable),
     });
 
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    InstanceData::Get(env).Constructor<Value>() = Napi::Persistent(func);
 
     exports.Set("Value", func);
 
@@ -44,9 +42,11 @@ Napi::Object Value::Init(Napi::Env env, Napi::Object exports) {
 }
 
 Napi::Value Value::New(Napi::Env env, const YGValue& ygValue) {
+    auto& constructor = InstanceData::Get(env).Constructor<Value>();
+
     if (ygValue.unit == YGUnitUndefined || ygValue.unit == YGUnitAuto) {
-        return Value::constructor.New({ Napi::Number::New(env, ygValue.unit) });
+        return constructor.New({ Napi::Number::New(env, ygValue.unit) });
     }
 
-    return Value::constructor.New({ Napi::Number::New(env, ygValue.unit), Napi::Number::New(env, ygValue.value) });
+    return constructor.New({ Napi::Number::New(env, ygValue.unit), Napi::Number::New(env, ygValue.value) });
 }
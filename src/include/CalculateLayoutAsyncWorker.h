@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include <Yoga.h>
+
+namespace Yoga {
+
+class Node;
+
+/**
+ * Runs Yoga::CalculateLayout() for a tree on a libuv worker thread.
+ *
+ * The tree must only contain native measure functions. The caller raises the layout fence before queueing the worker,
+ * so javascript cannot modify the tree while the layout runs. On completion, results are published to the layout
+ * buffer on the main thread and the promise resolves with the calculateLayout() result.
+ */
+class CalculateLayoutAsyncWorker : public Napi::AsyncWorker {
+public:
+    CalculateLayoutAsyncWorker(Napi::Env env, Napi::Object root, float width, float height, YGDirection direction,
+        bool returnChangedNodes);
+    virtual ~CalculateLayoutAsyncWorker() {}
+
+    Napi::Value Promise();
+
+protected:
+    virtual void Execute();
+    virtual void OnOK();
+    virtual void OnError(const Napi::Error& e);
+
+private:
+    Napi::Promise::Deferred promise;
+    Napi::ObjectReference rootRef;
+    Node *root;
+    YGNodeRef ygRoot;
+    float width;
+    float height;
+    YGDirection direction;
+    bool returnChangedNodes;
+};
+
+}
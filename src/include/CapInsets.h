@@ -32,8 +32,6 @@ public:
 
 
 private:
-    static Napi::FunctionReference constructor;
-
     Rectangle rect;
 };
 
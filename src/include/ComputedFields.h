@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <Yoga.h>
+#include <cstdint>
+
+namespace Yoga {
+
+// Layout of a node's computed fields in the shared layout buffer (Node.layout). Each node owns COMPUTED_FIELD_COUNT
+// floats, starting at slot * COMPUTED_FIELD_COUNT. Kept free of napi, so the native layout benchmark can use it.
+enum ComputedFields : uint32_t {
+    COMPUTED_LAYOUT_TOP = 0,
+    COMPUTED_LAYOUT_RIGHT = 1,
+    COMPUTED_LAYOUT_BOTTOM = 2,
+    COMPUTED_LAYOUT_LEFT = 3,
+    COMPUTED_LAYOUT_WIDTH = 4,
+    COMPUTED_LAYOUT_HEIGHT = 5,
+
+    COMPUTED_BORDER_TOP = 6,
+    COMPUTED_BORDER_RIGHT = 7,
+    COMPUTED_BORDER_BOTTOM = 8,
+    COMPUTED_BORDER_LEFT = 9,
+
+    COMPUTED_PADDING_TOP = 10,
+    COMPUTED_PADDING_RIGHT = 11,
+    COMPUTED_PADDING_BOTTOM = 12,
+    COMPUTED_PADDING_LEFT = 13,
+
+    COMPUTED_MARGIN_TOP = 14,
+    COMPUTED_MARGIN_RIGHT = 15,
+    COMPUTED_MARGIN_BOTTOM = 16,
+    COMPUTED_MARGIN_LEFT = 17,
+
+    COMPUTED_FIELD_COUNT = 18,
+};
+
+// Returns the COMPUTED_FIELD_COUNT layout buffer floats of a node, or nullptr if the node has no slot.
+typedef float *(*ComputedFieldsLookup)(YGNodeRef ygNode, void *context);
+// Called for each node whose computed fields changed.
+typedef void (*ComputedFieldsChanged)(YGNodeRef ygNode, void *context);
+
+/**
+ * Copy the computed layout of the nodes laid out since the last sync into their layout buffer fields.
+ *
+ * Yoga sets hasNewLayout on every node it visits during layout. The flag is cleared here, so a subtree that was not
+ * visited is skipped. A node without fields is not copied, but its children are. Fields that hold the same values
+ * are left as they are, and changed is not called for the node.
+ */
+void SyncComputedFields(YGNodeRef root, ComputedFieldsLookup lookup, ComputedFieldsChanged changed, void *context);
+
+}
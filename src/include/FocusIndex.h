@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef FOCUSINDEX_H
+#define FOCUSINDEX_H
+
+#include <napi.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Yoga {
+
+class Node;
+
+// Navigation directions. Values match Direction in lib/Core/Views/Direction.js.
+enum FocusDirection : int32_t {
+    FOCUS_DIRECTION_LEFT = 1,
+    FOCUS_DIRECTION_RIGHT = 2,
+    FOCUS_DIRECTION_UP = 3,
+    FOCUS_DIRECTION_DOWN = 4,
+};
+
+// Absolute border box, in screen coordinates.
+struct FocusBox {
+    float left;
+    float top;
+    float right;
+    float bottom;
+};
+
+/**
+ * Spatial index of focusable nodes for directional focus navigation.
+ *
+ * The absolute border boxes of the registered nodes are bucketed in a uniform grid. Boxes are read from the published
+ * layout buffer and refreshed lazily: a query after a layout that changed computed fields re-reads the boxes of only
+ * the entries whose node, or one of its ancestors, was changed by the layout.
+ *
+ * Registration is managed by the FocusManager: only focusable views that are visible and attached to the root view
+ * are in the index.
+ *
+ * findNext() scans grid columns (or rows) outward from the source in the navigation direction. Candidates that
+ * overlap the source's beam (the source box extended in the navigation direction) win over diagonal candidates.
+ * Otherwise, candidates are ranked by the major axis distance, weighted, plus the minor axis distance. The scan stops
+ * as soon as no unvisited cell can hold a better candidate.
+ */
+class FocusIndex : public Napi::ObjectWrap<FocusIndex> {
+public:
+    FocusIndex(const Napi::CallbackInfo& info);
+    virtual ~FocusIndex() {}
+
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+
+    void add(const Napi::CallbackInfo& info);
+    void remove(const Napi::CallbackInfo& info);
+    Napi::Value findNext(const Napi::CallbackInfo& info);
+    Napi::Value getSize(const Napi::CallbackInfo& info);
+    void clear(const Napi::CallbackInfo& info);
+
+private:
+    struct Entry {
+        Napi::ObjectReference ref;
+        Node *node;
+        FocusBox box;
+        bool indexed;
+        int32_t minCol;
+        int32_t maxCol;
+        int32_t minRow;
+        int32_t maxRow;
+        uint32_t visit;
+    };
+
+    struct Candidate {
+        const Entry *entry;
+        bool inBeam;
+        // Distance to the candidate's near edge and far edge on the navigation axis.
+        float major;
+        float farMajor;
+        float score;
+    };
+
+    float cellSize;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> freeEntries;
+    std::unordered_map<Node *, uint32_t> entryByNode;
+    std::unordered_map<int64_t, std::vector<uint32_t>> cells;
+    // Bounds of all cells that have been occupied since the index was last empty.
+    int32_t minCol;
+    int32_t maxCol;
+    int32_t minRow;
+    int32_t maxRow;
+    uint32_t layoutGeneration;
+    bool stale;
+    uint32_t visit;
+    // Per Update() call: whether a node's absolute position may have changed since the previous update.
+    std::unordered_map<Node *, bool> moved;
+
+    void Update(Napi::Env env);
+    bool IsMoved(Node *node);
+    void Insert(uint32_t id);
+    void Erase(uint32_t id);
+    void Release(uint32_t id);
+    int32_t ToCell(float coordinate) const;
+    const Entry *Find(const FocusBox& source, Node *exclude, int32_t direction);
+    static bool Beats(const Candidate& candidate, const Candidate& best, bool horizontal);
+    static bool GetBorderBox(Node *node, FocusBox& box);
+};
+
+}
+
+#endif
@@ -11,15 +11,35 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <memory>
 #include <cstdint>
 
 struct CodepointMetrics {
+    // Index of the atlas page containing the glyph. sourceX and sourceY are relative to the page.
+    int page;
     int sourceX, sourceY, sourceWidth, sourceHeight;
     float destX, destY, destWidth, destHeight;
     float xOffset, yOffset;
     float xAdvance;
 };
 
+// Alpha bitmap holding a subset of the glyphs of a font sample.
+struct FontSamplePage {
+    int32_t width;
+    int32_t height;
+    // Either owned by the sample or borrowed from a memory mapped cache file.
+    std::shared_ptr<const uint8_t> pixels;
+};
+
+// Rendered glyph atlas and font metrics for a font at a given size.
+struct FontSampleData {
+    float ascent;
+    float lineHeight;
+    std::vector<FontSamplePage> pages;
+    std::map<int32_t, CodepointMetrics> codepointMetrics;
+    std::map<uint32_t, float> kerningPairs;
+};
+
 class FontSample {
 public:
     FontSample();
@@ -30,9 +50,8 @@ public:
     FontWeight GetFontWeight() const { return this->fontWeight; }
     int GetFontSize() const { return this->fontSize; }
 
-    int GetTextureWidth() const { return this->textureWidth; }
-    int GetTextureHeight() const { return this->textureHeight; }
-    const unsigned char *GetTexturePixels() const;
+    int GetPageCount() const { return static_cast<int>(this->pages.size()); }
+    const FontSamplePage& GetPage(int index) const { return this->pages[index]; }
 
     float GetAscent() { return this->ascent; }
     float GetLineHeight() { return this->lineHeight; }
@@ -49,9 +68,7 @@ protected:
     float ascent;
     float lineHeight;
 
-    std::vector<unsigned char> texturePixels;
-    int textureWidth;
-    int textureHeight;
+    std::vector<FontSamplePage> pages;
 
     std::map<int, CodepointMetrics> codepointMetrics;
     std::map<uint32_t, float> kerningPairs;
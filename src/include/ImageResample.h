@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef IMAGERESAMPLE_H
+#define IMAGERESAMPLE_H
+
+#include "TextureFormat.h"
+
+/**
+ * Resize an RGBA image and convert it to a texture format in one pass.
+ *
+ * Each axis is filtered separately: an area (box) filter where the axis shrinks and Lanczos-3 where it grows. Colors
+ * are filtered with premultiplied alpha, so transparent pixels do not bleed into their neighbours. Source rows are
+ * filtered horizontally once, into a small ring of rows covering the vertical filter, so the temporary memory is
+ * proportional to the target width rather than the source size.
+ *
+ * If premultipliedAlpha is set, the colors are stored premultiplied by alpha, as filtered, rather than unpremultiplied.
+ *
+ * Returns a PixelPoolAlloc() allocated buffer of targetWidth * targetHeight * 4 bytes, to be released with
+ * PixelPoolFree(). Throws std::runtime_error if allocation fails.
+ */
+unsigned char *ResampleImage(const unsigned char *source, int sourceWidth, int sourceHeight, int targetWidth,
+    int targetHeight, TextureFormat format, bool premultipliedAlpha);
+
+// Compute the size of an image scaled to width x height. If one of the dimensions is <= 0, it is derived from the
+// other, preserving the source aspect ratio. Returns false if no resize was requested.
+bool GetResampleSize(int sourceWidth, int sourceHeight, int width, int height, int& targetWidth, int& targetHeight);
+
+#endif
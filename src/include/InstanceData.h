@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef INSTANCEDATA_H
+#define INSTANCEDATA_H
+
+#include <napi.h>
+#include <map>
+#include <memory>
+#include <typeindex>
+#include <typeinfo>
+
+/**
+ * Per-environment state of an addon.
+ *
+ * An addon can be loaded by the main thread and by any number of worker_threads, each with its own napi_env. Class
+ * constructors and other state tied to an environment are kept here, rather than in statics. The instance is
+ * attached to the environment with napi_set_instance_data() and deleted when the environment is torn down.
+ */
+class InstanceData {
+public:
+    // Get the instance data of env, creating it on first use. Must be called from the environment's thread.
+    static InstanceData& Get(Napi::Env env) {
+        void *data = nullptr;
+
+        if (napi_get_instance_data(env, &data) != napi_ok) {
+            throw Napi::Error::New(env, "Failed to get addon instance data.");
+        }
+
+        if (!data) {
+            auto instance = new InstanceData();
+
+            if (napi_set_instance_data(env, instance, Finalize, nullptr) != napi_ok) {
+                delete instance;
+                throw Napi::Error::New(env, "Failed to set addon instance data.");
+            }
+
+            data = instance;
+        }
+
+        return *static_cast<InstanceData *>(data);
+    }
+
+    // Constructor of an ObjectWrap class, set by the class Init().
+    template<typename T>
+    Napi::FunctionReference& Constructor() {
+        return this->constructors[std::type_index(typeid(T))];
+    }
+
+    // Module state, default constructed on first use.
+    template<typename T>
+    T& State() {
+        auto& state = this->states[std::type_index(typeid(T))];
+
+        if (!state) {
+            state = std::make_shared<T>();
+        }
+
+        return *std::static_pointer_cast<T>(state);
+    }
+
+private:
+    InstanceData() {}
+    InstanceData(const InstanceData&) = delete;
+    InstanceData& operator=(const InstanceData&) = delete;
+
+    static void Finalize(napi_env env, void *data, void *hint) {
+        delete static_cast<InstanceData *>(data);
+    }
+
+    std::map<std::type_index, Napi::FunctionReference> constructors;
+    std::map<std::type_index, std::shared_ptr<void>> states;
+};
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <sys/stat.h>
+
+struct MappedFileStats {
+    // Live mappings in the OpenShared() registry.
+    size_t sharedMappings;
+    // OpenShared() calls that returned an existing mapping, and calls that mapped the file.
+    uint64_t sharedHits;
+    uint64_t sharedMisses;
+};
+
+/**
+ * Read-only, memory mapped view of a file.
+ *
+ * The mapping is released when the last shared_ptr reference goes away. Pages are loaded on demand by the kernel and
+ * can be dropped under memory pressure, as they are backed by the file rather than swap.
+ */
+class MappedFile {
+public:
+    ~MappedFile();
+
+    static std::shared_ptr<MappedFile> Open(const std::string& filename);
+
+    // Open a file through a process-wide registry. If the same file (device, inode, size and modification time) is
+    // already mapped, the existing mapping is returned. Thread safe.
+    static std::shared_ptr<MappedFile> OpenShared(const std::string& filename);
+    static MappedFileStats GetSharedStats();
+
+    const uint8_t *GetData() const { return this->data; }
+    size_t GetSize() const { return this->size; }
+    const std::string& GetFilename() const { return this->filename; }
+    ino_t GetInode() const { return this->inode; }
+    time_t GetModified() const { return this->modified; }
+
+private:
+    MappedFile(const std::string& filename, const uint8_t *data, size_t size, const struct stat& info);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string filename;
+    const uint8_t *data;
+    size_t size;
+    dev_t device;
+    ino_t inode;
+    time_t modified;
+};
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef PIXELPOOL_H
+#define PIXELPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Allocations smaller than this are passed to malloc().
+#define PIXEL_POOL_MIN_SIZE (16 * 1024)
+// Allocations larger than this are mapped individually and never cached.
+#define PIXEL_POOL_MAX_SIZE (64 * 1024 * 1024)
+#define PIXEL_POOL_DEFAULT_CACHE_LIMIT (32 * 1024 * 1024)
+
+struct PixelPoolStats {
+    // Blocks handed out and not yet freed, and their capacity in bytes.
+    size_t usedBlocks;
+    size_t usedBytes;
+    size_t peakUsedBytes;
+    // Freed blocks kept for reuse.
+    size_t cachedBlocks;
+    size_t cachedBytes;
+    // Allocations served from the cache, and allocations that mapped a new block.
+    uint64_t hits;
+    uint64_t misses;
+};
+
+/**
+ * Size class allocator for image pixels and other large, short lived buffers.
+ *
+ * Decoded images are large and come and go constantly. Allocated with malloc(), they fragment the heap of a long
+ * running process until its RSS only grows. Here, each block is mapped separately from the heap, with its size
+ * rounded up to a size class (four per power of two). A freed block is kept in a free list of its class, up to a
+ * total cache limit, and handed out to the next allocation of the class. Blocks beyond the limit are unmapped, so
+ * their memory goes straight back to the system.
+ *
+ * Thread safe. Blocks are 16 byte aligned. Pointers must be released with PixelPoolFree().
+ */
+void *PixelPoolAlloc(size_t size);
+void *PixelPoolRealloc(void *pointer, size_t size);
+void PixelPoolFree(void *pointer);
+
+PixelPoolStats GetPixelPoolStats();
+// Set the maximum number of bytes of freed blocks kept for reuse. Cached blocks over the limit are released.
+void SetPixelPoolCacheLimit(size_t limit);
+// Release all cached blocks.
+void TrimPixelPool();
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "napi.h"
 #include <vector>
+#include <mutex>
 #include "FontSample.h"
 #include "Util.h"
 #include "Quad.h"
@@ -25,14 +26,15 @@ enum TextAlign {
 
 class CharacterQuad : public Quad {
 public:
-    CharacterQuad(bool newLine, float advance = 0) : Quad(), advance(advance), newLine(newLine) {
+    CharacterQuad(bool newLine, float advance = 0) : Quad(), advance(advance), newLine(newLine), page(0) {
 
     }
 
-    CharacterQuad(int sx, int sy, int sw, int sh, float dx, float dy, float dw, float dh, float advance)
+    CharacterQuad(int page, int sx, int sy, int sw, int sh, float dx, float dy, float dw, float dh, float advance)
         : Quad{sx, sy, sw, sh, dx, dy, dw, dh},
           advance(advance),
-          newLine(false) {
+          newLine(false),
+          page(page) {
 
     }
 
@@ -44,11 +46,17 @@ public:
         return this->advance;
     }
 
+    // Font sample atlas page the source rect refers to.
+    int GetPage() const {
+        return this->page;
+    }
+
     static CharacterQuad NEW_LINE;
 
 private:
     float advance;
     bool newLine;
+    int page;
 };
 
 typedef std::vector<CharacterQuad>::iterator CharacterQuadIterator;
@@ -66,7 +74,7 @@ public:
     Napi::Value GetHeight(const Napi::CallbackInfo& info);
 
     void Layout(
-        const std::string text,
+        const std::string& text,
         FontSample *sample,
         int maxLines,
         bool ellipsize,
@@ -77,6 +85,19 @@ public:
 
     float GetLineAlignmentOffset(int lineIndex, TextAlign textAlign);
 
+    // Force the next Layout() call to measure, even if the previous measurement is still valid.
+    void Invalidate() {
+        this->measured = false;
+    }
+
+    int GetMeasuredWidth() const {
+        return this->measuredWidth;
+    }
+
+    int GetMeasuredHeight() const {
+        return this->measuredHeight;
+    }
+
     CharacterQuadIterator Begin() {
         return this->quads.begin();
     }
@@ -85,15 +106,20 @@ public:
         return this->quads.end();
     }
 
-private:
-    static Napi::FunctionReference constructor;
+    // Held while the layout is calculated or its quads are read. The layout is measured on the layout thread during
+    // Node.calculateLayoutAsync() while the main thread may be drawing it.
+    std::mutex& GetMutex() {
+        return this->mutex;
+    }
 
+private:
     bool measured;
     int measuredWidth;
     int measuredHeight;
 
     std::vector<CharacterQuad> quads;
     std::vector<std::vector<float>> lineAlignmentOffset;
+    std::mutex mutex;
 
     bool IsMeasurementValid(int maxLines, bool ellipsize, int width, int widthMeasureMode, int height, int heightMeasureMode) const;
 };
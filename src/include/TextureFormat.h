@@ -17,6 +17,10 @@ enum TextureFormat {
     TEXTURE_FORMAT_ARGB = 1,
     TEXTURE_FORMAT_ABGR = 2,
     TEXTURE_FORMAT_BGRA = 3,
+    // 16 bit formats, stored as native endian uint16_t pixels with red in the high bits.
+    TEXTURE_FORMAT_RGB565 = 10,
+    TEXTURE_FORMAT_RGBA4444 = 11,
+    TEXTURE_FORMAT_RGBA5551 = 12,
     TEXTURE_FORMAT_ALPHA = 100,
 };
 
@@ -26,10 +30,23 @@ inline TextureFormat Cast(int textureFormat) {
         case TEXTURE_FORMAT_ARGB: return TEXTURE_FORMAT_ARGB;
         case TEXTURE_FORMAT_ABGR: return TEXTURE_FORMAT_ABGR;
         case TEXTURE_FORMAT_BGRA: return TEXTURE_FORMAT_BGRA;
+        case TEXTURE_FORMAT_RGB565: return TEXTURE_FORMAT_RGB565;
+        case TEXTURE_FORMAT_RGBA4444: return TEXTURE_FORMAT_RGBA4444;
+        case TEXTURE_FORMAT_RGBA5551: return TEXTURE_FORMAT_RGBA5551;
         case TEXTURE_FORMAT_ALPHA: return TEXTURE_FORMAT_ALPHA;
     }
 
     throw std::invalid_argument(Format() << "Cast: Unknown texture format: " << textureFormat >> Format::to_str);
 }
 
+inline bool IsPackedFormat(TextureFormat textureFormat) {
+    return textureFormat == TEXTURE_FORMAT_RGB565
+        || textureFormat == TEXTURE_FORMAT_RGBA4444
+        || textureFormat == TEXTURE_FORMAT_RGBA5551;
+}
+
+inline int GetBytesPerPixel(TextureFormat textureFormat) {
+    return IsPackedFormat(textureFormat) ? 2 : (textureFormat == TEXTURE_FORMAT_ALPHA ? 1 : 4);
+}
+
 #endif
@@ -54,7 +54,40 @@ inline std::string GetBasename(const std::string& str) {
   return str.substr(found + 1);
 }
 
+#define FNV1A64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV1A64_PRIME 0x100000001b3ULL
+
+// 64-bit FNV-1a hash. Used for cache keys, not for security.
+inline uint64_t HashBytes(const void *bytes, size_t len, uint64_t hash = FNV1A64_OFFSET_BASIS) {
+    auto p = static_cast<const uint8_t *>(bytes);
+
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ p[i]) * FNV1A64_PRIME;
+    }
+
+    return hash;
+}
+
+// Lowercase, zero padded 16 digit hex string of value. Used in cache file names.
+std::string ToHex(uint64_t value);
 void ReadBytesFromFile(const std::string filename, std::vector<unsigned char>& target);
 void ConvertToFormat(unsigned char *bytes, int len, TextureFormat format);
+// Multiply the color components of 4 byte pixels by their alpha, which is the 4th byte (RGBA byte order).
+void PremultiplyAlpha(unsigned char *bytes, int len);
+// Convert RGBA pixels, in place, to a 16 bit packed format (see IsPackedFormat()). With dither, a 4x4 ordered
+// (Bayer) dither spreads the quantization error, which hides banding in gradients. Returns the packed size in bytes.
+int PackPixels(unsigned char *bytes, int width, int height, TextureFormat format, bool dither);
+
+// Smallest width or height of a generated mip level.
+#define MIP_MIN_SIZE 8
+
+// Number of levels in the mip chain of an image, including the full size level. Each level is half the width and
+// height (rounded down) of the previous level, down to MIP_MIN_SIZE.
+int GetMipLevelCount(int width, int height);
+// Size, in bytes, of levelCount mip levels stored one after another.
+int GetMipChainSize(int width, int height, int levelCount, int bytesPerPixel);
+// Build the mip chain of 4 byte pixels. bytes holds level 0, followed by room for the remaining levels (see
+// GetMipChainSize()). Each level is a 2x2 box filter of the previous level, applied to each byte of a pixel separately.
+void BuildMipChain(unsigned char *bytes, int width, int height, int levelCount);
 
 #endif
@@ -13,4 +13,7 @@ namespace Yoga {
     Napi::Object Init(Napi::Env env, Napi::Object exports);
 
     Napi::Value GetInstanceCount(const Napi::CallbackInfo& info);
+    Napi::Value ReservePool(const Napi::CallbackInfo& info);
+    Napi::Value ShrinkPool(const Napi::CallbackInfo& info);
+    Napi::Value GetPoolStats(const Napi::CallbackInfo& info);
 }
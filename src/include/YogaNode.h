@@ -8,6 +8,12 @@
 
 #include <napi.h>
 #include <Yoga.h>
+#include "ComputedFields.h"
+#include <memory>
+#include <string>
+
+class TextLayout;
+class FontSample;
 
 namespace Yoga {
 
@@ -17,28 +23,73 @@ namespace Yoga {
 #define VOID_METHOD_WITH_PERCENT_AUTO(name) VOID_METHOD_WITH_PERCENT(name); void CONCAT(name, Auto)(const Napi::CallbackInfo& info)
 #define VALUE_METHOD(name) Napi::Value name(const Napi::CallbackInfo& info)
 
-enum ComputedFields : uint32_t {
-    COMPUTED_LAYOUT_TOP = 0,
-    COMPUTED_LAYOUT_RIGHT = 1,
-    COMPUTED_LAYOUT_BOTTOM = 2,
-    COMPUTED_LAYOUT_LEFT = 3,
-    COMPUTED_LAYOUT_WIDTH = 4,
-    COMPUTED_LAYOUT_HEIGHT = 5,
-
-    COMPUTED_BORDER_TOP = 6,
-    COMPUTED_BORDER_RIGHT = 7,
-    COMPUTED_BORDER_BOTTOM = 8,
-    COMPUTED_BORDER_LEFT = 9,
-
-    COMPUTED_PADDING_TOP = 10,
-    COMPUTED_PADDING_RIGHT = 11,
-    COMPUTED_PADDING_BOTTOM = 12,
-    COMPUTED_PADDING_LEFT = 13,
-
-    COMPUTED_MARGIN_TOP = 14,
-    COMPUTED_MARGIN_RIGHT = 15,
-    COMPUTED_MARGIN_BOTTOM = 16,
-    COMPUTED_MARGIN_LEFT = 17,
+// Style property ids used by Node.applyStyle(). A packed style is a Float32Array of STYLE_RECORD_SIZE float records:
+// property, edge (edge properties only), unit (YGUnit) and value. Enum properties store the Yoga enum in the value.
+enum StyleProperty : uint32_t {
+    STYLE_ALIGN_CONTENT = 0,
+    STYLE_ALIGN_ITEMS = 1,
+    STYLE_ALIGN_SELF = 2,
+    STYLE_DISPLAY = 3,
+    STYLE_FLEX_DIRECTION = 4,
+    STYLE_FLEX_WRAP = 5,
+    STYLE_JUSTIFY_CONTENT = 6,
+    STYLE_OVERFLOW = 7,
+    STYLE_POSITION_TYPE = 8,
+
+    STYLE_FLEX = 9,
+    STYLE_FLEX_GROW = 10,
+    STYLE_FLEX_SHRINK = 11,
+    STYLE_FLEX_BASIS = 12,
+
+    STYLE_WIDTH = 13,
+    STYLE_HEIGHT = 14,
+    STYLE_MIN_WIDTH = 15,
+    STYLE_MIN_HEIGHT = 16,
+    STYLE_MAX_WIDTH = 17,
+    STYLE_MAX_HEIGHT = 18,
+
+    STYLE_BORDER = 19,
+    STYLE_MARGIN = 20,
+    STYLE_PADDING = 21,
+    STYLE_POSITION = 22,
+
+    STYLE_RECORD_SIZE = 4,
+};
+
+// Tree mutation commands for Node.applyMutations(). A mutation log is an Int32Array of MUTATION_RECORD_SIZE int
+// records: command, node slot, child slot and index. Nodes are referenced by their layout buffer slot.
+enum MutationCommand : int32_t {
+    // node.pushChild(child)
+    MUTATION_PUSH_CHILD = 0,
+    // node.insertChild(child, index)
+    MUTATION_INSERT_CHILD = 1,
+    // node.remove()
+    MUTATION_REMOVE = 2,
+    // node.sendToBack()
+    MUTATION_SEND_TO_BACK = 3,
+    // node.release(true)
+    MUTATION_RELEASE = 4,
+
+    MUTATION_RECORD_SIZE = 4,
+};
+
+// Per-environment pools, layout buffer and layout fence. Defined in YogaNode.cc.
+struct NodeState;
+
+// Yoga keeps layout state (the generation count that validates cached measurements, and the recursion depth) in
+// process wide, non-atomic globals. Every YGNodeCalculateLayout() call, from any environment or worker thread, must go
+// through this function, which serializes them.
+void CalculateLayout(YGNodeRef root, float width, float height, YGDirection direction);
+
+// Text measured natively by a TextLayout, so that the Yoga measure callback does not have to call into javascript.
+struct TextMeasure {
+    TextLayout *layout;
+    FontSample *sample;
+    std::string text;
+    int32_t maxLines;
+    bool ellipsize;
+    Napi::ObjectReference layoutRef;
+    Napi::ObjectReference sampleRef;
 };
 
 class Node : public Napi::ObjectWrap<Node> {
@@ -47,8 +98,18 @@ public:
     virtual ~Node();
 
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
-    static int GetInstanceCount();
+    static int GetInstanceCount(Napi::Env env);
     static Napi::Value Create(const Napi::CallbackInfo& info);
+    // Apply a batch of tree mutations in one call.
+    static Napi::Value ApplyMutations(const Napi::CallbackInfo& info);
+
+    // Pre-create pooled nodes, so that at least count nodes (active and pooled) exist. The count is also the minimum
+    // number of nodes kept by ShrinkPool().
+    static void ReservePool(Napi::Env env, int32_t count);
+    // Release pooled nodes in excess of the high-water mark (active node count peak since the last shrink) to the
+    // garbage collector. Intended to be called when the application is idle.
+    static void ShrinkPool(Napi::Env env);
+    static Napi::Object GetPoolStats(Napi::Env env);
 
     VOID_METHOD(setPositionType);
     VOID_METHOD_WITH_PERCENT(setPosition);
@@ -119,6 +180,7 @@ public:
 
     VOID_METHOD(release);
     VOID_METHOD(resetStyle);
+    VOID_METHOD(applyStyle);
 
     VALUE_METHOD(getParent);
     VALUE_METHOD(getChild);
@@ -131,10 +193,15 @@ public:
 
     VOID_METHOD(setMeasureFunc);
     VOID_METHOD(unsetMeasureFunc);
+    VOID_METHOD(setTextMeasure);
 
     VOID_METHOD(markDirty);
     VALUE_METHOD(isDirty);
-    VOID_METHOD(calculateLayout);
+    VALUE_METHOD(calculateLayout);
+    // Calculate layout on a worker thread. Returns a promise for the calculateLayout() result. While the layout runs,
+    // applyStyle(), markDirty(), setTextMeasure(), release() and applyMutations() are deferred until the result is
+    // published, and all other mutations throw. Trees with javascript measure functions are laid out synchronously.
+    VALUE_METHOD(calculateLayoutAsync);
 
     VALUE_METHOD(getBorderBox);
     VALUE_METHOD(getPaddingBox);
@@ -143,15 +210,61 @@ public:
     VALUE_METHOD(getComputedPadding);
     VALUE_METHOD(getComputedMargin);
 
+    uint32_t GetSlot() const { return this->slot; }
+    YGNodeRef GetYGNode() const { return this->ygNode; }
+    bool IsActive() const { return this->active; }
+    // Computed fields of this node in the layout buffer, as of the last published layout.
+    const float *GetComputedFields() const;
+    // Incremented whenever a published layout changes the computed fields of any node in the environment.
+    static uint32_t GetLayoutGeneration(Napi::Env env);
+    // Layout generation of the last published layout that changed this node's computed fields.
+    uint32_t GetChangedGeneration() const { return this->changedGeneration; }
+
+    // Called on the main thread when an asynchronous layout of this node completes. Syncs computed fields to the
+    // layout buffer, lowers the layout fence and runs deferred operations. Returns the calculateLayout() result.
+    Napi::Value PublishLayout(Napi::Env env, bool returnChangedNodes);
+    // Lower the layout fence and run deferred operations, without publishing results (layout failed).
+    void LowerLayoutFence(Napi::Env env);
+
+    // Get the active (not released) Node that owns a Yoga node, or nullptr.
+    static Node *FromYGNode(YGNodeRef ygNode);
+
 private:
-    static Napi::FunctionReference constructor;
+    friend struct NodeState;
 
+    // Owned by the environment's InstanceData, which outlives all of the environment's nodes.
+    NodeState *state;
     YGNodeRef ygNode;
+    // Index of this node's computed fields in the shared layout buffer (Node.layout).
+    uint32_t slot;
+    // Set by NodeState::SyncComputedFields().
+    uint32_t changedGeneration;
+    // false while the node is in the free list.
+    bool active;
+    // true while the wrapper holds a strong reference to itself (active or in the free list).
+    bool pinned;
+    Node *nextFree;
     Napi::FunctionReference measureFunc;
+    std::unique_ptr<TextMeasure> textMeasure;
 
     void ResetStyle();
+    void InsertChild(Node *child, uint32_t index);
+    void RemoveFromParent();
+    void SendToBack();
+    static Node *FromSlot(NodeState& state, int32_t slot);
+    static void ApplyMutations(NodeState& state, const int32_t *records, size_t length);
+    void ApplyStyle(const float *records, size_t length, bool reset);
+    void SetMeasureFunc(Napi::Function func);
+    void SetTextMeasure(Napi::Object layoutObject, Napi::Value sampleValue, const std::string& text, int32_t maxLines,
+        bool ellipsize);
+    Napi::Value SyncLayout(Napi::Env env, bool returnChangedNodes);
+    static bool HasJavascriptMeasure(YGNodeRef ygNode);
+    void ApplyStyleProperty(uint32_t property, YGEdge edge, YGUnit unit, float value);
     void ResetMeasureFunc();
     static void Release(YGNodeRef ygNode);
+    uint32_t AllocateSlot(Napi::Env env);
+    YGNodeRef AllocateYGNode();
+    static Node *NewPinned(Napi::Env env);
 };
 
 }
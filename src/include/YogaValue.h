@@ -18,9 +18,6 @@ public:
 
     Value(const Napi::CallbackInfo& info);
     virtual ~Value() {}
-
-private:
-    static Napi::FunctionReference constructor;
 };
 
 }
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "DirectoryIndex.h"
+#include "LruCache.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+struct Listing {
+    // Modification time of the directory when it was read.
+    time_t modified;
+    // false if the directory was read in the second it was modified, in which case the listing is not reused.
+    bool isStable;
+    std::vector<std::string> names;
+};
+
+static std::mutex sMutex;
+static LruCache<std::shared_ptr<const Listing>> sListings(DIRECTORY_INDEX_MAX_ENTRIES);
+
+static std::shared_ptr<const Listing> ReadListing(const std::string& directory, time_t modified) {
+    auto dir = opendir(directory.c_str());
+
+    if (dir == nullptr) {
+        return nullptr;
+    }
+
+    auto listing = std::make_shared<Listing>();
+    struct dirent *ent;
+
+    listing->modified = modified;
+    listing->isStable = time(nullptr) > modified;
+
+    while ((ent = readdir(dir)) != nullptr) {
+        if (strcmp(ent->d_name, ".") != 0 && strcmp(ent->d_name, "..") != 0) {
+            listing->names.emplace_back(ent->d_name);
+        }
+    }
+
+    closedir(dir);
+
+    std::sort(listing->names.begin(), listing->names.end());
+
+    return listing;
+}
+
+std::string DirectoryIndex::FindByPrefix(const std::string& directory, const std::string& prefix) {
+    struct stat info;
+
+    if (stat(directory.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+        return std::string();
+    }
+
+    std::shared_ptr<const Listing> listing;
+
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+
+        sListings.Get(directory, listing);
+    }
+
+    if (!listing || !listing->isStable || listing->modified != info.st_mtime) {
+        // Read outside of the lock, so lookups in other directories are not blocked. If several threads miss at once,
+        // each reads the directory and the last listing is kept.
+        listing = ReadListing(directory, info.st_mtime);
+
+        if (!listing) {
+            return std::string();
+        }
+
+        std::lock_guard<std::mutex> lock(sMutex);
+
+        sListings.Put(directory, listing, listing->names.size() + 1);
+    }
+
+    auto& names = listing->names;
+    auto p = std::lower_bound(names.begin(), names.end(), prefix);
+
+    if (p == names.end() || p->compare(0, prefix.size(), prefix) != 0) {
+        return std::string();
+    }
+
+    return directory + "/" + *p;
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <string>
+
+#define DIRECTORY_INDEX_MAX_ENTRIES (64 * 1024)
+
+/**
+ * In-memory index of directory listings, for finding files by name prefix.
+ *
+ * Loading images by basename (box art named after a game, without the extension) otherwise reads the whole directory
+ * for every image. A directory is read once, and its file names are kept sorted, so a lookup is a binary search.
+ *
+ * An index is checked against the directory's modification time, which changes when a file is added, removed or
+ * renamed, so a lookup costs one stat() while the directory is unchanged. A listing read in the same second that the
+ * directory was modified may have missed a change made later in that second, so it is read again on the next lookup.
+ *
+ * The index is process-wide and thread safe. When the listings hold more than DIRECTORY_INDEX_MAX_ENTRIES names, the
+ * least recently used directories are dropped.
+ */
+namespace DirectoryIndex {
+
+// Find the file in directory whose name starts with prefix. If several do, the first in byte order is returned,
+// which is the name equal to prefix, if it exists. Returns the path of the file (directory + "/" + name), or an empty
+// string if no file matches or the directory cannot be read.
+std::string FindByPrefix(const std::string& directory, const std::string& prefix);
+
+}
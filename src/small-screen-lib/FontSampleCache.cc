@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "FontSampleCache.h"
+#include "MappedFile.h"
+#include "InstanceData.h"
+#include "Format.h"
+#include "Util.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <exception>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// "SSFA" when read as a little endian uint32. A cache file written on a machine with different endianness fails the
+// magic check and is treated as a miss.
+#define FONT_SAMPLE_CACHE_MAGIC 0x41465353
+// Increment when the file layout or the rendering of a sample changes.
+#define FONT_SAMPLE_CACHE_VERSION 3
+#define FONT_SAMPLE_CACHE_MAX_PAGE_SIZE 16384
+
+struct FontSampleCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ttfHash;
+    uint64_t charsetHash;
+    int32_t index;
+    int32_t fontSize;
+    float ascent;
+    float lineHeight;
+    uint32_t pageCount;
+    uint32_t codepointCount;
+    uint32_t kerningPairCount;
+};
+
+struct PageRecord {
+    int32_t width;
+    int32_t height;
+};
+
+struct CodepointRecord {
+    int32_t codepoint;
+    CodepointMetrics metrics;
+};
+
+struct KerningPairRecord {
+    uint32_t key;
+    float value;
+};
+
+struct FontSampleCacheState {
+    std::string directory;
+};
+
+static std::atomic<uint32_t> sTempFileCounter(0);
+
+static std::string GetCacheFilename(const std::string& directory, const FontSampleKey& key) {
+    return Format() << directory << "/" << ToHex(key.ttfHash) << "-" << key.index << "-" << key.fontSize << "-"
+        << ToHex(key.charsetHash) << ".v" << FONT_SAMPLE_CACHE_VERSION << ".fontsample";
+}
+
+inline bool Write(FILE *fp, const void *data, size_t size) {
+    return fwrite(data, 1, size, fp) == size;
+}
+
+const std::string& FontSampleCache::GetDirectory(Napi::Env env) {
+    return InstanceData::Get(env).State<FontSampleCacheState>().directory;
+}
+
+void FontSampleCache::SetDirectory(Napi::Env env, const std::string& directory) {
+    auto& target = InstanceData::Get(env).State<FontSampleCacheState>().directory;
+
+    target = directory;
+
+    // Trailing slashes are trimmed so that the same directory always produces the same cache filenames.
+    while (target.size() > 1 && target.back() == '/') {
+        target.pop_back();
+    }
+}
+
+uint64_t FontSampleCache::HashCharset(const std::vector<int32_t>& charset) {
+    return charset.empty() ? 0 : HashBytes(&charset[0], charset.size() * sizeof(int32_t));
+}
+
+bool FontSampleCache::Load(const std::string& directory, const FontSampleKey& key, FontSampleData& target) {
+    std::shared_ptr<MappedFile> file;
+
+    try {
+        file = MappedFile::Open(GetCacheFilename(directory, key));
+    } catch (std::exception& e) {
+        return false;
+    }
+
+    auto data = file->GetData();
+    auto size = file->GetSize();
+    FontSampleCacheHeader header;
+
+    if (size < sizeof(header)) {
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != FONT_SAMPLE_CACHE_MAGIC
+            || header.version != FONT_SAMPLE_CACHE_VERSION
+            || header.ttfHash != key.ttfHash
+            || header.charsetHash != key.charsetHash
+            || header.index != key.index
+            || header.fontSize != key.fontSize
+            || header.pageCount == 0) {
+        return false;
+    }
+
+    // Offsets are computed in 64 bits so that garbage counts cannot overflow on 32 bit systems.
+    uint64_t pagesOffset = sizeof(header);
+    uint64_t codepointsOffset = pagesOffset + uint64_t(header.pageCount) * sizeof(PageRecord);
+    uint64_t kerningPairsOffset = codepointsOffset + uint64_t(header.codepointCount) * sizeof(CodepointRecord);
+    uint64_t pixelsOffset = kerningPairsOffset + uint64_t(header.kerningPairCount) * sizeof(KerningPairRecord);
+
+    if (size < pixelsOffset) {
+        return false;
+    }
+
+    std::vector<PageRecord> pages(header.pageCount);
+    uint64_t pixelsSize = 0;
+
+    memcpy(&pages[0], data + pagesOffset, header.pageCount * sizeof(PageRecord));
+
+    for (auto& page : pages) {
+        if (page.width <= 0 || page.width > FONT_SAMPLE_CACHE_MAX_PAGE_SIZE
+                || page.height <= 0 || page.height > FONT_SAMPLE_CACHE_MAX_PAGE_SIZE) {
+            return false;
+        }
+
+        pixelsSize += uint64_t(page.width) * uint64_t(page.height);
+    }
+
+    // A truncated or padded file is not trusted.
+    if (size != pixelsOffset + pixelsSize) {
+        return false;
+    }
+
+    CodepointRecord codepoint;
+
+    target.codepointMetrics.clear();
+
+    for (uint32_t i = 0; i < header.codepointCount; i++) {
+        memcpy(&codepoint, data + codepointsOffset + i * sizeof(CodepointRecord), sizeof(CodepointRecord));
+        target.codepointMetrics[codepoint.codepoint] = codepoint.metrics;
+    }
+
+    KerningPairRecord kerningPair;
+
+    target.kerningPairs.clear();
+
+    for (uint32_t i = 0; i < header.kerningPairCount; i++) {
+        memcpy(&kerningPair, data + kerningPairsOffset + i * sizeof(KerningPairRecord), sizeof(KerningPairRecord));
+        target.kerningPairs[kerningPair.key] = kerningPair.value;
+    }
+
+    target.ascent = header.ascent;
+    target.lineHeight = header.lineHeight;
+    target.pages.clear();
+
+    // Page pixels point directly into the mapping, which stays alive as long as the sample references it.
+    for (auto& page : pages) {
+        target.pages.push_back({ page.width, page.height, std::shared_ptr<const uint8_t>(file, data + pixelsOffset) });
+        pixelsOffset += page.width * page.height;
+    }
+
+    return true;
+}
+
+bool FontSampleCache::Store(const std::string& directory, const FontSampleKey& key, const FontSampleData& source) {
+    if (source.pages.empty()) {
+        return false;
+    }
+
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        return false;
+    }
+
+    auto filename = GetCacheFilename(directory, key);
+    std::string tempFilename = Format() << filename << "." << getpid() << "." << sTempFileCounter++ << ".tmp";
+    auto fp = fopen(tempFilename.c_str(), "wb");
+
+    if (!fp) {
+        return false;
+    }
+
+    FontSampleCacheHeader header = {
+        FONT_SAMPLE_CACHE_MAGIC,
+        FONT_SAMPLE_CACHE_VERSION,
+        key.ttfHash,
+        key.charsetHash,
+        key.index,
+        key.fontSize,
+        source.ascent,
+        source.lineHeight,
+        static_cast<uint32_t>(source.pages.size()),
+        static_cast<uint32_t>(source.codepointMetrics.size()),
+        static_cast<uint32_t>(source.kerningPairs.size()),
+    };
+
+    auto ok = Write(fp, &header, sizeof(header));
+
+    for (auto& page : source.pages) {
+        PageRecord record = { page.width, page.height };
+
+        ok = ok && Write(fp, &record, sizeof(record));
+    }
+
+    for (auto& p : source.codepointMetrics) {
+        CodepointRecord record = { p.first, p.second };
+
+        ok = ok && Write(fp, &record, sizeof(record));
+    }
+
+    for (auto& p : source.kerningPairs) {
+        KerningPairRecord record = { p.first, p.second };
+
+        ok = ok && Write(fp, &record, sizeof(record));
+    }
+
+    for (auto& page : source.pages) {
+        ok = ok && Write(fp, page.pixels.get(), page.width * page.height);
+    }
+
+    ok = (fclose(fp) == 0) && ok;
+
+    // rename() atomically replaces any existing (stale or corrupt) file. Existing mappings of the old file, in this
+    // or another process, remain valid.
+    if (!ok || rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "FontSample.h" // FontSampleData
+
+// Identifies a rendered font sample. If any field changes (font file path, size or modification time, face, font
+// size or charset), the sample is rendered again.
+struct FontSampleKey {
+    uint64_t ttfHash;
+    int32_t index;
+    int32_t fontSize;
+    uint64_t charsetHash;
+};
+
+/**
+ * On-disk cache of rendered font samples (glyph atlas, codepoint metrics, kerning pairs and vertical metrics).
+ *
+ * Cache files are loaded with mmap, so the atlas pixels of a cached sample are paged in straight from the file.
+ * Files are written to a temporary name and renamed into place, so a reader never sees a partially written file.
+ * On load, the header (magic, format version, key) and the file size are validated. Any mismatch is treated as a
+ * cache miss and the file is overwritten by the next store.
+ */
+namespace FontSampleCache {
+
+// Get the cache directory of an environment. An empty string means the cache is disabled.
+const std::string& GetDirectory(Napi::Env env);
+// Set the cache directory of an environment. Must be called from the environment's thread.
+void SetDirectory(Napi::Env env, const std::string& directory);
+
+uint64_t HashCharset(const std::vector<int32_t>& charset);
+
+bool Load(const std::string& directory, const FontSampleKey& key, FontSampleData& target);
+bool Store(const std::string& directory, const FontSampleKey& key, const FontSampleData& source);
+
+}
@@ -6,18 +6,23 @@
 
 #include "Global.h"
 #include "TextureFormat.h"
-#include "LoadImageAsyncWorker.h"
+#include "ImageDecoder.h"
+#include "ImageCache.h"
+#include "ImageStream.h"
+#include "PixelPool.h"
+#include "MappedFile.h"
 #include "LoadStbFontAsyncWorker.h"
+#include "FontSampleCache.h"
 
 using namespace Napi;
 
-void LoadImage(const CallbackInfo& info) {
+Value LoadImage(const CallbackInfo& info) {
     HandleScope scope(info.Env());
 
     auto source = info[0];
 
-    if (!source.IsBuffer() && !source.IsString()) {
-        throw Error::New(info.Env(), "source parameter must a String or Buffer");
+    if (!source.IsBuffer() && !source.IsString() && !ImageStream::IsInstance(source)) {
+        throw Error::New(info.Env(), "source parameter must a String, Buffer or ImageStream");
     }
 
     auto options = info[1].As<Object>();
@@ -34,30 +39,141 @@ void LoadImage(const CallbackInfo& info) {
     value = options.Get("format");
     auto format = value.IsNumber() ? Cast(value.As<Number>().Int32Value()): TEXTURE_FORMAT_RGBA;
 
+    value = options.Get("premultipliedAlpha");
+    auto premultipliedAlpha = value.ToBoolean();
+
+    value = options.Get("dither");
+    auto dither = value.ToBoolean();
+
+    value = options.Get("mipmaps");
+    auto mipmaps = value.ToBoolean();
+
     value = options.Get("type");
     auto sourceType = value.IsString() ? value.As<String>().Utf8Value() : std::string();
 
     value = options.Get("basename");
     auto basename = value.ToBoolean();
 
-    auto worker = new LoadImageAsyncWorker(
-        callback,
+    value = options.Get("priority");
+    auto priority = value.IsNumber() ? value.As<Number>().Int32Value() : IMAGE_DECODE_PRIORITY_VISIBLE;
+
+    auto requestId = ImageDecoder::Get(info.Env()).Submit(
+        info.Env(),
         source,
         sourceType,
         width,
         height,
         format,
-        basename);
+        premultipliedAlpha,
+        dither,
+        mipmaps,
+        basename,
+        priority,
+        callback);
+
+    return Number::New(info.Env(), requestId);
+}
 
-    worker->Queue();
+Value CancelImage(const CallbackInfo& info) {
+    auto cancelled = info[0].IsNumber()
+        && ImageDecoder::Get(info.Env()).Cancel(info[0].As<Number>().Uint32Value());
+
+    return Boolean::New(info.Env(), cancelled);
+}
+
+Value SetImagePriority(const CallbackInfo& info) {
+    if (!info[1].IsNumber()) {
+        throw Error::New(info.Env(), "priority parameter must be a Number");
+    }
+
+    auto requestId = info[0].IsNumber() ? info[0].As<Number>().Uint32Value() : 0;
+    auto updated = ImageDecoder::Get(info.Env()).SetPriority(requestId, info[1].As<Number>().Int32Value());
+
+    return Boolean::New(info.Env(), updated);
+}
+
+void SetImageConcurrency(const CallbackInfo& info) {
+    if (!info[0].IsNumber() || info[0].As<Number>().Int32Value() < 0) {
+        throw Error::New(info.Env(), "concurrency parameter must be a Number >= 0");
+    }
+
+    ImageDecoder::Get(info.Env()).SetConcurrency(info[0].As<Number>().Int32Value());
 }
 
 void ReleaseImage(const CallbackInfo& info) {
     if (info[0].IsBuffer()) {
-        free(info[0].As<Buffer<unsigned char>>().Data());
+        ImageDecoder::Get(info.Env()).ReleaseBuffer(info[0].As<Buffer<unsigned char>>().Data());
+    }
+}
+
+void SetImageCacheDirectory(const CallbackInfo& info) {
+    if (info[0].IsString()) {
+        ImageCache::SetDirectory(info.Env(), info[0].As<String>().Utf8Value());
+    } else if (info[0].IsNull() || info[0].IsUndefined()) {
+        ImageCache::SetDirectory(info.Env(), "");
+    } else {
+        throw Error::New(info.Env(), "directory parameter must be a String or null");
+    }
+
+    if (info[1].IsNumber()) {
+        auto sizeLimit = info[1].As<Number>().DoubleValue();
+
+        if (sizeLimit < 0) {
+            throw Error::New(info.Env(), "sizeLimit parameter must be a Number >= 0");
+        }
+
+        ImageCache::SetSizeLimit(info.Env(), static_cast<uint64_t>(sizeLimit));
+    } else if (!info[1].IsUndefined()) {
+        throw Error::New(info.Env(), "sizeLimit parameter must be a Number");
     }
 }
 
+Value GetImageCacheDirectory(const CallbackInfo& info) {
+    auto& directory = ImageCache::GetDirectory(info.Env());
+
+    return directory.empty() ? info.Env().Null() : String::New(info.Env(), directory);
+}
+
+Value GetImageMemoryStats(const CallbackInfo& info) {
+    auto env = info.Env();
+    auto stats = GetPixelPoolStats();
+    auto result = Object::New(env);
+
+    result["usedBlocks"] = Number::New(env, stats.usedBlocks);
+    result["usedBytes"] = Number::New(env, stats.usedBytes);
+    result["peakUsedBytes"] = Number::New(env, stats.peakUsedBytes);
+    result["cachedBlocks"] = Number::New(env, stats.cachedBlocks);
+    result["cachedBytes"] = Number::New(env, stats.cachedBytes);
+    result["hits"] = Number::New(env, stats.hits);
+    result["misses"] = Number::New(env, stats.misses);
+
+    return result;
+}
+
+void SetImageMemoryCacheSize(const CallbackInfo& info) {
+    if (!info[0].IsNumber() || info[0].As<Number>().DoubleValue() < 0) {
+        throw Error::New(info.Env(), "limit parameter must be a Number >= 0");
+    }
+
+    SetPixelPoolCacheLimit(static_cast<size_t>(info[0].As<Number>().DoubleValue()));
+}
+
+void TrimImageMemory(const CallbackInfo& info) {
+    TrimPixelPool();
+}
+
+Value GetMappedFileStats(const CallbackInfo& info) {
+    auto env = info.Env();
+    auto stats = MappedFile::GetSharedStats();
+    auto result = Object::New(env);
+
+    result["sharedMappings"] = Number::New(env, stats.sharedMappings);
+    result["sharedHits"] = Number::New(env, stats.sharedHits);
+    result["sharedMisses"] = Number::New(env, stats.sharedMisses);
+
+    return result;
+}
+
 Value LoadFont(const CallbackInfo& info) {
     auto filename = info[0].As<String>().Utf8Value();
     auto worker = new LoadStbFontAsyncWorker(info.Env(), filename);
@@ -67,10 +183,37 @@ Value LoadFont(const CallbackInfo& info) {
     return worker->Promise();
 }
 
+void SetFontCacheDirectory(const CallbackInfo& info) {
+    if (info[0].IsString()) {
+        FontSampleCache::SetDirectory(info.Env(), info[0].As<String>().Utf8Value());
+    } else if (info[0].IsNull() || info[0].IsUndefined()) {
+        FontSampleCache::SetDirectory(info.Env(), "");
+    } else {
+        throw Error::New(info.Env(), "directory parameter must be a String or null");
+    }
+}
+
+Value GetFontCacheDirectory(const CallbackInfo& info) {
+    auto& directory = FontSampleCache::GetDirectory(info.Env());
+
+    return directory.empty() ? info.Env().Null() : String::New(info.Env(), directory);
+}
+
 Object Global::Init(Env env, Object exports) {
     exports["loadImage"] = Function::New(env, LoadImage, "loadImage");
+    exports["cancelImage"] = Function::New(env, CancelImage, "cancelImage");
+    exports["setImagePriority"] = Function::New(env, SetImagePriority, "setImagePriority");
+    exports["setImageConcurrency"] = Function::New(env, SetImageConcurrency, "setImageConcurrency");
     exports["releaseImage"] = Function::New(env, ReleaseImage, "releaseImage");
     exports["loadFont"] = Function::New(env, LoadFont, "loadFont");
+    exports["setFontCacheDirectory"] = Function::New(env, SetFontCacheDirectory, "setFontCacheDirectory");
+    exports["getFontCacheDirectory"] = Function::New(env, GetFontCacheDirectory, "getFontCacheDirectory");
+    exports["setImageCacheDirectory"] = Function::New(env, SetImageCacheDirectory, "setImageCacheDirectory");
+    exports["getImageCacheDirectory"] = Function::New(env, GetImageCacheDirectory, "getImageCacheDirectory");
+    exports["getPixelPoolStats"] = Function::New(env, GetImageMemoryStats, "getPixelPoolStats");
+    exports["setPixelPoolCacheLimit"] = Function::New(env, SetImageMemoryCacheSize, "setPixelPoolCacheLimit");
+    exports["trimPixelPool"] = Function::New(env, TrimImageMemory, "trimPixelPool");
+    exports["getMappedFileStats"] = Function::New(env, GetMappedFileStats, "getMappedFileStats");
 
     return exports;
 }
@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "ImageCache.h"
+#include "MappedFile.h"
+#include "InstanceData.h"
+#include "Format.h"
+#include "Util.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+// "SSIC" when read as a little endian uint32. A cache file written on a machine with different endianness fails the
+// magic check and is treated as a miss.
+#define IMAGE_CACHE_MAGIC 0x43495353
+// Increment when the file layout or the decoding of an image changes.
+#define IMAGE_CACHE_VERSION 2
+#define IMAGE_CACHE_EXTENSION ".pixels"
+#define IMAGE_CACHE_TEMP_EXTENSION ".tmp"
+// A temporary file older than this was left behind by a store that did not finish (a crash or a full disk).
+#define IMAGE_CACHE_STALE_TEMP_FILE_S 3600
+#define IMAGE_CACHE_MAX_IMAGE_SIZE 16384
+// A hit refreshes the file's last use time at most this often, to limit writes to the storage device.
+#define IMAGE_CACHE_TOUCH_INTERVAL_S 3600
+// ImageCacheHeader flags.
+#define IMAGE_CACHE_FLAG_PREMULTIPLIED_ALPHA 1
+#define IMAGE_CACHE_FLAG_DITHER 2
+#define IMAGE_CACHE_FLAG_MIPMAPS 4
+
+struct ImageCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t contentHash;
+    int32_t desiredWidth;
+    int32_t desiredHeight;
+    int32_t format;
+    int32_t width;
+    int32_t height;
+    uint32_t flags;
+};
+
+inline uint32_t GetFlags(const ImageCacheKey& key) {
+    return (key.premultipliedAlpha ? IMAGE_CACHE_FLAG_PREMULTIPLIED_ALPHA : 0)
+        | (key.dither ? IMAGE_CACHE_FLAG_DITHER : 0)
+        | (key.mipmaps ? IMAGE_CACHE_FLAG_MIPMAPS : 0);
+}
+
+inline uint64_t GetPixelsSize(const ImageCacheKey& key, int width, int height) {
+    // Cached images are at most IMAGE_CACHE_MAX_IMAGE_SIZE square, so the mip chain size fits in an int.
+    return GetMipChainSize(width, height, key.mipmaps ? GetMipLevelCount(width, height) : 1,
+        GetBytesPerPixel(static_cast<TextureFormat>(key.format)));
+}
+
+struct ImageCacheState {
+    std::string directory;
+    uint64_t sizeLimit = IMAGE_CACHE_DEFAULT_SIZE_LIMIT;
+};
+
+struct CacheFile {
+    std::string filename;
+    uint64_t size;
+    time_t modified;
+};
+
+static std::atomic<uint32_t> sTempFileCounter(0);
+// Bytes of cache files in each directory, as of the last trim plus the stores since. Shared by all environments,
+// as they can use the same directory.
+static std::mutex sDirectorySizeMutex;
+static std::map<std::string, uint64_t> sDirectorySize;
+
+static std::string GetCacheFilename(const std::string& directory, const ImageCacheKey& key) {
+    return Format() << directory << "/" << ToHex(key.contentHash) << "-" << key.desiredWidth << "x"
+        << key.desiredHeight << "-" << key.format << (key.premultipliedAlpha ? "p" : "") << (key.dither ? "d" : "")
+        << (key.mipmaps ? "m" : "") << ".v" << IMAGE_CACHE_VERSION << IMAGE_CACHE_EXTENSION;
+}
+
+// Scan the cache files of a directory, delete the least recently used until at most size bytes remain, and return
+// the remaining bytes. The file named keep, which was just written, is never deleted. Stale temporary files are
+// deleted. Temporary files of stores in progress count towards the size, but are left alone.
+static uint64_t TrimDirectory(const std::string& directory, uint64_t size, const std::string& keep) {
+    std::vector<CacheFile> files;
+    uint64_t total = 0;
+    auto staleTime = time(nullptr) - IMAGE_CACHE_STALE_TEMP_FILE_S;
+    auto dir = opendir(directory.c_str());
+
+    if (!dir) {
+        return 0;
+    }
+
+    struct dirent *ent;
+    struct stat info;
+
+    while ((ent = readdir(dir)) != nullptr) {
+        std::string name(ent->d_name);
+        auto isTemp = EndsWith(name, IMAGE_CACHE_TEMP_EXTENSION);
+
+        if (!isTemp && !EndsWith(name, IMAGE_CACHE_EXTENSION)) {
+            continue;
+        }
+
+        auto filename = directory + "/" + name;
+
+        if (stat(filename.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+            continue;
+        }
+
+        if (!isTemp) {
+            files.push_back({ filename, static_cast<uint64_t>(info.st_size), info.st_mtime });
+        } else if (info.st_mtime < staleTime && remove(filename.c_str()) == 0) {
+            continue;
+        }
+
+        total += info.st_size;
+    }
+
+    closedir(dir);
+
+    if (total <= size) {
+        return total;
+    }
+
+    std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) {
+        return a.modified < b.modified;
+    });
+
+    for (auto& file : files) {
+        if (total <= size) {
+            break;
+        }
+
+        if (file.filename == keep) {
+            continue;
+        }
+
+        // Open mappings of a deleted file remain valid.
+        if (remove(file.filename.c_str()) == 0) {
+            total -= file.size;
+        }
+    }
+
+    return total;
+}
+
+const std::string& ImageCache::GetDirectory(Napi::Env env) {
+    return InstanceData::Get(env).State<ImageCacheState>().directory;
+}
+
+void ImageCache::SetDirectory(Napi::Env env, const std::string& directory) {
+    auto& target = InstanceData::Get(env).State<ImageCacheState>().directory;
+
+    target = directory;
+
+    // Trailing slashes are trimmed so that the same directory always produces the same cache filenames.
+    while (target.size() > 1 && target.back() == '/') {
+        target.pop_back();
+    }
+}
+
+uint64_t ImageCache::GetSizeLimit(Napi::Env env) {
+    return InstanceData::Get(env).State<ImageCacheState>().sizeLimit;
+}
+
+void ImageCache::SetSizeLimit(Napi::Env env, uint64_t sizeLimit) {
+    InstanceData::Get(env).State<ImageCacheState>().sizeLimit = sizeLimit;
+}
+
+bool ImageCache::Load(const std::string& directory, const ImageCacheKey& key, std::shared_ptr<const uint8_t>& pixels,
+        int& width, int& height) {
+    auto filename = GetCacheFilename(directory, key);
+    std::shared_ptr<MappedFile> file;
+
+    try {
+        file = MappedFile::Open(filename);
+    } catch (std::exception& e) {
+        return false;
+    }
+
+    auto data = file->GetData();
+    auto size = file->GetSize();
+    ImageCacheHeader header;
+
+    if (size < sizeof(header)) {
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != IMAGE_CACHE_MAGIC
+            || header.version != IMAGE_CACHE_VERSION
+            || header.contentHash != key.contentHash
+            || header.desiredWidth != key.desiredWidth
+            || header.desiredHeight != key.desiredHeight
+            || header.format != key.format
+            || header.flags != GetFlags(key)
+            || header.width <= 0 || header.width > IMAGE_CACHE_MAX_IMAGE_SIZE
+            || header.height <= 0 || header.height > IMAGE_CACHE_MAX_IMAGE_SIZE) {
+        return false;
+    }
+
+    // A truncated or padded file is not trusted.
+    if (size != sizeof(header) + GetPixelsSize(key, header.width, header.height)) {
+        return false;
+    }
+
+    struct stat info;
+
+    if (stat(filename.c_str(), &info) == 0 && time(nullptr) - info.st_mtime > IMAGE_CACHE_TOUCH_INTERVAL_S) {
+        utimes(filename.c_str(), nullptr);
+    }
+
+    width = header.width;
+    height = header.height;
+    pixels = std::shared_ptr<const uint8_t>(file, data + sizeof(header));
+
+    return true;
+}
+
+bool ImageCache::Store(const std::string& directory, uint64_t sizeLimit, const ImageCacheKey& key,
+        const uint8_t *pixels, int width, int height) {
+    if (pixels == nullptr || width <= 0 || width > IMAGE_CACHE_MAX_IMAGE_SIZE || height <= 0
+            || height > IMAGE_CACHE_MAX_IMAGE_SIZE) {
+        return false;
+    }
+
+    uint64_t pixelsSize = GetPixelsSize(key, width, height);
+    uint64_t fileSize = sizeof(ImageCacheHeader) + pixelsSize;
+
+    // An image bigger than the whole cache would only evict everything else.
+    if (fileSize > sizeLimit) {
+        return false;
+    }
+
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        return false;
+    }
+
+    auto filename = GetCacheFilename(directory, key);
+    std::string tempFilename = Format() << filename << "." << getpid() << "." << sTempFileCounter++
+        << IMAGE_CACHE_TEMP_EXTENSION;
+    auto fp = fopen(tempFilename.c_str(), "wb");
+
+    if (!fp) {
+        return false;
+    }
+
+    ImageCacheHeader header = {
+        IMAGE_CACHE_MAGIC,
+        IMAGE_CACHE_VERSION,
+        key.contentHash,
+        key.desiredWidth,
+        key.desiredHeight,
+        key.format,
+        width,
+        height,
+        GetFlags(key),
+    };
+
+    auto ok = fwrite(&header, 1, sizeof(header), fp) == sizeof(header)
+        && fwrite(pixels, 1, pixelsSize, fp) == pixelsSize;
+
+    ok = (fclose(fp) == 0) && ok;
+
+    // rename() atomically replaces any existing (stale or corrupt) file. Existing mappings of the old file, in this
+    // or another process, remain valid.
+    if (!ok || rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(sDirectorySizeMutex);
+    auto p = sDirectorySize.find(directory);
+
+    if (p == sDirectorySize.end()) {
+        // First store to this directory: count what previous runs left behind.
+        sDirectorySize[directory] = TrimDirectory(directory, sizeLimit, filename);
+    } else if ((p->second += fileSize) > sizeLimit) {
+        // Trim below the limit, so the directory is not rescanned on every store.
+        p->second = TrimDirectory(directory, sizeLimit - sizeLimit / 4, filename);
+    }
+
+    return true;
+}
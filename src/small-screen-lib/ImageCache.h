@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#define IMAGE_CACHE_DEFAULT_SIZE_LIMIT (128ULL * 1024 * 1024)
+
+// Identifies decoded pixels. If any field changes (source contents, requested size, texture format, alpha mode,
+// dithering or mip levels), the image is decoded again.
+struct ImageCacheKey {
+    uint64_t contentHash;
+    int32_t desiredWidth;
+    int32_t desiredHeight;
+    int32_t format;
+    bool premultipliedAlpha;
+    bool dither;
+    bool mipmaps;
+};
+
+/**
+ * On-disk cache of decoded images, stored resized and converted to the texture format, ready for upload.
+ *
+ * Cache files are loaded with mmap, and the pixels are handed out in place, without a copy. Files are written to a
+ * temporary name and renamed into place, so a reader never sees a partially written file. On load, the header and
+ * the file size are validated. Any mismatch is treated as a cache miss.
+ *
+ * The modification time of a file records its last use. When a store takes the directory over its size limit, the
+ * least recently used files are deleted. Temporary files left behind by an interrupted store are deleted once they are
+ * an hour old.
+ */
+namespace ImageCache {
+
+// Get the cache directory of an environment. An empty string means the cache is disabled.
+const std::string& GetDirectory(Napi::Env env);
+// Set the cache directory of an environment. Must be called from the environment's thread.
+void SetDirectory(Napi::Env env, const std::string& directory);
+
+// Get the maximum number of bytes of cache files kept in the directory.
+uint64_t GetSizeLimit(Napi::Env env);
+void SetSizeLimit(Napi::Env env, uint64_t sizeLimit);
+
+// Load cached pixels. The pixels point into a read-only file mapping, which is kept alive by the pointer.
+bool Load(const std::string& directory, const ImageCacheKey& key, std::shared_ptr<const uint8_t>& pixels,
+    int& width, int& height);
+bool Store(const std::string& directory, uint64_t sizeLimit, const ImageCacheKey& key, const uint8_t *pixels,
+    int width, int height);
+
+}
@@ -0,0 +1,427 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "ImageDecodeTask.h"
+#include <vector>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <nanosvg.h>
+#include <nanosvgrast.h>
+#include <stb_image.h>
+#include "Util.h"
+#include "ImageResample.h"
+#include "PixelPool.h"
+#include "ImageCache.h"
+#include "MappedFile.h"
+#include "SvgCache.h"
+#include "DirectoryIndex.h"
+#include "ImageStream.h"
+#include "Format.h"
+#include <sys/stat.h>
+
+#define NUM_IMAGE_COMPONENTS 4
+
+inline float ScaleFactor(const int source, const int dest) {
+    return 1.f + ((dest - source) / (float)source);
+}
+
+static int ReadStream(void *user, char *data, int size) {
+    return static_cast<int>(static_cast<ImageStreamBuffer *>(user)->Read(reinterpret_cast<uint8_t *>(data), size));
+}
+
+static void SkipStream(void *user, int n) {
+    static_cast<ImageStreamBuffer *>(user)->Skip(n);
+}
+
+static int IsStreamEnd(void *user) {
+    return static_cast<ImageStreamBuffer *>(user)->IsEnd();
+}
+
+static const stbi_io_callbacks STREAM_CALLBACKS = { ReadStream, SkipStream, IsStreamEnd };
+
+ImageDecodeTask::ImageDecodeTask(
+            const std::string& source,
+            unsigned char *sourceData,
+            int sourceDataSize,
+            const std::shared_ptr<ImageStreamBuffer>& stream,
+            const std::string &sourceType,
+            int desiredWidth,
+            int desiredHeight,
+            TextureFormat desiredFormat,
+            bool premultipliedAlpha,
+            bool dither,
+            bool mipmaps,
+            bool basename,
+            const std::string& cacheDirectory,
+            uint64_t cacheSizeLimit)
+     : data(nullptr),
+       dataSize(0),
+       source(source),
+       sourceData(sourceData),
+       sourceDataSize(sourceDataSize),
+       stream(stream),
+       sourceType(sourceType),
+       width(0),
+       height(0),
+       desiredWidth(desiredWidth),
+       desiredHeight(desiredHeight),
+       desiredFormat(desiredFormat),
+       premultipliedAlpha(premultipliedAlpha),
+       dither(dither),
+       mipmaps(mipmaps),
+       levelCount(1),
+       basename(basename),
+       isFormatted(false),
+       cacheDirectory(cacheDirectory),
+       cacheSizeLimit(cacheSizeLimit) {
+}
+
+ImageDecodeTask::~ImageDecodeTask() {
+    PixelPoolFree(this->data);
+}
+
+void ImageDecodeTask::Execute() {
+    try {
+        if (this->sourceType != "utf8" && this->sourceData == nullptr && !this->stream && this->basename) {
+            auto path = DirectoryIndex::FindByPrefix(GetDirectory(this->source), GetBasename(this->source));
+
+            if (!path.empty()) {
+                this->source = path;
+            }
+        }
+
+        if (this->cacheDirectory.empty() || this->stream) {
+            this->Decode();
+        } else {
+            this->DecodeCached();
+        }
+    } catch (std::exception& e) {
+        this->error = e.what();
+    } catch (...) {
+        this->error = "Unknown image decode exception.";
+    }
+
+    if (!this->error.empty()) {
+        PixelPoolFree(this->data);
+        this->data = nullptr;
+        this->sharedPixels.reset();
+        this->dataSize = 0;
+    }
+}
+
+std::shared_ptr<const uint8_t> ImageDecodeTask::TakePixels() {
+    if (this->data) {
+        std::shared_ptr<const uint8_t> pixels(this->data, PixelPoolFree);
+
+        this->data = nullptr;
+
+        return pixels;
+    }
+
+    return std::move(this->sharedPixels);
+}
+
+void ImageDecodeTask::Decode() {
+    if (this->sourceType == "utf8") {
+        // note: nanosvg modifies the char buffer during parsing.
+        this->LoadSvgImage(const_cast<char *>(this->source.c_str()), this->source.size());
+    } else {
+        try {
+            this->LoadRasterImage(this->sourceData, this->sourceDataSize);
+        } catch (std::exception e) {
+            if (this->stream) {
+                std::string text;
+
+                if (!this->stream->ReadAll(text)) {
+                    throw std::runtime_error("Image stream aborted.");
+                }
+
+                this->LoadSvgImage(&text[0], text.size());
+            } else if (this->sourceData) {
+                // nanosvg needs a null terminated string, which it modifies during parsing.
+                std::string text(reinterpret_cast<char *>(this->sourceData), this->sourceDataSize);
+
+                this->LoadSvgImage(&text[0], text.size());
+            } else {
+                this->LoadSvgImage(nullptr, 0);
+            }
+        }
+    }
+
+    if (!this->isFormatted) {
+        this->FormatPixels();
+    }
+}
+
+void ImageDecodeTask::FormatPixels() {
+    auto size = this->width * this->height * NUM_IMAGE_COMPONENTS;
+
+    if (this->premultipliedAlpha) {
+        PremultiplyAlpha(this->data, size);
+    }
+
+    // Packed formats are converted after the mip levels are built, so the levels are filtered at full precision.
+    if (!IsPackedFormat(this->desiredFormat)) {
+        ConvertToFormat(this->data, size, this->desiredFormat);
+    }
+
+    this->BuildLevels();
+}
+
+void ImageDecodeTask::BuildLevels() {
+    auto levelCount = this->mipmaps ? GetMipLevelCount(this->width, this->height) : 1;
+
+    if (levelCount > 1) {
+        auto chain = PixelPoolRealloc(this->data,
+            GetMipChainSize(this->width, this->height, levelCount, NUM_IMAGE_COMPONENTS));
+
+        if (chain == nullptr) {
+            throw std::runtime_error("Failed to allocate mip levels.");
+        }
+
+        this->data = static_cast<unsigned char *>(chain);
+        BuildMipChain(this->data, this->width, this->height, levelCount);
+    }
+
+    if (IsPackedFormat(this->desiredFormat)) {
+        auto source = this->data;
+        auto target = this->data;
+
+        // Each level is packed in place, then moved down to follow the previous packed level.
+        for (int i = 0; i < levelCount; i++) {
+            auto levelWidth = this->width >> i;
+            auto levelHeight = this->height >> i;
+            auto size = PackPixels(source, levelWidth, levelHeight, this->desiredFormat, this->dither);
+
+            memmove(target, source, size);
+            source += levelWidth * levelHeight * NUM_IMAGE_COMPONENTS;
+            target += size;
+        }
+    }
+
+    this->SetFormattedSize();
+    this->isFormatted = true;
+}
+
+void ImageDecodeTask::SetFormattedSize() {
+    this->levelCount = this->mipmaps ? GetMipLevelCount(this->width, this->height) : 1;
+    this->dataSize = GetMipChainSize(this->width, this->height, this->levelCount,
+        GetBytesPerPixel(this->desiredFormat));
+}
+
+void ImageDecodeTask::DecodeCached() {
+    std::shared_ptr<MappedFile> file;
+    uint64_t contentHash;
+
+    if (this->sourceType == "utf8") {
+        contentHash = HashBytes(this->source.c_str(), this->source.size());
+    } else {
+        if (this->sourceData == nullptr) {
+            // The file is hashed and, on a miss, decoded from the same mapping, so it is only read once.
+            file = MappedFile::Open(this->source);
+            this->sourceData = const_cast<unsigned char *>(file->GetData());
+            this->sourceDataSize = file->GetSize();
+        }
+
+        contentHash = HashBytes(this->sourceData, this->sourceDataSize);
+    }
+
+    ImageCacheKey key = {
+        contentHash,
+        this->desiredWidth,
+        this->desiredHeight,
+        this->desiredFormat,
+        this->premultipliedAlpha,
+        this->dither,
+        this->mipmaps,
+    };
+
+    if (ImageCache::Load(this->cacheDirectory, key, this->sharedPixels, this->width, this->height)) {
+        this->SetFormattedSize();
+    } else {
+        this->Decode();
+
+        // The cache is an optimization. If the image cannot be written, it is decoded again on the next load.
+        ImageCache::Store(this->cacheDirectory, this->cacheSizeLimit, key,
+            this->data ? this->data : this->sharedPixels.get(), this->width, this->height);
+    }
+
+    if (file) {
+        this->sourceData = nullptr;
+        this->sourceDataSize = 0;
+    }
+}
+
+void ImageDecodeTask::LoadRasterImage(unsigned char *chunk, int chunkLen) {
+    int components;
+
+    if (this->stream) {
+        this->data = stbi_load_from_callbacks(
+            &STREAM_CALLBACKS,
+            this->stream.get(),
+            &this->width,
+            &this->height,
+            &components,
+            NUM_IMAGE_COMPONENTS
+        );
+    } else if (chunk != nullptr) {
+        this->data = stbi_load_from_memory(
+            chunk,
+            chunkLen,
+            &this->width,
+            &this->height,
+            &components,
+            NUM_IMAGE_COMPONENTS
+        );
+
+    } else {
+        this->data = stbi_load(
+            this->source.c_str(),
+            &this->width,
+            &this->height,
+            &components,
+            NUM_IMAGE_COMPONENTS
+        );
+    }
+
+    if (this->data == nullptr) {
+        throw std::runtime_error("stbi_load failed.");
+    }
+
+    int targetWidth;
+    int targetHeight;
+
+    // Resize on this thread, rather than keeping a full resolution buffer and texture for a smaller view. The format
+    // conversion is done while writing the resized pixels.
+    if (GetResampleSize(this->width, this->height, this->desiredWidth, this->desiredHeight, targetWidth, targetHeight)) {
+        unsigned char *resized;
+
+        try {
+            resized = ResampleImage(this->data, this->width, this->height, targetWidth, targetHeight,
+                this->desiredFormat, this->premultipliedAlpha);
+        } catch (...) {
+            stbi_image_free(this->data);
+            this->data = nullptr;
+            throw;
+        }
+
+        stbi_image_free(this->data);
+
+        this->data = resized;
+        this->width = targetWidth;
+        this->height = targetHeight;
+        // The resampler leaves packed formats in RGBA.
+        this->BuildLevels();
+    } else {
+        this->dataSize = this->width * this->height * NUM_IMAGE_COMPONENTS;
+    }
+}
+
+void ImageDecodeTask::LoadSvgImage(char *chunk, int chunkLen) {
+    std::string documentKey;
+
+    if (chunk != nullptr) {
+        documentKey = Format() << "data:" << HashBytes(chunk, chunkLen) << ":" << chunkLen;
+    } else {
+        struct stat info;
+
+        if (stat(this->source.c_str(), &info) != 0) {
+            throw std::runtime_error("Failed to parse image.");
+        }
+
+        documentKey = Format() << "file:" << info.st_mtime << ":" << info.st_size << ":" << this->source;
+    }
+
+    auto svg = SvgCache::GetDocument(documentKey);
+
+    if (!svg) {
+        NSVGimage *parsed;
+
+        if (chunk != nullptr) {
+            parsed = nsvgParse(chunk, "px", 96);
+        } else {
+            parsed = nsvgParseFromFile(this->source.c_str(), "px", 96);
+        }
+
+        // XXX: nsvgParse* methods do not check if parsing failed. NSVGImage can be left in a partially filled out
+        // state, resulting in a bad render. Negative width and height are an indication that parsing failed, but that
+        // does not cover all invalid XML use cases.
+
+        if (parsed == nullptr || parsed->width < 0 || parsed->height < 0) {
+            nsvgDelete(parsed);
+            throw std::runtime_error("Failed to parse image.");
+        }
+
+        svg = SvgCache::PutDocument(documentKey, std::shared_ptr<NSVGimage>(parsed, nsvgDelete));
+    }
+
+    if ((svg->width == 0 || svg->height == 0) && (desiredWidth == 0 && desiredHeight == 0)) {
+        throw std::runtime_error("SVG contains no dimensions.");
+    }
+
+    float scaleX;
+    float scaleY;
+
+    if (desiredWidth > 0 && desiredHeight > 0) {
+        this->width = desiredWidth;
+        this->height = desiredHeight;
+        scaleX = ScaleFactor(svg->width, desiredWidth);
+        scaleY = ScaleFactor(svg->height, desiredHeight);
+    } else {
+        this->width = svg->width;
+        this->height = svg->height;
+        scaleX = 1.0f;
+        scaleY = 1.0f;
+    }
+
+    std::string rasterKey = Format() << documentKey << ":" << this->width << "x" << this->height << ":"
+        << this->desiredFormat << (this->premultipliedAlpha ? ":premultiplied" : "") << (this->dither ? ":dither" : "")
+        << (this->mipmaps ? ":mipmaps" : "");
+
+    if (SvgCache::GetRaster(rasterKey, this->sharedPixels, this->width, this->height)) {
+        this->SetFormattedSize();
+        this->isFormatted = true;
+        return;
+    }
+
+    this->data = static_cast<unsigned char *>(PixelPoolAlloc(this->width * this->height * NUM_IMAGE_COMPONENTS));
+
+    if (this->data == nullptr) {
+        throw std::runtime_error("Failed to allocate surface memory for SVG image.");
+    }
+
+    auto rasterizer = nsvgCreateRasterizer();
+
+    if (rasterizer == nullptr) {
+        PixelPoolFree(this->data);
+        this->data = nullptr;
+        throw std::runtime_error("Failed to create rasterizer SVG image.");
+    }
+
+    nsvgRasterizeFull(rasterizer,
+                      svg.get(),
+                      0,
+                      0,
+                      scaleX,
+                      scaleY,
+                      this->data,
+                      this->width,
+                      this->height,
+                      this->width * NUM_IMAGE_COMPONENTS);
+
+    nsvgDeleteRasterizer(rasterizer);
+
+    // The raster is cached in the texture format, and shared with the cache rather than copied.
+    this->FormatPixels();
+    this->sharedPixels = std::shared_ptr<const uint8_t>(this->data, PixelPoolFree);
+    this->data = nullptr;
+
+    SvgCache::PutRaster(rasterKey, this->sharedPixels, this->width, this->height);
+}
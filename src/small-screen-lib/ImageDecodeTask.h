@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include "TextureFormat.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class ImageStreamBuffer;
+
+/**
+ * Decodes an image file, encoded image buffer or SVG string to pixels in a texture format, optionally with
+ * premultiplied alpha.
+ *
+ * With mipmaps, the pixels are followed by a chain of half size levels (see GetMipLevelCount()), for drawing the
+ * image scaled down.
+ *
+ * Execute() does not touch javascript, so the task can run on any thread. The caller keeps sourceData alive until
+ * the task is destroyed.
+ *
+ * With a stream source, the decode reads the image as it is written, and waits for more when it reads ahead of the
+ * writer. A streamed image is not looked up in the image cache, as its contents are not known until it ends.
+ *
+ * If a cache directory is set, decoded pixels are stored in, and loaded from, the image cache (see ImageCache.h).
+ */
+class ImageDecodeTask {
+public:
+    ImageDecodeTask(const std::string& source,
+                    unsigned char *sourceData,
+                    int sourceDataSize,
+                    const std::shared_ptr<ImageStreamBuffer>& stream,
+                    const std::string &sourceType,
+                    int desiredWidth,
+                    int desiredHeight,
+                    TextureFormat desiredFormat,
+                    bool premultipliedAlpha,
+                    bool dither,
+                    bool mipmaps,
+                    bool basename,
+                    const std::string& cacheDirectory,
+                    uint64_t cacheSizeLimit);
+    ~ImageDecodeTask();
+
+    // Decode the image. On failure, the pixels are null and GetError() describes the failure.
+    void Execute();
+
+    bool HasError() const { return !this->error.empty(); }
+    const std::string& GetError() const { return this->error; }
+
+    // Take the decoded pixels. Pixels from a cache may be shared, or point into a read-only file mapping, so they are
+    // not to be modified.
+    std::shared_ptr<const uint8_t> TakePixels();
+    int GetDataSize() const { return this->dataSize; }
+    int GetWidth() const { return this->width; }
+    int GetHeight() const { return this->height; }
+    // Number of mip levels in the pixels, including the full size level.
+    int GetLevelCount() const { return this->levelCount; }
+    // Stream source of the decode, or null.
+    const std::shared_ptr<ImageStreamBuffer>& GetStream() const { return this->stream; }
+
+private:
+    unsigned char *data;
+    int dataSize;
+    std::string source;
+    unsigned char *sourceData;
+    int sourceDataSize;
+    std::shared_ptr<ImageStreamBuffer> stream;
+    std::string sourceType;
+    int width;
+    int height;
+    int desiredWidth;
+    int desiredHeight;
+    TextureFormat desiredFormat;
+    // true to multiply the colors by alpha, after decoding and before format conversion.
+    bool premultipliedAlpha;
+    // true to dither when converting to a 16 bit format.
+    bool dither;
+    // true to append half size levels to the pixels.
+    bool mipmaps;
+    int levelCount;
+    bool basename;
+    // true if the pixels have already been converted to desiredFormat.
+    bool isFormatted;
+    std::string error;
+    // Pixels shared with the image cache or the SVG raster cache, used instead of data.
+    std::shared_ptr<const uint8_t> sharedPixels;
+    std::string cacheDirectory;
+    uint64_t cacheSizeLimit;
+
+    void Decode();
+    void DecodeCached();
+    void LoadRasterImage(unsigned char *chunk, int chunkLen);
+    void LoadSvgImage(char *chunk, int chunkLen);
+    // Premultiply (if requested) and convert the RGBA pixels in data to the desired format. Sets dataSize.
+    void FormatPixels();
+    // Build the mip levels (if requested) of the 4 byte pixels in data, then pack them if the desired format is
+    // packed. The pixels are in the desired format, or RGBA for a packed format. Sets dataSize.
+    void BuildLevels();
+    // Set levelCount and dataSize of formatted pixels of the current width and height.
+    void SetFormattedSize();
+};
@@ -0,0 +1,534 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "ImageDecoder.h"
+#include "ImageCache.h"
+#include "ImageStream.h"
+#include "InstanceData.h"
+#include "Format.h"
+#include <algorithm>
+#include <system_error>
+
+using namespace Napi;
+
+inline std::string GetSourceString(const Value& source) {
+    return source.IsString() ? source.As<String>().Utf8Value() : std::string();
+}
+
+inline unsigned char *GetSourceData(const Value& source) {
+    return source.IsBuffer() ? source.As<Buffer<unsigned char>>().Data() : nullptr;
+}
+
+inline int GetSourceDataSize(const Value& source) {
+    return source.IsBuffer() ? source.As<Buffer<unsigned char>>().Length() : 0;
+}
+
+inline std::shared_ptr<ImageStreamBuffer> GetSourceStream(const Value& source) {
+    return ImageStream::IsInstance(source)
+        ? ObjectWrap<ImageStream>::Unwrap(source.As<Object>())->GetBuffer() : std::shared_ptr<ImageStreamBuffer>();
+}
+
+inline int32_t ClampPriority(int32_t priority) {
+    return std::min(std::max(priority, 0), IMAGE_DECODE_PRIORITY_COUNT - 1);
+}
+
+ImageDecoder::Job::Job(const std::string& key, const Value& source, const std::string& sourceType, int width,
+        int height, TextureFormat format, bool premultipliedAlpha, bool dither, bool mipmaps, bool basename,
+        const std::string& cacheDirectory, uint64_t cacheSizeLimit)
+    : key(key),
+      task(GetSourceString(source), GetSourceData(source), GetSourceDataSize(source), GetSourceStream(source),
+           sourceType, width, height, format, premultipliedAlpha, dither, mipmaps, basename, cacheDirectory,
+           cacheSizeLimit),
+      priority(IMAGE_DECODE_PRIORITY_BACKGROUND),
+      queued(false) {
+    // The decode reads the buffer in place, so keep it alive until the job is done.
+    if (source.IsBuffer()) {
+        this->sourceRef = Persistent(source);
+    }
+}
+
+ImageDecoder::ImageDecoder()
+    : env(nullptr),
+      complete(nullptr),
+      hasCleanupHook(false),
+      nextRequestId(0),
+      threadCount(IMAGE_DECODE_DEFAULT_CONCURRENCY),
+      stopped(false) {
+}
+
+ImageDecoder::~ImageDecoder() {
+    if (this->hasCleanupHook) {
+        napi_remove_env_cleanup_hook(this->env, OnCleanup, this);
+    }
+
+    this->Shutdown();
+}
+
+ImageDecoder& ImageDecoder::Get(Napi::Env env) {
+    return InstanceData::Get(env).State<ImageDecoder>();
+}
+
+uint32_t ImageDecoder::Submit(Napi::Env env, const Value& source, const std::string& sourceType, int width,
+        int height, TextureFormat format, bool premultipliedAlpha, bool dither, bool mipmaps, bool basename,
+        int32_t priority, const Function& callback) {
+    this->Start(env);
+
+    if (GetSourceStream(source)) {
+        this->StartThreads(this->streamThreads, IMAGE_DECODE_STREAM_CONCURRENCY, true);
+    }
+
+    priority = ClampPriority(priority);
+
+    // Buffers and streams are not shared, as comparing their contents would cost more than it saves.
+    std::string key;
+
+    if (source.IsString()) {
+        key = sourceType + "\n" + GetSourceString(source) + "\n" + std::to_string(width) + "x" + std::to_string(height)
+            + "\n" + std::to_string(format) + (premultipliedAlpha ? "\npremultiplied" : "")
+            + (dither ? "\ndither" : "") + (mipmaps ? "\nmipmaps" : "") + (basename ? "\nbasename" : "");
+    }
+
+    Job *job = nullptr;
+
+    if (!key.empty()) {
+        auto p = this->jobsByKey.find(key);
+
+        if (p != this->jobsByKey.end()) {
+            job = p->second;
+        }
+    }
+
+    if (job == nullptr) {
+        job = new Job(key, source, sourceType, width, height, format, premultipliedAlpha, dither, mipmaps, basename,
+            ImageCache::GetDirectory(env), ImageCache::GetSizeLimit(env));
+
+        if (this->jobs.empty()) {
+            napi_ref_threadsafe_function(env, this->complete);
+        }
+
+        this->jobs.insert(job);
+
+        if (!key.empty()) {
+            this->jobsByKey[key] = job;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            this->Enqueue(job, priority);
+        }
+
+        // Decode and stream threads wait on the same condition. Wake them all, so a thread of the right kind runs.
+        this->condition.notify_all();
+    }
+
+    auto requestId = ++this->nextRequestId;
+
+    if (requestId == 0) {
+        requestId = ++this->nextRequestId;
+    }
+
+    job->requests.push_back({ requestId, priority, Persistent(callback) });
+    this->jobsByRequest[requestId] = job;
+    this->UpdatePriority(job);
+
+    return requestId;
+}
+
+bool ImageDecoder::Cancel(uint32_t requestId) {
+    auto p = this->jobsByRequest.find(requestId);
+
+    if (p == this->jobsByRequest.end()) {
+        return false;
+    }
+
+    auto job = p->second;
+    auto& requests = job->requests;
+
+    this->jobsByRequest.erase(p);
+    requests.erase(std::remove_if(requests.begin(), requests.end(),
+        [requestId](const Request& request) { return request.id == requestId; }), requests.end());
+
+    if (!requests.empty()) {
+        this->UpdatePriority(job);
+        return true;
+    }
+
+    bool wasQueued;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        wasQueued = job->queued;
+
+        if (wasQueued) {
+            this->GetQueue(job)[job->priority].erase(job->position);
+            job->queued = false;
+        }
+    }
+
+    // A running decode is left to finish. It stays shared, so a new request for the same image can pick it up.
+    if (wasQueued) {
+        if (!job->key.empty()) {
+            this->jobsByKey.erase(job->key);
+        }
+
+        this->DeleteJob(job);
+    }
+
+    return true;
+}
+
+bool ImageDecoder::SetPriority(uint32_t requestId, int32_t priority) {
+    auto p = this->jobsByRequest.find(requestId);
+
+    if (p == this->jobsByRequest.end()) {
+        return false;
+    }
+
+    auto job = p->second;
+
+    for (auto& request : job->requests) {
+        if (request.id == requestId) {
+            request.priority = ClampPriority(priority);
+        }
+    }
+
+    this->UpdatePriority(job);
+
+    return true;
+}
+
+void ImageDecoder::SetConcurrency(int32_t concurrency) {
+    auto count = concurrency > 0 ? static_cast<size_t>(concurrency) : IMAGE_DECODE_DEFAULT_CONCURRENCY;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        this->threadCount = count;
+    }
+
+    this->condition.notify_all();
+
+    while (this->threads.size() > count) {
+        this->threads.back().join();
+        this->threads.pop_back();
+    }
+
+    if (this->complete) {
+        this->StartThreads(this->threads, count, false);
+    }
+}
+
+void ImageDecoder::ReleaseBuffer(const void *data) {
+    auto p = this->buffers.find(data);
+
+    if (p != this->buffers.end()) {
+        this->buffers.erase(p);
+    }
+}
+
+void ImageDecoder::Start(Napi::Env env) {
+    if (this->complete) {
+        // Retry threads that could not be started before.
+        if (this->threads.size() < this->threadCount) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            this->StartThreads(this->threads, this->threadCount, false);
+        }
+
+        return;
+    }
+
+    napi_threadsafe_function complete;
+
+    auto status = napi_create_threadsafe_function(
+        env,
+        nullptr,
+        nullptr,
+        String::New(env, "ImageDecoder"),
+        0,
+        1,
+        nullptr,
+        nullptr,
+        this,
+        OnComplete,
+        &complete);
+
+    if (status != napi_ok) {
+        throw Error::New(env, "Failed to create image decoder.");
+    }
+
+    // Only outstanding jobs keep the event loop alive.
+    napi_unref_threadsafe_function(env, complete);
+
+    this->env = env;
+    this->complete = complete;
+
+    // Stop the threads before the environment tears down the thread safe function. Cleanup hooks run in reverse
+    // order, so this hook, added after the function was created, runs first.
+    if (napi_add_env_cleanup_hook(env, OnCleanup, this) == napi_ok) {
+        this->hasCleanupHook = true;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    this->StartThreads(this->threads, this->threadCount, false);
+}
+
+void ImageDecoder::StartThreads(std::vector<std::thread>& target, size_t count, bool streams) {
+    // Thread creation throws std::system_error when the process is out of threads or memory. Decode with the threads
+    // that did start. Fail only if there are none, as submitted images would never complete.
+    try {
+        while (target.size() < count) {
+            target.emplace_back(&ImageDecoder::Run, this, target.size(), streams);
+        }
+    } catch (const std::system_error& e) {
+        if (target.empty()) {
+            throw Error::New(Napi::Env(this->env), Format() << "Failed to start image decoder thread: " << e.what());
+        }
+    }
+}
+
+void ImageDecoder::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->stopped) {
+            return;
+        }
+
+        this->stopped = true;
+    }
+
+    this->condition.notify_all();
+    this->AbortRunningStreams();
+
+    for (auto& thread : this->threads) {
+        thread.join();
+    }
+
+    for (auto& thread : this->streamThreads) {
+        thread.join();
+    }
+
+    this->threads.clear();
+    this->streamThreads.clear();
+
+    // The environment is going away and will clean up its own references.
+    for (auto job : this->jobs) {
+        if (!job->sourceRef.IsEmpty()) {
+            job->sourceRef.SuppressDestruct();
+        }
+
+        for (auto& request : job->requests) {
+            request.callback.SuppressDestruct();
+        }
+
+        delete job;
+    }
+
+    this->jobs.clear();
+    this->buffers.clear();
+    this->jobsByKey.clear();
+    this->jobsByRequest.clear();
+
+    for (auto& list : this->queue) {
+        list.clear();
+    }
+
+    for (auto& list : this->streamQueue) {
+        list.clear();
+    }
+
+    if (this->complete) {
+        napi_release_threadsafe_function(this->complete, napi_tsfn_abort);
+        this->complete = nullptr;
+    }
+}
+
+void ImageDecoder::AbortRunningStreams() {
+    std::vector<std::shared_ptr<ImageStreamBuffer>> streams;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        for (auto& stream : this->runningStreams) {
+            if (stream) {
+                streams.push_back(stream);
+            }
+        }
+    }
+
+    // A decode blocked reading the stream sees a truncated image and fails, so its thread can be joined.
+    for (auto& stream : streams) {
+        stream->Abort();
+    }
+}
+
+void ImageDecoder::Run(size_t index, bool streams) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto queue = streams ? this->streamQueue : this->queue;
+
+    if (streams && this->runningStreams.size() <= index) {
+        this->runningStreams.resize(index + 1);
+    }
+
+    while (true) {
+        Job *job = nullptr;
+
+        // Stream threads are not removed by SetConcurrency(). They run until shutdown.
+        this->condition.wait(lock, [this, index, streams, queue, &job]() {
+            return this->stopped || (!streams && index >= this->threadCount) || (job = this->Dequeue(queue)) != nullptr;
+        });
+
+        if (job == nullptr) {
+            break;
+        }
+
+        if (streams) {
+            this->runningStreams[index] = job->task.GetStream();
+        }
+
+        lock.unlock();
+
+        job->task.Execute();
+
+        if (streams) {
+            lock.lock();
+            this->runningStreams[index].reset();
+            lock.unlock();
+        }
+
+        // On failure, the environment is shutting down. The job is still in jobs, where Shutdown() deletes it.
+        napi_call_threadsafe_function(this->complete, job, napi_tsfn_nonblocking);
+
+        lock.lock();
+    }
+}
+
+void ImageDecoder::OnComplete(napi_env env, napi_value callback, void *context, void *data) {
+    if (env == nullptr) {
+        return;
+    }
+
+    static_cast<ImageDecoder *>(context)->Finish(Napi::Env(env), static_cast<Job *>(data));
+}
+
+void ImageDecoder::OnCleanup(void *arg) {
+    auto decoder = static_cast<ImageDecoder *>(arg);
+
+    decoder->hasCleanupHook = false;
+    decoder->Shutdown();
+}
+
+void ImageDecoder::Finish(Napi::Env env, Job *job) {
+    HandleScope scope(env);
+    auto requests = std::move(job->requests);
+    auto& task = job->task;
+    auto error = task.GetError();
+    auto dataSize = task.GetDataSize();
+    auto width = Number::New(env, task.GetWidth());
+    auto height = Number::New(env, task.GetHeight());
+    auto levelCount = Number::New(env, task.GetLevelCount());
+    auto pixels = task.TakePixels();
+
+    if (!job->key.empty()) {
+        auto p = this->jobsByKey.find(job->key);
+
+        if (p != this->jobsByKey.end() && p->second == job) {
+            this->jobsByKey.erase(p);
+        }
+    }
+
+    for (auto& request : requests) {
+        this->jobsByRequest.erase(request.id);
+    }
+
+    this->DeleteJob(job);
+
+    std::unique_ptr<Error> callbackError;
+
+    for (auto& request : requests) {
+        try {
+            if (pixels) {
+                // Requests share the pixels. Each holds a reference until its buffer is released.
+                auto data = const_cast<uint8_t *>(pixels.get());
+
+                this->buffers.emplace(data, pixels);
+                request.callback.Call({
+                    env.Undefined(), Buffer<uint8_t>::New(env, data, dataSize), width, height, levelCount });
+            } else {
+                request.callback.Call({ Error::New(env, error).Value() });
+            }
+        } catch (const Error& e) {
+            // Keep calling back the other requests, then report the first exception.
+            if (!callbackError) {
+                callbackError.reset(new Error(e));
+            }
+        }
+    }
+
+    if (callbackError) {
+        callbackError->ThrowAsJavaScriptException();
+    }
+}
+
+void ImageDecoder::DeleteJob(Job *job) {
+    this->jobs.erase(job);
+
+    if (this->jobs.empty()) {
+        napi_unref_threadsafe_function(this->env, this->complete);
+    }
+
+    delete job;
+}
+
+void ImageDecoder::UpdatePriority(Job *job) {
+    auto priority = static_cast<int32_t>(IMAGE_DECODE_PRIORITY_BACKGROUND);
+
+    for (auto& request : job->requests) {
+        priority = std::min(priority, request.priority);
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    if (job->queued && job->priority != priority) {
+        this->GetQueue(job)[job->priority].erase(job->position);
+        this->Enqueue(job, priority);
+    } else {
+        job->priority = priority;
+    }
+}
+
+std::list<ImageDecoder::Job *> *ImageDecoder::GetQueue(Job *job) {
+    return job->task.GetStream() ? this->streamQueue : this->queue;
+}
+
+void ImageDecoder::Enqueue(Job *job, int32_t priority) {
+    auto& list = this->GetQueue(job)[priority];
+
+    job->priority = priority;
+    job->queued = true;
+    job->position = list.insert(list.end(), job);
+}
+
+ImageDecoder::Job *ImageDecoder::Dequeue(std::list<Job *> *queue) {
+    for (auto i = 0; i < IMAGE_DECODE_PRIORITY_COUNT; i++) {
+        auto& list = queue[i];
+
+        if (!list.empty()) {
+            auto job = list.front();
+
+            list.pop_front();
+            job->queued = false;
+
+            return job;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include "ImageDecodeTask.h"
+#include <napi.h>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Decode priorities, highest first. Values match Image.PRIORITY_* in lib/Core/Resource/Image.js.
+enum ImageDecodePriority : int32_t {
+    IMAGE_DECODE_PRIORITY_VISIBLE = 0,
+    IMAGE_DECODE_PRIORITY_PREFETCH = 1,
+    IMAGE_DECODE_PRIORITY_BACKGROUND = 2,
+};
+
+#define IMAGE_DECODE_PRIORITY_COUNT 3
+#define IMAGE_DECODE_DEFAULT_CONCURRENCY 2
+// Maximum number of ImageStream decodes running at once. Further stream decodes wait in the stream queue.
+#define IMAGE_DECODE_STREAM_CONCURRENCY 4
+
+/**
+ * Image decode scheduler of an environment.
+ *
+ * Decodes run on threads owned by the scheduler, rather than on the libuv pool shared with fs and dns. Queued decodes
+ * are taken highest priority first. A request can be cancelled or have its priority changed at any time: a request
+ * that has not started is dropped from the queue, and a running decode finishes without calling back.
+ *
+ * Requests for the same file path or string source, at the same size and format, share one decode.
+ *
+ * A decode of an ImageStream keeps its thread while it waits for the stream to be written. Stream decodes have their
+ * own queue and their own threads, started on demand up to IMAGE_DECODE_STREAM_CONCURRENCY, so slow downloads never
+ * hold the threads that decode files, buffers and strings.
+ *
+ * Image buffers passed to javascript reference native pixels, which are released by ReleaseBuffer(). Pixels can be
+ * shared by several buffers (requests that shared a decode, or cached SVG rasters) and can be read-only mappings of
+ * image cache files, so buffers must not be modified.
+ *
+ * Completed decodes are delivered to the javascript thread through a thread safe function. Except for the queue, all
+ * state is owned by the javascript thread.
+ */
+class ImageDecoder {
+public:
+    ImageDecoder();
+    ~ImageDecoder();
+
+    static ImageDecoder& Get(Napi::Env env);
+
+    // Queue a decode. The callback is called with (err, buffer, width, height, levelCount). Returns the request id.
+    uint32_t Submit(Napi::Env env,
+                    const Napi::Value& source,
+                    const std::string& sourceType,
+                    int width,
+                    int height,
+                    TextureFormat format,
+                    bool premultipliedAlpha,
+                    bool dither,
+                    bool mipmaps,
+                    bool basename,
+                    int32_t priority,
+                    const Napi::Function& callback);
+    // Cancel a request. Its callback will not be called. Returns false if the request is not pending.
+    bool Cancel(uint32_t requestId);
+    // Change the priority of a pending request. Returns false if the request is not pending.
+    bool SetPriority(uint32_t requestId, int32_t priority);
+    // Set the number of decode threads for files, buffers and strings. 0 selects the default. Removed threads finish
+    // their current decode first. Stream decode threads are not affected.
+    void SetConcurrency(int32_t concurrency);
+    // Release the pixels of an image buffer passed to a callback.
+    void ReleaseBuffer(const void *data);
+
+private:
+    struct Request {
+        uint32_t id;
+        int32_t priority;
+        Napi::FunctionReference callback;
+    };
+
+    struct Job {
+        Job(const std::string& key, const Napi::Value& source, const std::string& sourceType, int width, int height,
+            TextureFormat format, bool premultipliedAlpha, bool dither, bool mipmaps, bool basename,
+            const std::string& cacheDirectory, uint64_t cacheSizeLimit);
+
+        std::string key;
+        Napi::Reference<Napi::Value> sourceRef;
+        ImageDecodeTask task;
+        std::vector<Request> requests;
+        // Guarded by the queue mutex.
+        int32_t priority;
+        bool queued;
+        std::list<Job *>::iterator position;
+    };
+
+    napi_env env;
+    napi_threadsafe_function complete;
+    bool hasCleanupHook;
+    uint32_t nextRequestId;
+    std::unordered_set<Job *> jobs;
+    std::unordered_map<std::string, Job *> jobsByKey;
+    std::unordered_map<uint32_t, Job *> jobsByRequest;
+    std::vector<std::thread> threads;
+    std::vector<std::thread> streamThreads;
+    // References to the pixels of buffers passed to javascript, one per buffer.
+    std::unordered_multimap<const void *, std::shared_ptr<const uint8_t>> buffers;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::list<Job *> queue[IMAGE_DECODE_PRIORITY_COUNT];
+    std::list<Job *> streamQueue[IMAGE_DECODE_PRIORITY_COUNT];
+    // Stream source of the decode running on each stream thread, aborted to unblock the thread on shutdown.
+    std::vector<std::shared_ptr<ImageStreamBuffer>> runningStreams;
+    size_t threadCount;
+    bool stopped;
+
+    void Start(Napi::Env env);
+    void StartThreads(std::vector<std::thread>& target, size_t count, bool streams);
+    void Shutdown();
+    void AbortRunningStreams();
+    void Run(size_t index, bool streams);
+    void Finish(Napi::Env env, Job *job);
+    void DeleteJob(Job *job);
+    void UpdatePriority(Job *job);
+    std::list<Job *> *GetQueue(Job *job);
+    void Enqueue(Job *job, int32_t priority);
+    Job *Dequeue(std::list<Job *> *queue);
+
+    static void OnComplete(napi_env env, napi_value callback, void *context, void *data);
+    static void OnCleanup(void *arg);
+};
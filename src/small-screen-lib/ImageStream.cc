@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "ImageStream.h"
+#include "InstanceData.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace Napi;
+
+void ImageStreamBuffer::Write(const uint8_t *bytes, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->ended) {
+            return;
+        }
+
+        this->bytes.insert(this->bytes.end(), bytes, bytes + size);
+    }
+
+    this->condition.notify_all();
+}
+
+void ImageStreamBuffer::End() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        this->ended = true;
+    }
+
+    this->condition.notify_all();
+}
+
+void ImageStreamBuffer::Abort() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (!this->ended) {
+            this->ended = this->aborted = true;
+        }
+    }
+
+    this->condition.notify_all();
+}
+
+bool ImageStreamBuffer::IsAborted() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    return this->aborted;
+}
+
+void ImageStreamBuffer::Wait(std::unique_lock<std::mutex>& lock) {
+    this->condition.wait(lock, [this] { return this->ended || this->position < this->bytes.size(); });
+}
+
+size_t ImageStreamBuffer::Read(uint8_t *bytes, size_t size) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    // As with fread(), a short read means the end of the stream, so wait for all of the requested bytes.
+    this->condition.wait(lock, [this, size] { return this->ended || this->position + size <= this->bytes.size(); });
+
+    auto count = std::min(size, this->bytes.size() - std::min(this->position, this->bytes.size()));
+
+    if (count > 0) {
+        memcpy(bytes, this->bytes.data() + this->position, count);
+        this->position += count;
+    }
+
+    return count;
+}
+
+void ImageStreamBuffer::Skip(int64_t count) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    // Skipping past the written bytes is allowed. Reads wait for the bytes in between.
+    if (count < 0 && static_cast<size_t>(-count) > this->position) {
+        this->position = 0;
+    } else {
+        this->position += count;
+    }
+}
+
+bool ImageStreamBuffer::IsEnd() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    this->Wait(lock);
+
+    return this->position >= this->bytes.size();
+}
+
+bool ImageStreamBuffer::ReadAll(std::string& contents) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    this->condition.wait(lock, [this] { return this->ended; });
+
+    if (this->aborted) {
+        return false;
+    }
+
+    contents.assign(this->bytes.begin(), this->bytes.end());
+
+    return true;
+}
+
+Object ImageStream::Init(class Env env, Object exports) {
+    HandleScope scope(env);
+
+    auto func = DefineClass(env, "ImageStream", {
+        InstanceMethod("write", &ImageStream::Write),
+        InstanceMethod("end", &ImageStream::End),
+        InstanceMethod("abort", &ImageStream::Abort),
+    });
+
+    InstanceData::Get(env).Constructor<ImageStream>() = Persistent(func);
+
+    exports.Set("ImageStream", func);
+
+    return exports;
+}
+
+bool ImageStream::IsInstance(const Napi::Value& value) {
+    return value.IsObject()
+        && value.As<Object>().InstanceOf(InstanceData::Get(value.Env()).Constructor<ImageStream>().Value());
+}
+
+ImageStream::ImageStream(const CallbackInfo& info)
+    : ObjectWrap<ImageStream>(info), buffer(std::make_shared<ImageStreamBuffer>()) {
+}
+
+ImageStream::~ImageStream() {
+    this->buffer->Abort();
+}
+
+void ImageStream::Write(const CallbackInfo& info) {
+    if (!info[0].IsBuffer()) {
+        throw Error::New(info.Env(), "write() expects a Buffer.");
+    }
+
+    auto chunk = info[0].As<Buffer<uint8_t>>();
+
+    this->buffer->Write(chunk.Data(), chunk.Length());
+}
+
+void ImageStream::End(const CallbackInfo& info) {
+    this->buffer->End();
+}
+
+void ImageStream::Abort(const CallbackInfo& info) {
+    this->buffer->Abort();
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Encoded image bytes, written by javascript as they arrive, and read by a decode on a decode thread.
+ *
+ * Reads block until more bytes are written or the stream ends, so a decode can start with the first chunk and run
+ * while the rest of the image is still being read. Written bytes are kept until the stream is destroyed, so the
+ * reader can go back (stb_image rewinds while detecting the format) or read the whole image again.
+ */
+class ImageStreamBuffer {
+public:
+    ImageStreamBuffer() : position(0), ended(false), aborted(false) {}
+
+    // Append a copy of a chunk.
+    void Write(const uint8_t *bytes, size_t size);
+    // Mark the end of the image.
+    void End();
+    // End the stream without the rest of the image. Reads see the end of a truncated image.
+    void Abort();
+    bool IsAborted();
+
+    // Read size bytes at the read position. Blocks until the bytes are written or the stream ends. Returns the number
+    // of bytes read, which is less than size only at the end of the stream.
+    size_t Read(uint8_t *bytes, size_t size);
+    // Move the read position by count bytes, which can be negative.
+    void Skip(int64_t count);
+    // Blocks until bytes are available or the stream ends. Returns true at the end of the stream.
+    bool IsEnd();
+    // Wait for the end of the stream and copy all of its bytes. Returns false if the stream was aborted.
+    bool ReadAll(std::string& contents);
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<uint8_t> bytes;
+    size_t position;
+    bool ended;
+    bool aborted;
+
+    void Wait(std::unique_lock<std::mutex>& lock);
+};
+
+/**
+ * Javascript handle of an ImageStreamBuffer, passed to loadImage() as the image source.
+ *
+ * write(buffer) appends a chunk, end() marks the end of the image and abort() gives up on it. A stream that is
+ * garbage collected before end() is aborted, so a decode never waits on it forever.
+ */
+class ImageStream : public Napi::ObjectWrap<ImageStream> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    static bool IsInstance(const Napi::Value& value);
+
+    ImageStream(const Napi::CallbackInfo& info);
+    ~ImageStream();
+
+    void Write(const Napi::CallbackInfo& info);
+    void End(const Napi::CallbackInfo& info);
+    void Abort(const Napi::CallbackInfo& info);
+
+    const std::shared_ptr<ImageStreamBuffer>& GetBuffer() const { return this->buffer; }
+
+private:
+    std::shared_ptr<ImageStreamBuffer> buffer;
+};
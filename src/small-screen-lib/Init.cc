@@ -8,9 +8,11 @@
 #include <YogaValue.h>
 #include <YogaNode.h>
 #include <YogaGlobal.h>
+#include <FocusIndex.h>
 
 #include "TextLayout.h"
 #include "CapInsets.h"
+#include "ImageStream.h"
 #include "Global.h"
 #include "StbFont.h"
 #include "StbFontSample.h"
@@ -20,6 +22,7 @@ using namespace Napi;
 Object Init(Env env, Object exports) {
     TextLayout::Init(env, exports);
     CapInsets::Init(env, exports);
+    ImageStream::Init(env, exports);
     StbFont::Init(env);
     StbFontSample::Init(env);
     Global::Init(env, exports);
@@ -29,6 +32,7 @@ Object Init(Env env, Object exports) {
     exports["Yoga"] = yoga;
     Yoga::Value::Init(env, yoga);
     Yoga::Node::Init(env, yoga);
+    Yoga::FocusIndex::Init(env, yoga);
     Yoga::Init(env, yoga);
 
     return exports;
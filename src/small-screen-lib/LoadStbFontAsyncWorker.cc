@@ -7,66 +7,46 @@
 #include "LoadStbFontAsyncWorker.h"
 #include "Format.h"
 #include "StbFont.h"
+#include "Util.h"
+#include "MappedFile.h"
 #include <stdexcept>
-#include <cstdio>
 #include <stb_truetype.h>
 
 using namespace Napi;
 
-struct FileHandle {
-    FILE *fp;
-
-    FileHandle(const std::string filename, const char *flags) {
-        this->fp = fopen(filename.c_str(), flags);
-
-        if (!this->fp) {
-            throw std::runtime_error(Format() << "Font file not found: " << filename);
-        }
-    }
-
-    ~FileHandle() {
-        if (this->fp) {
-            fclose(this->fp);
-        }
-    }
-
-    operator FILE*() { return this->fp; }
-};
-
 LoadStbFontAsyncWorker::LoadStbFontAsyncWorker(Napi::Env env, const std::string filename)
     : AsyncWorker(Function::New(env, [](const CallbackInfo& info){})),
       promise(Promise::Deferred::New(env)),
       filename(filename),
-      count(0) {
+      count(0),
+      ttfHash(0) {
 
 }
 
 void LoadStbFontAsyncWorker::Execute() {
-    auto fileHandle = FileHandle(this->filename, "rb");
+    // Font files are mapped rather than copied to the heap. Glyph data is only paged in when a sample is rendered, and
+    // fonts loaded from the same file share one mapping.
+    auto file = MappedFile::OpenShared(this->filename);
+    auto buffer = file->GetData();
 
-    fseek(fileHandle, 0, SEEK_END);
-
-    auto size = ftell(fileHandle);
-
-    if (size == -1) {
-        throw std::runtime_error(Format() << "Font file access error: " << this->filename);
-    }
-
-    fseek(fileHandle, 0, SEEK_SET);
-
-    auto buffer = new uint8_t[size];
-
-    this->ttf = std::shared_ptr<uint8_t>(buffer, std::default_delete<uint8_t[]>());
-
-    if (fread(buffer, 1, size, fileHandle) != static_cast<size_t>(size)) {
-        throw std::runtime_error(Format() << "Font file read error: " << this->filename);
-    }
+    this->ttf = std::shared_ptr<const uint8_t>(file, buffer);
 
     this->count = stbtt_GetNumberOfFonts(buffer);
 
     if (this->count <= 0) {
         throw std::runtime_error(Format() << "Failed to parse font file: " << this->filename);
     }
+
+    // The font sample cache is keyed by the file's path, inode, size and modification time, so an edited or replaced
+    // font file invalidates its samples without reading the whole file on every load. The key is cheap, so it is
+    // computed whether or not the cache is enabled; a font loaded before setFontCacheDirectory() still has cached
+    // samples. Limitation: the modification time has one second granularity, so a file rewritten in place (same
+    // inode) within the same second, at the same size, keeps its stale samples. Replacing a file by rename, as
+    // installers and package managers do, changes the inode.
+    std::string id = Format() << file->GetFilename() << ":" << file->GetInode() << ":" << file->GetSize() << ":"
+        << file->GetModified();
+
+    this->ttfHash = HashBytes(id.c_str(), id.size());
 }
 
 void LoadStbFontAsyncWorker::OnOK() {
@@ -75,7 +55,7 @@ void LoadStbFontAsyncWorker::OnOK() {
     auto len = collection.Length();
 
     for (auto i = 0u; i < len; i++) {
-        collection[i] = StbFont::New(env, i, this->ttf);
+        collection[i] = StbFont::New(env, i, this->ttf, this->ttfHash);
     }
 
     this->promise.Resolve(collection);
@@ -26,5 +26,6 @@ private:
     Napi::Promise::Deferred promise;
     std::string filename;
     int32_t count;
-    std::shared_ptr<uint8_t> ttf;
+    std::shared_ptr<const uint8_t> ttf;
+    uint64_t ttfHash;
 };
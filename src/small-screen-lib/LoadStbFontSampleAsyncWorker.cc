@@ -8,27 +8,58 @@
 #include "StbFontSample.h"
 #include "Format.h"
 #include <iostream>
+#include <thread>
+#include <algorithm>
+#include <system_error>
 
 using namespace Napi;
 
+#define FONT_SAMPLE_MIN_PAGE_SIZE 64
+// Glyphs that do not fit on one page spill over to additional pages.
+#define FONT_SAMPLE_PAGE_SIZE 1024
+#define FONT_SAMPLE_GLYPH_PADDING 1
+// Rect packing wastes some space. Scale the total glyph area by this factor when choosing the texture size.
+#define FONT_SAMPLE_PACKING_SLACK 1.2f
+// Below this many glyphs per thread, starting a thread costs more than rasterizing the glyphs.
+#define FONT_SAMPLE_MIN_GLYPHS_PER_THREAD 32
+
+static int32_t GetPageSize(const std::vector<stbrp_rect>& rects);
+static void PackRects(int32_t size, std::vector<stbrp_rect>& rects);
+static void RenderGlyph(const stbtt_fontinfo *fontInfo, float scale, int32_t codepoint, const stbrp_rect& rect,
+    uint8_t *pixels, int32_t stride, stbtt_packedchar *packedChar);
 void AppendBasicLatinBlock(std::vector<int32_t>& charset);
 void AppendLatin1SupplementalBlock(std::vector<int32_t>& charset);
 void AppendSpecialBlock(std::vector<int32_t>& charset);
 
-LoadStbFontSampleAsyncWorker::LoadStbFontSampleAsyncWorker(Napi::Env env, std::shared_ptr<uint8_t> ttf, int32_t index, int32_t fontSize)
+LoadStbFontSampleAsyncWorker::LoadStbFontSampleAsyncWorker(Napi::Env env, std::shared_ptr<const uint8_t> ttf, uint64_t ttfHash,
+        int32_t index, int32_t fontSize, const std::string& cacheDirectory)
     : AsyncWorker(Function::New(env, [](const CallbackInfo& info){})),
       promise(Promise::Deferred::New(env)),
       ttf(ttf),
+      ttfHash(ttfHash),
       index(index),
       fontSize(fontSize),
-      ascent(0),
-      lineHeight(0),
-      width(0),
-      height(0) {
+      cacheDirectory(cacheDirectory),
+      data() {
 
 }
 
 void LoadStbFontSampleAsyncWorker::Execute() {
+    AppendBasicLatinBlock(this->charset);
+    AppendSpecialBlock(this->charset);
+
+    auto useCache = !this->cacheDirectory.empty();
+    FontSampleKey key = {
+        this->ttfHash,
+        this->index,
+        this->fontSize,
+        FontSampleCache::HashCharset(this->charset),
+    };
+
+    if (useCache && FontSampleCache::Load(this->cacheDirectory, key, this->data)) {
+        return;
+    }
+
     auto buffer = this->ttf.get();
     stbtt_fontinfo fontInfo;
 
@@ -36,27 +67,19 @@ void LoadStbFontSampleAsyncWorker::Execute() {
         throw std::runtime_error(Format() << "Failed to parse font.");
     }
 
-    AppendBasicLatinBlock(this->charset);
-    AppendSpecialBlock(this->charset);
-
     this->charMetrics.resize(this->charset.size());
 
-    this->Render();
+    this->Render(&fontInfo);
     this->CalculateFontMetrics(&fontInfo);
+
+    if (useCache) {
+        // The cache is an optimization. If the sample cannot be written, it is rendered again on the next load.
+        FontSampleCache::Store(this->cacheDirectory, key, this->data);
+    }
 }
 
 void LoadStbFontSampleAsyncWorker::OnOK() {
-    this->promise.Resolve(StbFontSample::New(
-        this->Env(),
-        this->fontSize,
-        this->ascent,
-        this->lineHeight,
-        this->pixels,
-        this->width,
-        this->height,
-        this->codepointMetrics,
-        this->kerningPairs
-    ));
+    this->promise.Resolve(StbFontSample::New(this->Env(), this->fontSize, this->data));
 }
 
 Value LoadStbFontSampleAsyncWorker::Promise() {
@@ -67,52 +90,121 @@ void LoadStbFontSampleAsyncWorker::OnError(const Error& e) {
     this->promise.Reject(e.Value());
 }
 
-void LoadStbFontSampleAsyncWorker::Render() {
-    auto packSuccessful = false;
+void LoadStbFontSampleAsyncWorker::Render(stbtt_fontinfo *fontInfo) {
+    auto count = static_cast<int32_t>(this->charset.size());
+    std::vector<stbrp_rect> rects(count);
     stbtt_pack_range packRange;
+    stbtt_pack_context context;
 
     packRange.font_size = this->fontSize;
     packRange.first_unicode_codepoint_in_range = 0;
     packRange.array_of_unicode_codepoints = &charset[0];
-    packRange.num_chars = (int)this->charset.size();
+    packRange.num_chars = count;
     packRange.chardata_for_range = &this->charMetrics[0];
 
-    auto buffer = this->ttf.get();
+    // Measure the glyph boxes. Only font metrics are read here; nothing is rasterized.
+    if (!stbtt_PackBegin(&context, nullptr, FONT_SAMPLE_PAGE_SIZE, FONT_SAMPLE_PAGE_SIZE, 0, FONT_SAMPLE_GLYPH_PADDING, nullptr)) {
+        throw std::runtime_error(Format() << "Failed to pack font glyphs.");
+    }
+
+    stbtt_PackFontRangesGatherRects(&context, fontInfo, &packRange, 1, &rects[0]);
+    stbtt_PackEnd(&context);
+
+    // stbtt only reserves the padding on the left and top of a glyph. Reserve it on the right and bottom, too, so every
+    // glyph is surrounded by a transparent border and filtering never samples a neighbouring glyph or page edge.
+    for (auto i = 0; i < count; i++) {
+        rects[i].id = i;
+        rects[i].w += FONT_SAMPLE_GLYPH_PADDING;
+        rects[i].h += FONT_SAMPLE_GLYPH_PADDING;
+    }
 
-    for (auto i : { 512, 1024 }) {
-        stbtt_pack_context context;
+    // Pack the glyph rects into pages. Each page is sized from the area of the glyphs that remain, so a small sample
+    // gets a single small page. When the glyphs do not fit on a full size page, the rest spill over to the next page.
+    std::vector<stbrp_rect> remaining(rects);
+    std::vector<stbrp_rect> unpacked;
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> pageBuffers;
 
-        this->pixels.resize(i*i);
+    this->glyphPages.assign(count, 0);
 
-        if (!stbtt_PackBegin(&context, &(this->pixels[0]), i, i, 0, 1, nullptr)) {
-            throw std::runtime_error(Format() << "Failed to pack font glyphs.");
+    while (!remaining.empty()) {
+        auto size = GetPageSize(remaining);
+
+        while (true) {
+            PackRects(size, remaining);
+
+            if (size >= FONT_SAMPLE_PAGE_SIZE
+                    || std::all_of(remaining.begin(), remaining.end(), [](const stbrp_rect& r) { return r.was_packed != 0; })) {
+                break;
+            }
+
+            size *= 2;
         }
 
-        if (!stbtt_PackFontRanges(&context, buffer, this->index, &packRange, 1)) {
-            stbtt_PackEnd(&context);
-            continue;
+        auto page = static_cast<int32_t>(this->data.pages.size());
+        int32_t ymax = 0;
+
+        unpacked.clear();
+
+        for (auto& rect : remaining) {
+            if (rect.was_packed) {
+                rects[rect.id] = rect;
+                this->glyphPages[rect.id] = page;
+                ymax = std::max(ymax, rect.y + rect.h);
+            } else {
+                unpacked.push_back(rect);
+            }
+        }
+
+        if (unpacked.size() == remaining.size()) {
+            throw std::runtime_error(Format() << "Font characters could not fit in video memory. Reduce font size.");
         }
 
-        stbtt_PackEnd(&context);
+        auto height = std::min(ymax + 1, size);
+        auto buffer = std::make_shared<std::vector<uint8_t>>(size * height, 0);
 
-        unsigned short ymax = 0;
+        pageBuffers.push_back(buffer);
+        this->data.pages.push_back({ size, height, std::shared_ptr<const uint8_t>(buffer, &(*buffer)[0]) });
 
-        for (stbtt_packedchar &p : this->charMetrics) {
-            ymax = std::max(p.y1, ymax);
+        remaining.swap(unpacked);
+    }
+
+    // Rasterize glyphs in parallel, directly into their packed positions. Each thread owns a contiguous slice of the
+    // charset and packed rects do not overlap, so no synchronization is needed.
+    auto scale = stbtt_ScaleForPixelHeight(fontInfo, this->fontSize);
+    auto threadCount = std::min(
+        std::max(static_cast<int32_t>(std::thread::hardware_concurrency()), 1),
+        std::max(count / FONT_SAMPLE_MIN_GLYPHS_PER_THREAD, 1));
+    auto sliceSize = (count + threadCount - 1) / threadCount;
+    std::vector<std::thread> threads;
+
+    auto renderSlice = [&](int32_t begin, int32_t end) {
+        for (auto i = begin; i < end; i++) {
+            auto page = this->glyphPages[i];
+
+            RenderGlyph(fontInfo, scale, this->charset[i], rects[i], &(*pageBuffers[page])[0],
+                this->data.pages[page].width, &this->charMetrics[i]);
         }
+    };
 
-        this->width = i;
-        this->height = std::min(ymax + 1, i);
-        this->pixels.resize(this->width*this->height);
-        this->pixels.shrink_to_fit();
+    auto begin = sliceSize;
 
-        packSuccessful = true;
+    // Thread creation throws std::system_error when the process is out of threads or memory. The slices that did not
+    // get a thread are rendered on this one.
+    try {
+        for (; begin < count; begin += sliceSize) {
+            threads.emplace_back(renderSlice, begin, std::min(begin + sliceSize, count));
+        }
+    } catch (const std::system_error&) {
+    }
+
+    renderSlice(0, std::min(sliceSize, count));
 
-        break;
+    if (begin < count) {
+        renderSlice(begin, count);
     }
 
-    if (!packSuccessful) {
-        throw std::runtime_error(Format() << "Font characters could not fit in video memory. Reduce font size.");
+    for (auto& thread : threads) {
+        thread.join();
     }
 }
 
@@ -128,7 +220,7 @@ void LoadStbFontSampleAsyncWorker::CalculateFontMetrics(stbtt_fontinfo *fontInfo
             auto value = stbtt_GetCodepointKernAdvance(fontInfo, first, second);
 
             if (value != 0) {
-                this->kerningPairs[((first & 0xFFFF) << 16) | (second & 0xFFFF)] = value * scale;
+                this->data.kerningPairs[((first & 0xFFFF) << 16) | (second & 0xFFFF)] = value * scale;
             }
         }
 
@@ -136,6 +228,7 @@ void LoadStbFontSampleAsyncWorker::CalculateFontMetrics(stbtt_fontinfo *fontInfo
         auto &p = this->charMetrics[i];
         CodepointMetrics metrics;
 
+        metrics.page = this->glyphPages[i];
         metrics.sourceX = p.x0;
         metrics.sourceY = p.y0;
         metrics.sourceWidth = p.x1 - p.x0;
@@ -151,7 +244,7 @@ void LoadStbFontSampleAsyncWorker::CalculateFontMetrics(stbtt_fontinfo *fontInfo
 
         metrics.xAdvance = p.xadvance;
 
-        this->codepointMetrics[codepoint] = metrics;
+        this->data.codepointMetrics[codepoint] = metrics;
     }
 
     int ascent = 0;
@@ -160,8 +253,62 @@ void LoadStbFontSampleAsyncWorker::CalculateFontMetrics(stbtt_fontinfo *fontInfo
 
     stbtt_GetFontVMetrics(fontInfo, &ascent, &descent, &lineGap);
 
-    this->ascent = ascent * scale;
-    this->lineHeight = (ascent - descent + lineGap) * scale;
+    this->data.ascent = ascent * scale;
+    this->data.lineHeight = (ascent - descent + lineGap) * scale;
+}
+
+// Choose the smallest power of two square that can hold the glyph area, up to the page size.
+static int32_t GetPageSize(const std::vector<stbrp_rect>& rects) {
+    size_t area = 0;
+    int32_t maxGlyphWidth = 0;
+    int32_t size = FONT_SAMPLE_MIN_PAGE_SIZE;
+
+    for (auto& rect : rects) {
+        area += rect.w * rect.h;
+        maxGlyphWidth = std::max(maxGlyphWidth, static_cast<int32_t>(rect.w));
+    }
+
+    while (size < FONT_SAMPLE_PAGE_SIZE && (size < maxGlyphWidth || size * size < area * FONT_SAMPLE_PACKING_SLACK)) {
+        size *= 2;
+    }
+
+    return size;
+}
+
+static void PackRects(int32_t size, std::vector<stbrp_rect>& rects) {
+    stbtt_pack_context context;
+
+    if (!stbtt_PackBegin(&context, nullptr, size, size, 0, FONT_SAMPLE_GLYPH_PADDING, nullptr)) {
+        throw std::runtime_error(Format() << "Failed to pack font glyphs.");
+    }
+
+    stbtt_PackFontRangesPackRects(&context, &rects[0], static_cast<int>(rects.size()));
+    stbtt_PackEnd(&context);
+}
+
+// Same as stbtt_PackFontRangesRenderIntoRects (without oversampling), but for a single glyph. Thread safe.
+static void RenderGlyph(const stbtt_fontinfo *fontInfo, float scale, int32_t codepoint, const stbrp_rect& rect,
+        uint8_t *pixels, int32_t stride, stbtt_packedchar *packedChar) {
+    auto glyph = stbtt_FindGlyphIndex(fontInfo, codepoint);
+    auto x = rect.x + FONT_SAMPLE_GLYPH_PADDING;
+    auto y = rect.y + FONT_SAMPLE_GLYPH_PADDING;
+    auto w = rect.w - 2 * FONT_SAMPLE_GLYPH_PADDING;
+    auto h = rect.h - 2 * FONT_SAMPLE_GLYPH_PADDING;
+    int advance, lsb, x0, y0, x1, y1;
+
+    stbtt_GetGlyphHMetrics(fontInfo, glyph, &advance, &lsb);
+    stbtt_GetGlyphBitmapBox(fontInfo, glyph, scale, scale, &x0, &y0, &x1, &y1);
+    stbtt_MakeGlyphBitmap(fontInfo, pixels + x + y * stride, w, h, stride, scale, scale, glyph);
+
+    packedChar->x0 = x;
+    packedChar->y0 = y;
+    packedChar->x1 = x + w;
+    packedChar->y1 = y + h;
+    packedChar->xadvance = scale * advance;
+    packedChar->xoff = x0;
+    packedChar->yoff = y0;
+    packedChar->xoff2 = x0 + w;
+    packedChar->yoff2 = y0 + h;
 }
 
 void AppendBasicLatinBlock(std::vector<int32_t>& charset) {
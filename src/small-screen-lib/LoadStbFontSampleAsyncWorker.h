@@ -7,13 +7,17 @@
 #pragma once
 
 #include <napi.h>
+// stb_rect_pack.h must precede stb_truetype.h, so stbrp_rect matches the stb_truetype implementation.
+#include <stb_rect_pack.h>
 #include <stb_truetype.h>
 #include <memory>
-#include "FontSample.h" // CodepointMetrics
+#include "FontSample.h" // FontSampleData
+#include "FontSampleCache.h"
 
 class LoadStbFontSampleAsyncWorker : public Napi::AsyncWorker {
 public:
-    LoadStbFontSampleAsyncWorker(Napi::Env env, std::shared_ptr<uint8_t> ttf, int32_t index, int32_t fontSize);
+    LoadStbFontSampleAsyncWorker(Napi::Env env, std::shared_ptr<const uint8_t> ttf, uint64_t ttfHash, int32_t index,
+        int32_t fontSize, const std::string& cacheDirectory);
     virtual ~LoadStbFontSampleAsyncWorker() {}
 
     Napi::Value Promise();
@@ -24,20 +28,18 @@ protected:
     virtual void OnError(const Napi::Error& e);
 
 private:
-    void Render();
+    void Render(stbtt_fontinfo *fontInfo);
     void CalculateFontMetrics(stbtt_fontinfo *fontInfo);
 
     Napi::Promise::Deferred promise;
-    std::shared_ptr<uint8_t> ttf;
+    std::shared_ptr<const uint8_t> ttf;
+    uint64_t ttfHash;
     int32_t index;
     int32_t fontSize;
-    float ascent;
-    float lineHeight;
-    int32_t width;
-    int32_t height;
-    std::vector<uint8_t> pixels;
+    std::string cacheDirectory;
     std::vector<int32_t> charset;
     std::vector<stbtt_packedchar> charMetrics;
-    std::map<int32_t, CodepointMetrics> codepointMetrics;
-    std::map<uint32_t, float> kerningPairs;
+    // Atlas page of each glyph in charset.
+    std::vector<int32_t> glyphPages;
+    FontSampleData data;
 };
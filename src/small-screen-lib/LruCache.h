@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// Least recently used cache. Entries are evicted, oldest first, when the total cost of the entries exceeds the
+// capacity. The most recently added entry is always kept.
+template<typename T>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity) : capacity(capacity), cost(0) {}
+
+    bool Get(const std::string& key, T& value) {
+        auto p = this->index.find(key);
+
+        if (p == this->index.end()) {
+            return false;
+        }
+
+        this->entries.splice(this->entries.begin(), this->entries, p->second);
+        value = p->second->value;
+
+        return true;
+    }
+
+    void Put(const std::string& key, const T& value, size_t cost) {
+        auto p = this->index.find(key);
+
+        if (p != this->index.end()) {
+            this->cost -= p->second->cost;
+            this->entries.erase(p->second);
+        }
+
+        this->entries.push_front({ key, value, cost });
+        this->index[key] = this->entries.begin();
+        this->cost += cost;
+
+        while (this->cost > this->capacity && this->entries.size() > 1) {
+            auto& last = this->entries.back();
+
+            this->cost -= last.cost;
+            this->index.erase(last.key);
+            this->entries.pop_back();
+        }
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        T value;
+        size_t cost;
+    };
+
+    size_t capacity;
+    size_t cost;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+};
@@ -5,13 +5,13 @@
  */
 
 #include "StbFont.h"
+#include "InstanceData.h"
 #include "LoadStbFontSampleAsyncWorker.h"
+#include "FontSampleCache.h"
 
 using namespace Napi;
 
-FunctionReference StbFont::constructor;
-
-StbFont::StbFont(const CallbackInfo& info) : ObjectWrap<StbFont>(info), index(-1) {
+StbFont::StbFont(const CallbackInfo& info) : ObjectWrap<StbFont>(info), index(-1), ttfHash(0) {
 
 }
 
@@ -35,16 +35,16 @@ void StbFont::Init(Napi::Env env) {
         InstanceMethod("createSample", &StbFont::CreateSample),
     });
 
-    constructor = Persistent(func);
-    constructor.SuppressDestruct();
+    InstanceData::Get(env).Constructor<StbFont>() = Persistent(func);
 }
 
-Object StbFont::New(Napi::Env env, int32_t index, std::shared_ptr<uint8_t> ttf) {
-    auto obj = StbFont::constructor.New({});
+Object StbFont::New(Napi::Env env, int32_t index, std::shared_ptr<const uint8_t> ttf, uint64_t ttfHash) {
+    auto obj = InstanceData::Get(env).Constructor<StbFont>().New({});
     auto font = ObjectWrap::Unwrap(obj);
 
     font->ttf = ttf;
     font->index = index;
+    font->ttfHash = ttfHash;
 
     return obj;
 }
@@ -56,7 +56,8 @@ Value StbFont::GetIndex(const CallbackInfo& info) {
 Value StbFont::CreateSample(const CallbackInfo& info) {
     auto env = info.Env();
     auto fontSize = info[0].As<Number>().Int32Value();
-    auto worker = new LoadStbFontSampleAsyncWorker(env, this->ttf, this->index, fontSize);
+    auto worker = new LoadStbFontSampleAsyncWorker(env, this->ttf, this->ttfHash, this->index, fontSize,
+        FontSampleCache::GetDirectory(env));
 
     worker->Queue();
 
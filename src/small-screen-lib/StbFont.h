@@ -16,14 +16,14 @@ public:
     ~StbFont();
 
     static void Init(Napi::Env env);
-    static Napi::Object New(Napi::Env env, int32_t index, std::shared_ptr<uint8_t> ttf);
+    static Napi::Object New(Napi::Env env, int32_t index, std::shared_ptr<const uint8_t> ttf, uint64_t ttfHash);
 
     Napi::Value CreateSample(const Napi::CallbackInfo& info);
     Napi::Value GetIndex(const Napi::CallbackInfo& info);
 
 private:
-    static Napi::FunctionReference constructor;
-
     int32_t index;
-    std::shared_ptr<uint8_t> ttf;
+    std::shared_ptr<const uint8_t> ttf;
+    // Hash of the font file path, inode, size and modification time, used as part of the font sample cache key.
+    uint64_t ttfHash;
 };
@@ -5,11 +5,10 @@
  */
 
 #include "StbFontSample.h"
+#include "InstanceData.h"
 
 using namespace Napi;
 
-FunctionReference StbFontSample::constructor;
-
 StbFontSample::StbFontSample(const CallbackInfo& info) : ObjectWrap<StbFontSample>(info), FontSample() {
 
 }
@@ -28,26 +27,26 @@ void StbFontSample::Init(Napi::Env env) {
         InstanceValue("weight", zero, napi_property_attributes::napi_writable),
         InstanceValue("fontSize", zero, napi_property_attributes::napi_writable),
         InstanceValue("status", zero, napi_property_attributes::napi_writable),
+        InstanceAccessor("pageCount", &StbFontSample::GetPageCount, nullptr),
     });
 
-    constructor = Persistent(func);
-    constructor.SuppressDestruct();
+    InstanceData::Get(env).Constructor<StbFontSample>() = Persistent(func);
+}
+
+Napi::Value StbFontSample::GetPageCount(const CallbackInfo& info) {
+    return Number::New(info.Env(), FontSample::GetPageCount());
 }
 
-Object StbFontSample::New(Napi::Env env, int32_t fontSize, float ascent, float lineHeight,
-        std::vector<uint8_t>& pixels, int32_t width, int32_t height,
-        std::map<int32_t, CodepointMetrics>& codepointMetrics, std::map<uint32_t, float>& kerningPairs) {
-    auto obj = StbFontSample::constructor.New({});
+Object StbFontSample::New(Napi::Env env, int32_t fontSize, FontSampleData& data) {
+    auto obj = InstanceData::Get(env).Constructor<StbFontSample>().New({});
     auto sample = ObjectWrap::Unwrap(obj);
 
     sample->fontSize = fontSize;
-    sample->ascent = ascent;
-    sample->lineHeight = lineHeight;
-    sample->texturePixels = std::move(pixels);
-    sample->textureWidth = width;
-    sample->textureHeight = height;
-    sample->codepointMetrics = std::move(codepointMetrics);
-    sample->kerningPairs = std::move(kerningPairs);
+    sample->ascent = data.ascent;
+    sample->lineHeight = data.lineHeight;
+    sample->pages = std::move(data.pages);
+    sample->codepointMetrics = std::move(data.codepointMetrics);
+    sample->kerningPairs = std::move(data.kerningPairs);
 
     return obj;
 }
@@ -17,18 +17,7 @@ public:
     ~StbFontSample();
 
     static void Init(Napi::Env env);
-    static Napi::Object New(
-        Napi::Env env,
-        int32_t fontSize,
-        float ascent,
-        float lineHeight,
-        std::vector<uint8_t>& pixels,
-        int32_t width,
-        int32_t height,
-        std::map<int32_t, CodepointMetrics>& codepointMetrics,
-        std::map<uint32_t, float>& kerningPairs
-    );
+    static Napi::Object New(Napi::Env env, int32_t fontSize, FontSampleData& data);
 
-private:
-    static Napi::FunctionReference constructor;
+    Napi::Value GetPageCount(const Napi::CallbackInfo& info);
 };
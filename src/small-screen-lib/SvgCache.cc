@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "SvgCache.h"
+#include "LruCache.h"
+#include <mutex>
+
+struct Raster {
+    std::shared_ptr<const uint8_t> pixels;
+    int width;
+    int height;
+};
+
+static std::mutex sMutex;
+static LruCache<std::shared_ptr<NSVGimage>> sDocuments(SVG_CACHE_MAX_DOCUMENTS);
+static LruCache<Raster> sRasters(SVG_CACHE_MAX_RASTER_BYTES);
+
+std::shared_ptr<NSVGimage> SvgCache::GetDocument(const std::string& key) {
+    std::lock_guard<std::mutex> lock(sMutex);
+    std::shared_ptr<NSVGimage> document;
+
+    sDocuments.Get(key, document);
+
+    return document;
+}
+
+std::shared_ptr<NSVGimage> SvgCache::PutDocument(const std::string& key, const std::shared_ptr<NSVGimage>& document) {
+    std::lock_guard<std::mutex> lock(sMutex);
+    std::shared_ptr<NSVGimage> existing;
+
+    if (sDocuments.Get(key, existing)) {
+        return existing;
+    }
+
+    sDocuments.Put(key, document, 1);
+
+    return document;
+}
+
+bool SvgCache::GetRaster(const std::string& key, std::shared_ptr<const uint8_t>& pixels, int& width, int& height) {
+    std::lock_guard<std::mutex> lock(sMutex);
+    Raster raster;
+
+    if (!sRasters.Get(key, raster)) {
+        return false;
+    }
+
+    pixels = raster.pixels;
+    width = raster.width;
+    height = raster.height;
+
+    return true;
+}
+
+void SvgCache::PutRaster(const std::string& key, const std::shared_ptr<const uint8_t>& pixels, int width,
+        int height) {
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    sRasters.Put(key, { pixels, width, height }, static_cast<size_t>(width) * height * 4);
+}
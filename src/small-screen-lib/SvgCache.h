@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct NSVGimage;
+
+#define SVG_CACHE_MAX_DOCUMENTS 64
+#define SVG_CACHE_MAX_RASTER_BYTES (16 * 1024 * 1024)
+
+/**
+ * In-memory caches of parsed SVG documents and of their rasterized, format converted pixels.
+ *
+ * Parsing is a large part of loading an SVG icon, so a document is parsed once and kept to rasterize other sizes.
+ * Documents are keyed by source: file path and modification time, or the hash of an SVG string or buffer. Rasters are
+ * keyed by document, size and texture format.
+ *
+ * Both caches are process-wide, thread safe and drop the least recently used entries when full. Parsed documents are
+ * only read by the rasterizer, so a cached document can be rasterized by several threads at once.
+ */
+namespace SvgCache {
+
+std::shared_ptr<NSVGimage> GetDocument(const std::string& key);
+// Add a parsed document. If another thread added the same document first, the existing document is returned.
+std::shared_ptr<NSVGimage> PutDocument(const std::string& key, const std::shared_ptr<NSVGimage>& document);
+
+bool GetRaster(const std::string& key, std::shared_ptr<const uint8_t>& pixels, int& width, int& height);
+void PutRaster(const std::string& key, const std::shared_ptr<const uint8_t>& pixels, int width, int height);
+
+}
@@ -5,6 +5,7 @@
  */
 
 #include "SDLMixerAudioContext.h"
+#include "InstanceData.h"
 #include <SDL.h>
 #include <SDL_mixer.h>
 #include <iostream>
@@ -14,8 +15,6 @@
 
 using namespace Napi;
 
-FunctionReference SDLMixerAudioContext::constructor;
-
 Object SDLMixerAudioContext::Init(class Env env, Object exports) {
     HandleScope scope(env);
 
@@ -29,8 +28,7 @@ Object SDLMixerAudioContext::Init(class Env env, Object exports) {
         InstanceMethod("getAudioStreamFormats", &SDLMixerAudioContext::GetAudioStreamFormats),
     });
 
-    constructor = Persistent(func);
-    constructor.SuppressDestruct();
+    InstanceData::Get(env).Constructor<SDLMixerAudioContext>() = Persistent(func);
 
     exports.Set("SDLMixerAudioContext", func);
 
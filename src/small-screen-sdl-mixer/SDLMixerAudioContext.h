@@ -25,7 +25,6 @@ public:
     Napi::Value GetAudioStreamFormats(const Napi::CallbackInfo& info);
     
 private:
-    static Napi::FunctionReference constructor;
     bool isOpen;
     
     void InitAudio(Napi::Env env);
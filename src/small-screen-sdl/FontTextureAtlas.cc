@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#include "FontTextureAtlas.h"
+#include "Util.h"
+#include <algorithm>
+
+#define FONT_TEXTURE_ATLAS_SIZE 1024
+// Pages larger than this in either dimension get their own texture.
+#define FONT_TEXTURE_ATLAS_MAX_SHARED_SIZE 512
+
+static bool Upload(SDL_Texture *texture, const FontTexturePage& page, const FontSamplePage& source,
+    bool premultipliedAlpha);
+
+FontTexture *FontTextureAtlas::Create(SDL_Renderer *renderer, uint32_t pixelFormat, bool premultipliedAlpha,
+        FontSample *sample) {
+    auto fontTexture = new FontTexture();
+    auto count = sample->GetPageCount();
+
+    for (int i = 0; i < count; i++) {
+        auto& source = sample->GetPage(i);
+        FontTexturePage page;
+
+        if (!this->Allocate(renderer, pixelFormat, source.width, source.height, page)) {
+            this->Destroy(fontTexture);
+            return nullptr;
+        }
+
+        fontTexture->pages.push_back(page);
+
+        if (!Upload(page.texture, page, source, premultipliedAlpha)) {
+            this->Destroy(fontTexture);
+            return nullptr;
+        }
+    }
+
+    return fontTexture;
+}
+
+void FontTextureAtlas::Destroy(FontTexture *fontTexture) {
+    if (!fontTexture) {
+        return;
+    }
+
+    for (auto& page : fontTexture->pages) {
+        auto p = std::find_if(this->textures.begin(), this->textures.end(),
+            [&](const AtlasTexture& t) { return t.texture == page.texture; });
+
+        // Not found if the atlas was cleared while the font texture was still held.
+        if (p == this->textures.end()) {
+            continue;
+        }
+
+        if (--p->refs <= 0) {
+            SDL_DestroyTexture(p->texture);
+            this->textures.erase(p);
+        } else if (p->shared) {
+            Release(*p, page);
+        }
+    }
+
+    delete fontTexture;
+}
+
+void FontTextureAtlas::Clear() {
+    for (auto& t : this->textures) {
+        SDL_DestroyTexture(t.texture);
+    }
+
+    this->textures.clear();
+}
+
+bool FontTextureAtlas::Allocate(SDL_Renderer *renderer, uint32_t pixelFormat, int32_t width, int32_t height,
+        FontTexturePage& page) {
+    if (width > FONT_TEXTURE_ATLAS_MAX_SHARED_SIZE || height > FONT_TEXTURE_ATLAS_MAX_SHARED_SIZE) {
+        auto texture = SDL_CreateTexture(renderer, pixelFormat, SDL_TEXTUREACCESS_STREAMING, width, height);
+
+        if (!texture) {
+            return false;
+        }
+
+        this->textures.push_back({ texture, false, {}, 1 });
+        page = { texture, 0, 0 };
+
+        return true;
+    }
+
+    for (auto& t : this->textures) {
+        if (t.shared && Place(t, width, height, page)) {
+            t.refs++;
+
+            return true;
+        }
+    }
+
+    auto texture = SDL_CreateTexture(renderer, pixelFormat, SDL_TEXTUREACCESS_STREAMING, FONT_TEXTURE_ATLAS_SIZE,
+        FONT_TEXTURE_ATLAS_SIZE);
+
+    if (!texture) {
+        return false;
+    }
+
+    this->textures.push_back({ texture, true, {}, 1 });
+    Place(this->textures.back(), width, height, page);
+
+    return true;
+}
+
+bool FontTextureAtlas::Place(AtlasTexture& atlasTexture, int32_t width, int32_t height, FontTexturePage& page) {
+    auto& shelves = atlasTexture.shelves;
+    Shelf *best = nullptr;
+    size_t bestSlot = 0;
+
+    // Use the shortest shelf with room for the page, either in a free slot or at the end of the shelf.
+    for (auto& shelf : shelves) {
+        if (shelf.height < height || (best && shelf.height >= best->height)) {
+            continue;
+        }
+
+        auto& slots = shelf.slots;
+        auto end = slots.empty() ? 0 : slots.back().x + slots.back().width;
+
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (!slots[i].used && slots[i].width >= width) {
+                best = &shelf;
+                bestSlot = i;
+                break;
+            }
+        }
+
+        if (best != &shelf && end + width <= FONT_TEXTURE_ATLAS_SIZE) {
+            best = &shelf;
+            bestSlot = slots.size();
+        }
+    }
+
+    if (best) {
+        auto& slots = best->slots;
+
+        if (bestSlot == slots.size()) {
+            auto x = slots.empty() ? 0 : slots.back().x + slots.back().width;
+
+            slots.push_back({ x, width, true });
+        } else {
+            auto& slot = slots[bestSlot];
+
+            if (slot.width > width) {
+                slots.insert(slots.begin() + bestSlot + 1, { slot.x + width, slot.width - width, false });
+            }
+
+            slots[bestSlot].width = width;
+            slots[bestSlot].used = true;
+        }
+
+        page = { atlasTexture.texture, slots[bestSlot].x, best->y };
+
+        return true;
+    }
+
+    // Start a new shelf below the last one.
+    auto y = shelves.empty() ? 0 : shelves.back().y + shelves.back().height;
+
+    if (y + height > FONT_TEXTURE_ATLAS_SIZE) {
+        return false;
+    }
+
+    shelves.push_back({ y, height, { { 0, width, true } } });
+    page = { atlasTexture.texture, 0, y };
+
+    return true;
+}
+
+void FontTextureAtlas::Release(AtlasTexture& atlasTexture, const FontTexturePage& page) {
+    auto& shelves = atlasTexture.shelves;
+    auto shelf = std::find_if(shelves.begin(), shelves.end(), [&](const Shelf& s) { return s.y == page.y; });
+
+    if (shelf == shelves.end()) {
+        return;
+    }
+
+    auto& slots = shelf->slots;
+    auto slot = std::find_if(slots.begin(), slots.end(), [&](const Slot& s) { return s.x == page.x && s.used; });
+
+    if (slot == slots.end()) {
+        return;
+    }
+
+    slot->used = false;
+
+    // Merge with free neighbours, so the freed span can hold a page wider than any single released page.
+    if (slot + 1 != slots.end() && !(slot + 1)->used) {
+        slot->width += (slot + 1)->width;
+        slots.erase(slot + 1);
+    }
+
+    if (slot != slots.begin() && !(slot - 1)->used) {
+        (slot - 1)->width += slot->width;
+        slots.erase(slot);
+    }
+
+    // Free space at the end of a shelf is the same as unallocated space.
+    if (!slots.empty() && !slots.back().used) {
+        slots.pop_back();
+    }
+
+    // Drop empty shelves at the bottom, so their rows can be taken by a new shelf of any height.
+    while (!shelves.empty() && shelves.back().slots.empty()) {
+        shelves.pop_back();
+    }
+}
+
+static bool Upload(SDL_Texture *texture, const FontTexturePage& page, const FontSamplePage& source,
+        bool premultipliedAlpha) {
+    SDL_Rect rect = { page.x, page.y, source.width, source.height };
+    void *pixels;
+    int destPitch;
+
+    if (SDL_LockTexture(texture, &rect, &pixels, &destPitch) != 0) {
+        return false;
+    }
+
+    auto dest = reinterpret_cast<unsigned char *>(pixels);
+    auto sourcePixels = source.pixels.get();
+
+    // Expand alpha to white + alpha. Premultiplied, white * alpha is alpha in every component, in any byte order.
+    if (premultipliedAlpha) {
+        for (int h = 0; h < source.height; h++) {
+            auto column = &dest[h*destPitch];
+
+            for (int w = 0; w < source.width; w++) {
+                auto alpha = *sourcePixels++;
+
+                *column++ = alpha;
+                *column++ = alpha;
+                *column++ = alpha;
+                *column++ = alpha;
+            }
+        }
+    } else if (IsBigEndian()) {
+        for (int h = 0; h < source.height; h++) {
+            auto column = &dest[h*destPitch];
+
+            for (int w = 0; w < source.width; w++) {
+                auto alpha = *sourcePixels++;
+
+                *column++ = alpha;
+                *column++ = 255;
+                *column++ = 255;
+                *column++ = 255;
+            }
+        }
+    } else {
+        for (int h = 0; h < source.height; h++) {
+            auto column = &dest[h*destPitch];
+
+            for (int w = 0; w < source.width; w++) {
+                auto alpha = *sourcePixels++;
+
+                *column++ = 255;
+                *column++ = 255;
+                *column++ = 255;
+                *column++ = alpha;
+            }
+        }
+    }
+
+    SDL_UnlockTexture(texture);
+
+    return true;
+}
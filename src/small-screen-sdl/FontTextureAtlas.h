@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef FONTTEXTUREATLAS_H
+#define FONTTEXTUREATLAS_H
+
+#include <SDL.h>
+#include <vector>
+#include "FontSample.h"
+
+// Location of a font sample page within an atlas texture.
+struct FontTexturePage {
+    SDL_Texture *texture;
+    int32_t x;
+    int32_t y;
+};
+
+// Textures for the pages of a font sample, indexed by CodepointMetrics::page.
+struct FontTexture {
+    std::vector<FontTexturePage> pages;
+};
+
+/**
+ * Packs font sample pages into shared, fixed size textures, so that small font samples do not each waste a mostly
+ * empty texture. Pages too large to share get a texture of their own.
+ *
+ * Space is allocated with a shelf packer. Each shelf tracks its slots, so space released by a destroyed FontTexture
+ * is reused by later pages that fit in the freed slot (or in a shelf that has been emptied). A shared texture is
+ * destroyed when the last page allocated in it is released.
+ */
+class FontTextureAtlas {
+public:
+    // Glyphs are white, with coverage as alpha. With premultipliedAlpha, the colors are premultiplied by alpha.
+    FontTexture *Create(SDL_Renderer *renderer, uint32_t pixelFormat, bool premultipliedAlpha, FontSample *sample);
+    void Destroy(FontTexture *fontTexture);
+
+    // Destroy all textures. Must be called before the renderer is destroyed. Outstanding FontTexture objects must
+    // still be passed to Destroy().
+    void Clear();
+
+private:
+    // Horizontal span of a shelf. Adjacent free slots are merged, and the slots of a shelf cover [0, end of shelf).
+    struct Slot {
+        int32_t x;
+        int32_t width;
+        bool used;
+    };
+
+    struct Shelf {
+        int32_t y;
+        int32_t height;
+        std::vector<Slot> slots;
+    };
+
+    struct AtlasTexture {
+        SDL_Texture *texture;
+        bool shared;
+        std::vector<Shelf> shelves;
+        int32_t refs;
+    };
+
+    std::vector<AtlasTexture> textures;
+
+    bool Allocate(SDL_Renderer *renderer, uint32_t pixelFormat, int32_t width, int32_t height, FontTexturePage& page);
+    static bool Place(AtlasTexture& atlasTexture, int32_t width, int32_t height, FontTexturePage& page);
+    static void Release(AtlasTexture& atlasTexture, const FontTexturePage& page);
+};
+
+#endif
@@ -5,14 +5,13 @@
  */
 
 #include "SDLAudioContext.h"
+#include "InstanceData.h"
 #include <SDL.h>
 #include <iostream>
 #include "Format.h"
 
 using namespace Napi;
 
-FunctionReference SDLAudioContext::constructor;
-
 Object SDLAudioContext::Init(class Env env, Object exports) {
     HandleScope scope(env);
 
@@ -26,8 +25,7 @@ Object SDLAudioContext::Init(class Env env, Object exports) {
         InstanceMethod("getAudioStreamFormats", &SDLAudioContext::GetAudioStreamFormats),
     });
 
-    constructor = Persistent(func);
-    constructor.SuppressDestruct();
+    InstanceData::Get(env).Constructor<SDLAudioContext>() = Persistent(func);
 
     exports.Set("SDLAudioContext", func);
 
@@ -26,8 +26,6 @@ public:
 
 
 private:
-    static Napi::FunctionReference constructor;
-
     void InitAudio(Napi::Env env);
 
     bool isOpen;
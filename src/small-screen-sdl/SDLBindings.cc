@@ -18,6 +18,7 @@
 #include <iostream>
 #include "FontSample.h"
 #include "SDLClient.h"
+#include "PixelPool.h"
 
 using namespace Napi;
 
@@ -35,6 +36,13 @@ static const std::vector<Uint32> TEXTURE_PIXEL_FORMATS = {
     SDL_PIXELFORMAT_BGRA8888
 };
 
+// 16 bit formats images can be decoded to, when the renderer supports them natively.
+static const std::vector<TextureFormat> PACKED_TEXTURE_FORMATS = {
+    TEXTURE_FORMAT_RGB565,
+    TEXTURE_FORMAT_RGBA4444,
+    TEXTURE_FORMAT_RGBA5551
+};
+
 static std::vector<unsigned char> sGameControllerMappings;
 static bool sGameControllerMappingsTried = false;
 
@@ -137,6 +145,24 @@ Object JS_GetCapabilities(const CallbackInfo& info) {
     caps["texturePixelFormatName"] = String::New(env, SDL_GetPixelFormatName(texturePixelFormat));
     caps["textureFormat"] = Number::New(env, textureFormat);
     caps["textureFormatName"] = String::New(env, getTextureFormatName(textureFormat));
+
+    // Other formats would be converted to a 32 bit format by SDL on upload, saving nothing, so only formats the
+    // renderer lists are offered.
+    auto packedTextureFormats = Array::New(env);
+
+    for (auto format : PACKED_TEXTURE_FORMATS) {
+        auto pixelFormat = GetPackedPixelFormat(format);
+
+        for (int i = 0; i < (int)rendererInfo.num_texture_formats; i++) {
+            if (pixelFormat == rendererInfo.texture_formats[i]) {
+                packedTextureFormats[packedTextureFormats.Length()] = Number::New(env, format);
+                break;
+            }
+        }
+    }
+
+    caps["packedTextureFormats"] = packedTextureFormats;
+
     caps["availableResolutions"] = resolutions;
     caps["vsync"] = Boolean::New(env, (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC) != 0);
 
@@ -231,6 +257,12 @@ std::string getTextureFormatName(TextureFormat textureFormat) {
             return "abgr";
         case TEXTURE_FORMAT_BGRA:
             return "bgra";
+        case TEXTURE_FORMAT_RGB565:
+            return "rgb565";
+        case TEXTURE_FORMAT_RGBA4444:
+            return "rgba4444";
+        case TEXTURE_FORMAT_RGBA5551:
+            return "rgba5551";
         default:
             return "none";
     }
@@ -248,6 +280,35 @@ Value JS_GetEvents(const CallbackInfo& info) {
     return Number::New(info.Env(), result);
 }
 
+// The SDL addon links its own copy of the pixel pool (used for effect rasterization), separate from small-screen-lib.
+Value JS_GetPixelPoolStats(const CallbackInfo& info) {
+    auto env = info.Env();
+    auto stats = GetPixelPoolStats();
+    auto result = Object::New(env);
+
+    result["usedBlocks"] = Number::New(env, stats.usedBlocks);
+    result["usedBytes"] = Number::New(env, stats.usedBytes);
+    result["peakUsedBytes"] = Number::New(env, stats.peakUsedBytes);
+    result["cachedBlocks"] = Number::New(env, stats.cachedBlocks);
+    result["cachedBytes"] = Number::New(env, stats.cachedBytes);
+    result["hits"] = Number::New(env, stats.hits);
+    result["misses"] = Number::New(env, stats.misses);
+
+    return result;
+}
+
+void JS_SetPixelPoolCacheLimit(const CallbackInfo& info) {
+    if (!info[0].IsNumber() || info[0].As<Number>().DoubleValue() < 0) {
+        throw Error::New(info.Env(), "limit parameter must be a Number >= 0");
+    }
+
+    SetPixelPoolCacheLimit(static_cast<size_t>(info[0].As<Number>().DoubleValue()));
+}
+
+void JS_TrimPixelPool(const CallbackInfo& info) {
+    TrimPixelPool();
+}
+
 Value toResolution(const Env env, int width, int height) {
     auto result = Object::New(env);
 
@@ -274,5 +335,9 @@ Object SDLBindingsInit(Env env, Object exports) {
     // TODO: refactor these free floating functions to a class
     exports["getEvents"] = Function::New(env, JS_GetEvents, "getEvents");
 
+    exports["getPixelPoolStats"] = Function::New(env, JS_GetPixelPoolStats, "getPixelPoolStats");
+    exports["setPixelPoolCacheLimit"] = Function::New(env, JS_SetPixelPoolCacheLimit, "setPixelPoolCacheLimit");
+    exports["trimPixelPool"] = Function::New(env, JS_TrimPixelPool, "trimPixelPool");
+
     return exports;
 }
\ No newline at end of file
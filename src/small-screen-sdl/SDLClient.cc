@@ -5,8 +5,11 @@
  */
 
 #include "SDLClient.h"
+#include "InstanceData.h"
 #include "Format.h"
 #include "Util.h"
+#include "PixelPool.h"
+#include <algorithm>
 #include <cstdio>
 #include <sstream>
 #include <nanosvg.h>
@@ -14,11 +17,9 @@
 
 using namespace Napi;
 
-FunctionReference SDLClient::constructor;
-static std::vector<unsigned char> sEffectScratch;
-
 char *FormatArc(char *str, int len, const char *arc, int radius);
 NSVGimage *CreateRoundedRectangleSVG(const RoundedRectangleEffect &spec);
+bool SupportsTextureBlendMode(SDL_Renderer *renderer, uint32_t pixelFormat, SDL_BlendMode blendMode);
 
 SDLClient::SDLClient(const CallbackInfo& info) : ObjectWrap<SDLClient>(info) {
     auto env = info.Env();
@@ -36,6 +37,7 @@ SDLClient::SDLClient(const CallbackInfo& info) : ObjectWrap<SDLClient>(info) {
 
     this->textureFormat = Cast(info[6].As<Number>().Int32Value());
     this->texturePixelFormat = info[7].As<Number>().Uint32Value();
+    this->premultipliedAlpha = info[8].ToBoolean();
 
     Uint32 windowFlags;
     int x;
@@ -75,6 +77,23 @@ SDLClient::SDLClient(const CallbackInfo& info) : ObjectWrap<SDLClient>(info) {
         throw Error::New(env, Format() << "SDL_CreateRenderer(): " << SDL_GetError());
     }
 
+    // Premultiplied alpha: result = source + destination * (1 - source alpha). Colors filtered by the texture
+    // sampler, when a texture is scaled, then blend without the dark fringes of straight alpha. Renderers that do not
+    // support custom blend modes fall back to straight alpha.
+    this->textureBlendMode = SDL_BLENDMODE_BLEND;
+
+    if (this->premultipliedAlpha) {
+        auto blendMode = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+
+        if (SupportsTextureBlendMode(this->renderer, this->texturePixelFormat, blendMode)) {
+            this->textureBlendMode = blendMode;
+        } else {
+            this->premultipliedAlpha = false;
+        }
+    }
+
     SDL_GetRendererOutputSize(this->renderer, &this->screenWidth, &this->screenHeight);
 
     if (width != (Uint32)this->screenWidth || height != (Uint32)this->screenHeight) {
@@ -97,13 +116,14 @@ Object SDLClient::Init(Napi::Env env, Object exports) {
         InstanceMethod("getScreenWidth", &SDLClient::GetScreenWidth),
         InstanceMethod("getScreenHeight", &SDLClient::GetScreenHeight),
         InstanceMethod("isFullscreen", &SDLClient::IsFullscreen),
+        InstanceMethod("isPremultipliedAlpha", &SDLClient::IsPremultipliedAlpha),
         InstanceMethod("createTexture", &SDLClient::CreateTexture),
         InstanceMethod("createFontTexture", &SDLClient::CreateFontTexture),
         InstanceMethod("destroyTexture", &SDLClient::DestroyTexture),
+        InstanceMethod("destroyFontTexture", &SDLClient::DestroyFontTexture),
     });
 
-    constructor = Persistent(func);
-    constructor.SuppressDestruct();
+    InstanceData::Get(env).Constructor<SDLClient>() = Persistent(func);
 
     exports.Set("SDLClient", func);
 
@@ -122,6 +142,7 @@ void SDLClient::Destroy(const CallbackInfo& info) {
             this->DestroyTexture(entry.second);
         }
 
+        this->fontTextureAtlas.Clear();
         SDL_DestroyRenderer(this->renderer);
         this->renderer = nullptr;
     }
@@ -132,6 +153,8 @@ void SDLClient::Destroy(const CallbackInfo& info) {
     }
 
     this->roundedRectangleEffectTextures.clear();
+    // Textures are freed with the renderer.
+    this->mipLevels.clear();
     this->width = this->height = 0;
     this->isFullscreen = false;
 }
@@ -172,18 +195,52 @@ Value SDLClient::IsFullscreen(const CallbackInfo& info) {
     return Boolean::New(info.Env(), this->isFullscreen);
 }
 
+Value SDLClient::IsPremultipliedAlpha(const CallbackInfo& info) {
+    return Boolean::New(info.Env(), this->premultipliedAlpha);
+}
+
 Value SDLClient::CreateTexture(const CallbackInfo& info) {
     auto env = info.Env();
     auto width = info[0].As<Number>().Int32Value();
     auto height = info[1].As<Number>().Int32Value();
     auto source = info[2].As<Buffer<Uint8>>();
+    // Images can be decoded to a 16 bit format, chosen per image. Other formats are in the client's texture format.
+    auto format = info[3].IsNumber() ? Cast(info[3].As<Number>().Int32Value()) : this->textureFormat;
+    auto pixelFormat = IsPackedFormat(format) ? GetPackedPixelFormat(format) : this->texturePixelFormat;
+    // The pixels can be followed by half size mip levels (see GetMipLevelCount()).
+    auto levelCount = info[4].IsNumber() ? std::max(info[4].As<Number>().Int32Value(), 1) : 1;
+    int bpp = SDL_BYTESPERPIXEL(pixelFormat);
+
+    if (width < 0 || height < 0
+            || source.Length() < static_cast<size_t>(GetMipChainSize(width, height, levelCount, bpp))) {
+        throw Error::New(env, "Texture buffer is smaller than width * height pixels.");
+    }
 
-    auto texture = this->CreateTexture(width, height, source.Data(), source.Length());
+    auto data = source.Data();
+    auto texture = this->CreateTexture(width, height, data, width * height * bpp, pixelFormat);
 
     if (texture == nullptr) {
         throw Error::New(env, Format() << "Failed to create texture. " << SDL_GetError());
     }
 
+    if (levelCount > 1) {
+        auto& levels = this->mipLevels[texture];
+
+        for (int i = 1; i < levelCount; i++) {
+            data += (width >> (i - 1)) * (height >> (i - 1)) * bpp;
+
+            auto level = this->CreateTexture(width >> i, height >> i, data, (width >> i) * (height >> i) * bpp,
+                pixelFormat);
+
+            // Without a level, the larger levels are drawn scaled down, so the image still draws.
+            if (level == nullptr) {
+                break;
+            }
+
+            levels.push_back(level);
+        }
+    }
+
     return External<SDL_Texture>::New(env, texture);
 }
 
@@ -196,7 +253,7 @@ Value SDLClient::CreateFontTexture(const CallbackInfo& info) {
         throw Error::New(env, Format() << "Failed to create font texture. " << SDL_GetError());
     }
 
-    return External<SDL_Texture>::New(env, texture);
+    return External<FontTexture>::New(env, texture);
 }
 
 void SDLClient::DestroyTexture(const CallbackInfo& info) {
@@ -205,9 +262,19 @@ void SDLClient::DestroyTexture(const CallbackInfo& info) {
     this->DestroyTexture(texture);
 }
 
+void SDLClient::DestroyFontTexture(const CallbackInfo& info) {
+    if (info[0].IsExternal()) {
+        this->fontTextureAtlas.Destroy(info[0].As<External<FontTexture>>().Data());
+    }
+}
+
 SDL_Texture *SDLClient::CreateTexture(int width, int height, unsigned char *source, int len) {
+    return this->CreateTexture(width, height, source, len, this->texturePixelFormat);
+}
+
+SDL_Texture *SDLClient::CreateTexture(int width, int height, unsigned char *source, int len, uint32_t pixelFormat) {
     auto texture = SDL_CreateTexture(this->renderer,
-                                     this->texturePixelFormat,
+                                     pixelFormat,
                                      SDL_TEXTUREACCESS_STREAMING,
                                      width,
                                      height);
@@ -225,7 +292,7 @@ SDL_Texture *SDLClient::CreateTexture(int width, int height, unsigned char *sour
         return nullptr;
     }
 
-    int bpp = SDL_BYTESPERPIXEL(this->texturePixelFormat);
+    int bpp = SDL_BYTESPERPIXEL(pixelFormat);
 
     if (pitch == width * bpp) {
         memcpy(pixels, source, bpp * width * height);
@@ -233,14 +300,8 @@ SDL_Texture *SDLClient::CreateTexture(int width, int height, unsigned char *sour
         auto dest = reinterpret_cast<unsigned char *>(pixels);
 
         for (int h = 0; h < height; h++) {
-            auto column = &dest[h*pitch];
-
-            for (int w = 0; w < width; w++) {
-                *column++ = *source++;
-                *column++ = *source++;
-                *column++ = *source++;
-                *column++ = *source++;
-            }
+            memcpy(&dest[h*pitch], source, width * bpp);
+            source += width * bpp;
         }
     }
 
@@ -249,62 +310,8 @@ SDL_Texture *SDLClient::CreateTexture(int width, int height, unsigned char *sour
     return texture;
 }
 
-SDL_Texture *SDLClient::CreateFontTexture(FontSample *sample) {
-    auto width = sample->GetTextureWidth();
-    auto height = sample->GetTextureHeight();
-    auto texture = SDL_CreateTexture(this->renderer,
-                                     this->texturePixelFormat,
-                                     SDL_TEXTUREACCESS_STREAMING,
-                                     width,
-                                     height);
-
-    if (texture == nullptr) {
-        return nullptr;
-    }
-
-    void *pixels;
-    int destPitch;
-    auto result = SDL_LockTexture(texture, nullptr, &pixels, &destPitch);
-
-    if (result != 0) {
-        SDL_DestroyTexture(texture);
-        return nullptr;
-    }
-
-    auto dest = reinterpret_cast<unsigned char *>(pixels);
-    auto source = sample->GetTexturePixels();
-
-    if (IsBigEndian()) {
-        for (int h = 0; h < height; h++) {
-            auto column = &dest[h*destPitch];
-
-            for (int w = 0; w < width; w++) {
-                auto alpha = *source++;
-
-                *column++ = alpha;
-                *column++ = 255;
-                *column++ = 255;
-                *column++ = 255;
-            }
-        }
-    } else {
-        for (int h = 0; h < height; h++) {
-            auto column = &dest[h*destPitch];
-
-            for (int w = 0; w < width; w++) {
-                auto alpha = *source++;
-
-                *column++ = 255;
-                *column++ = 255;
-                *column++ = 255;
-                *column++ = alpha;
-            }
-        }
-    }
-
-    SDL_UnlockTexture(texture);
-
-    return texture;
+FontTexture *SDLClient::CreateFontTexture(FontSample *sample) {
+    return this->fontTextureAtlas.Create(this->renderer, this->texturePixelFormat, this->premultipliedAlpha, sample);
 }
 
 SDL_Texture *SDLClient::GetEffectTexture(const RoundedRectangleEffect &spec) {
@@ -319,37 +326,92 @@ SDL_Texture *SDLClient::GetEffectTexture(const RoundedRectangleEffect &spec) {
     auto svg = CreateRoundedRectangleSVG(spec);
 
     if (!svg) {
-        return (this->roundedRectangleEffectTextures[spec] = nullptr);
+        return nullptr;
     }
 
     auto rasterizer = nsvgCreateRasterizer();
 
     if (!rasterizer) {
         nsvgDelete(svg);
-        return (this->roundedRectangleEffectTextures[spec] = nullptr);
+        return nullptr;
     }
 
     auto width = svg->width;
     auto height = svg->height;
     auto len = width * height * 4;
+    // The pixels are only needed until the texture is created. The pool hands the block to the next raster.
+    auto pixels = static_cast<unsigned char *>(PixelPoolAlloc(len));
 
-    if (len > sEffectScratch.size()) {
-        sEffectScratch.resize(width * height * 4);
+    if (!pixels) {
+        nsvgDeleteRasterizer(rasterizer);
+        nsvgDelete(svg);
+        return nullptr;
     }
 
-    nsvgRasterize(rasterizer, svg, 0, 0, 1, &sEffectScratch[0], width, height, width * 4);
+    nsvgRasterize(rasterizer, svg, 0, 0, 1, pixels, width, height, width * 4);
 
     nsvgDeleteRasterizer(rasterizer);
     nsvgDelete(svg);
 
+    if (this->premultipliedAlpha) {
+        PremultiplyAlpha(pixels, len);
+    }
+
     // Perf: Combine this with the copy operation in CreateTexture.
-    ConvertToFormat(&sEffectScratch[0], len, this->textureFormat);
+    ConvertToFormat(pixels, len, this->textureFormat);
+
+    auto texture = this->CreateTexture(width, height, pixels, len);
+
+    PixelPoolFree(pixels);
+
+    // Failures are not cached, so the effect is retried on the next draw (for example, after memory is released).
+    if (texture) {
+        this->roundedRectangleEffectTextures[spec] = texture;
+    }
+
+    return texture;
+}
 
-    return (this->roundedRectangleEffectTextures[spec] = this->CreateTexture(width, height, &sEffectScratch[0], len));
+SDL_Texture *SDLClient::GetMipLevel(SDL_Texture *texture, int width, int height) {
+    if (this->mipLevels.empty()) {
+        return texture;
+    }
+
+    auto p = this->mipLevels.find(texture);
+
+    if (p == this->mipLevels.end()) {
+        return texture;
+    }
+
+    // Levels are ordered largest first.
+    for (auto level : p->second) {
+        int levelWidth;
+        int levelHeight;
+
+        SDL_QueryTexture(level, nullptr, nullptr, &levelWidth, &levelHeight);
+
+        if (levelWidth < width || levelHeight < height) {
+            break;
+        }
+
+        texture = level;
+    }
+
+    return texture;
 }
 
 void SDLClient::DestroyTexture(SDL_Texture *texture) {
     if (texture) {
+        auto p = this->mipLevels.find(texture);
+
+        if (p != this->mipLevels.end()) {
+            for (auto level : p->second) {
+                SDL_DestroyTexture(level);
+            }
+
+            this->mipLevels.erase(p);
+        }
+
         SDL_DestroyTexture(texture);
     }
 }
@@ -430,3 +492,17 @@ char *FormatArc(char *str, int len, const char *arc, int radius) {
 
     return str;
 }
+
+bool SupportsTextureBlendMode(SDL_Renderer *renderer, uint32_t pixelFormat, SDL_BlendMode blendMode) {
+    auto texture = SDL_CreateTexture(renderer, pixelFormat, SDL_TEXTUREACCESS_STATIC, 1, 1);
+
+    if (!texture) {
+        return false;
+    }
+
+    auto result = SDL_SetTextureBlendMode(texture, blendMode);
+
+    SDL_DestroyTexture(texture);
+
+    return result == 0;
+}
@@ -10,13 +10,24 @@
 #include <napi.h>
 #include <SDL.h>
 #include <map>
+#include <vector>
 #include "TextureFormat.h"
 #include "FontSample.h"
 #include "RoundedRectangleEffect.h"
+#include "FontTextureAtlas.h"
+
+// SDL pixel format of a 16 bit texture format, or SDL_PIXELFORMAT_UNKNOWN if the format is not packed.
+inline uint32_t GetPackedPixelFormat(TextureFormat textureFormat) {
+    switch (textureFormat) {
+        case TEXTURE_FORMAT_RGB565: return SDL_PIXELFORMAT_RGB565;
+        case TEXTURE_FORMAT_RGBA4444: return SDL_PIXELFORMAT_RGBA4444;
+        case TEXTURE_FORMAT_RGBA5551: return SDL_PIXELFORMAT_RGBA5551;
+        default: return SDL_PIXELFORMAT_UNKNOWN;
+    }
+}
 
 class SDLClient : public Napi::ObjectWrap<SDLClient> {
 private:
-    static Napi::FunctionReference constructor;
     SDL_Window *window;
     SDL_Renderer *renderer;
     int width;
@@ -26,7 +37,13 @@ private:
     bool isFullscreen;
     TextureFormat textureFormat;
     uint32_t texturePixelFormat;
+    // If set, texture colors are premultiplied by alpha and textures are drawn with textureBlendMode.
+    bool premultipliedAlpha;
+    SDL_BlendMode textureBlendMode;
     std::map<RoundedRectangleEffect, SDL_Texture *> roundedRectangleEffectTextures;
+    // Half size levels of image textures created with mip levels, keyed by the full size texture.
+    std::map<SDL_Texture *, std::vector<SDL_Texture *>> mipLevels;
+    FontTextureAtlas fontTextureAtlas;
 
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -43,13 +60,19 @@ public:
     Napi::Value GetScreenWidth(const Napi::CallbackInfo& info);
     Napi::Value GetScreenHeight(const Napi::CallbackInfo& info);
     Napi::Value IsFullscreen(const Napi::CallbackInfo& info);
+    Napi::Value IsPremultipliedAlpha(const Napi::CallbackInfo& info);
     Napi::Value CreateTexture(const Napi::CallbackInfo& info);
     Napi::Value CreateFontTexture(const Napi::CallbackInfo& info);
     void DestroyTexture(const Napi::CallbackInfo& info);
+    void DestroyFontTexture(const Napi::CallbackInfo& info);
 
     SDL_Texture *CreateTexture(int width, int height, unsigned char *source, int len);
-    SDL_Texture *CreateFontTexture(FontSample *sample);
+    SDL_Texture *CreateTexture(int width, int height, unsigned char *source, int len, uint32_t pixelFormat);
+    FontTexture *CreateFontTexture(FontSample *sample);
     SDL_Texture *GetEffectTexture(const RoundedRectangleEffect &spec);
+    // Get the smallest mip level of texture that is at least width x height. If texture has no mip levels, or the size
+    // is larger than a level, texture is returned.
+    SDL_Texture *GetMipLevel(SDL_Texture *texture, int width, int height);
     void DestroyTexture(SDL_Texture *texture);
 
     SDL_Window *GetWindow() {
@@ -67,6 +90,14 @@ public:
     uint32_t GetTexturePixelFormat() {
         return this->texturePixelFormat;
     }
+
+    bool IsPremultipliedAlpha() {
+        return this->premultipliedAlpha;
+    }
+
+    SDL_BlendMode GetTextureBlendMode() {
+        return this->textureBlendMode;
+    }
 };
 
 #endif
@@ -5,13 +5,12 @@
  */
 
 #include "SDLGamepad.h"
+#include "InstanceData.h"
 #include "Format.h"
 #include <iostream>
 
 using namespace Napi;
 
-FunctionReference SDLGamepad::constructor;
-
 Object SDLGamepad::Init(Napi::Env env, Object exports) {
   Function func = DefineClass(env, "SDLGamepad", {
     InstanceMethod("getId", &SDLGamepad::GetId),
@@ -26,8 +25,7 @@ Object SDLGamepad::Init(Napi::Env env, Object exports) {
     StaticMethod("getIdForIndex", &SDLGamepad::GetIdForIndex),
   });
 
-  constructor = Persistent(func);
-  constructor.SuppressDestruct();
+  InstanceData::Get(env).Constructor<SDLGamepad>() = Persistent(func);
 
   exports.Set("SDLGamepad", func);
 
@@ -31,7 +31,6 @@ public:
     static Napi::Value GetIdForIndex(const Napi::CallbackInfo& info);
 
 private:
-    static Napi::FunctionReference constructor;
     SDL_Joystick *joystick;
 
     SDL_Joystick *GetJoystickOrThrow(Napi::Env env);
@@ -5,6 +5,7 @@
  */
 
 #include "SDLRenderingContext.h"
+#include "InstanceData.h"
 #include "Util.h"
 #include "FontSample.h"
 #include "TextLayout.h"
@@ -17,12 +18,11 @@
 using namespace Napi;
 using namespace std::chrono;
 
-inline void SetTextureTintColor(SDL_Texture *texture, const int64_t& color, uint8_t opacity);
+inline void SetTextureTintColor(SDL_Texture *texture, const int64_t& color, uint8_t opacity, SDLClient *client);
 inline void SetRenderDrawColor(SDL_Renderer *renderer, const int64_t& color, uint8_t opacity);
 inline void RenderCopy(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_Rect * dstrect,
     Value rotationAngle, const SDL_Point *rotationPoint);
 
-FunctionReference SDLRenderingContext::constructor;
 static const int64_t COLOR32 = 0xFFFFFFFF;
 
 Object SDLRenderingContext::Init(Napi::Env env, Object exports) {
@@ -45,8 +45,7 @@ Object SDLRenderingContext::Init(Napi::Env env, Object exports) {
     InstanceMethod("destroy", &SDLRenderingContext::Destroy),
   });
 
-  constructor = Persistent(func);
-  constructor.SuppressDestruct();
+  InstanceData::Get(env).Constructor<SDLRenderingContext>() = Persistent(func);
 
   exports.Set("SDLRenderingContext", func);
   
@@ -256,7 +255,7 @@ void SDLRenderingContext::DrawText(const CallbackInfo& info) {
     auto height = info[4].As<Number>().Int32Value();
     auto imageResource = info[5].As<Object>();
     auto sample = ObjectWrap<FontSample>::Unwrap(imageResource.Get("font").As<Object>());
-    auto texture = imageResource.Get("texture").As<External<SDL_Texture>>().Data();
+    auto fontTexture = imageResource.Get("texture").As<External<FontTexture>>().Data();
     // TODO: These args should get to the native layer through pushStyle(). Need to refactor to make style info available to native layer.
     auto textLayout = ObjectWrap<TextLayout>::Unwrap(info[6].As<Object>());
     auto textAlign = (TextAlign)(info[7].IsNumber() ? info[7].As<Number>().Int32Value() : TEXT_ALIGN_LEFT);
@@ -266,42 +265,58 @@ void SDLRenderingContext::DrawText(const CallbackInfo& info) {
     auto rotationPointX = this->wx + width / 2;
     auto rotationPointY = this->wy + height / 2;
 
+    // The text layout may be measured on the layout thread while an asynchronous layout is running.
+    std::lock_guard<std::mutex> lock(textLayout->GetMutex());
+
     // Layout will only be calculated if necessary (no text, no style, no bounds changes).
     textLayout->Layout(text, sample, maxLines, ellipsize, width, MEASURE_MODE_EXACTLY, height, MEASURE_MODE_EXACTLY);
 
-    auto line = 0;
     auto lineHeight = sample->GetLineHeight();
-    auto dx = textLayout->GetLineAlignmentOffset(line++, textAlign);
-    auto dy = 0.f;
     auto hasRotation = rotationAngleValue.IsNumber();
+    auto pageCount = static_cast<int>(fontTexture->pages.size());
     const SDL_Rect *destRect;
+    SDL_Rect sourceRect;
     SDL_Point rotationPoint = { 0, 0 };
 
-    SetTextureTintColor(texture, this->color, this->opacity);
-
-    // RenderCopy for each glyph is SLOW. Since SDL does not have a batch API for textured quads, OpenGL will have to
-    // be used directly to improve performance.
-    for (auto iter = textLayout->Begin(); iter != textLayout->End(); iter++) {
-        if (iter->HasTexture()) {
-            destRect = reinterpret_cast<const SDL_Rect *>(iter->GetDestRect(dx + x, dy + y));
-
-            if (hasRotation) {
-                rotationPoint.x = rotationPointX - destRect->x;
-                rotationPoint.y = rotationPointY - destRect->y;
+    // Glyphs are drawn one atlas page at a time, so consecutive RenderCopy calls use the same texture and tint.
+    for (auto page = 0; page < pageCount; page++) {
+        auto& texturePage = fontTexture->pages[page];
+        auto line = 0;
+        auto dx = textLayout->GetLineAlignmentOffset(line++, textAlign);
+        auto dy = 0.f;
+
+        SetTextureTintColor(texturePage.texture, this->color, this->opacity, this->client);
+
+        // RenderCopy for each glyph is SLOW. Since SDL does not have a batch API for textured quads, OpenGL will have
+        // to be used directly to improve performance.
+        for (auto iter = textLayout->Begin(); iter != textLayout->End(); iter++) {
+            if (iter->HasTexture()) {
+                if (iter->GetPage() == page) {
+                    destRect = reinterpret_cast<const SDL_Rect *>(iter->GetDestRect(dx + x, dy + y));
+
+                    if (hasRotation) {
+                        rotationPoint.x = rotationPointX - destRect->x;
+                        rotationPoint.y = rotationPointY - destRect->y;
+                    }
+
+                    sourceRect = *reinterpret_cast<const SDL_Rect *>(iter->GetSourceRect());
+                    sourceRect.x += texturePage.x;
+                    sourceRect.y += texturePage.y;
+
+                    RenderCopy(this->renderer,
+                               texturePage.texture,
+                               &sourceRect,
+                               destRect,
+                               rotationAngleValue,
+                               &rotationPoint);
+                }
+            } else if (iter->IsNewLine()) {
+                dx = textLayout->GetLineAlignmentOffset(line++, textAlign);
+                dy += lineHeight;
             }
 
-            RenderCopy(this->renderer,
-                       texture,
-                       reinterpret_cast<const SDL_Rect *>(iter->GetSourceRect()),
-                       destRect,
-                       rotationAngleValue,
-                       &rotationPoint);
-        } else if (iter->IsNewLine()) {
-            dx = textLayout->GetLineAlignmentOffset(line++, textAlign);
-            dy += lineHeight;
+            dx += iter->GetAdvance();
         }
-
-        dx += iter->GetAdvance();
     }
 }
 
@@ -316,17 +331,20 @@ void SDLRenderingContext::Blit(const CallbackInfo& info) {
     auto width = info[7].As<Number>().Int32Value();
     auto height = info[8].As<Number>().Int32Value();
 
-    SetTextureTintColor(texture, this->tintColor, this->opacity);
-
     SDL_Point rotationPoint = { rotationPointX, rotationPointY };
 
     if (!capInsetsValue.IsObject()) {
         SDL_Rect rect = { x, y, width, height };
 
+        // Drawing from the nearest mip level reads fewer texels and aliases less than scaling the full size texture.
+        // Cap insets are in full size texture coordinates, so a cap insets blit always uses the full size texture.
+        texture = this->client->GetMipLevel(texture, width, height);
+        SetTextureTintColor(texture, this->tintColor, this->opacity, this->client);
         RenderCopy(this->renderer, texture, nullptr, &rect, rotationAngleValue, &rotationPoint);
     } else {
         auto capInsets = ObjectWrap<CapInsets>::Unwrap(capInsetsValue.As<Object>());
 
+        SetTextureTintColor(texture, this->tintColor, this->opacity, this->client);
         this->BlitCapInsets(texture, capInsets->GetRectangle(), x, y, width, height, rotationAngleValue, &rotationPoint);
     }
 }
@@ -345,7 +363,7 @@ void SDLRenderingContext::FillRectRounded(const Napi::CallbackInfo& info) {
     auto texture = this->client->GetEffectTexture(roundedRectangleEffect);
 
     if (texture) {
-        SetTextureTintColor(texture, this->backgroundColor, this->opacity);
+        SetTextureTintColor(texture, this->backgroundColor, this->opacity, this->client);
         this->BlitCapInsets(
             texture,
             roundedRectangleEffect.GetCapInsets(),
@@ -372,7 +390,7 @@ void SDLRenderingContext::BorderRounded(const Napi::CallbackInfo& info) {
     auto texture = this->client->GetEffectTexture(roundedRectangleEffect);
 
     if (texture != nullptr) {
-        SetTextureTintColor(texture, this->borderColor, this->opacity);
+        SetTextureTintColor(texture, this->borderColor, this->opacity, this->client);
         this->BlitCapInsets(
             texture,
             roundedRectangleEffect.GetCapInsets(),
@@ -516,16 +534,32 @@ void SDLRenderingContext::BlitCapInsets(SDL_Texture *texture, const Rectangle& c
     RenderCopy(this->renderer, texture, &srcRect, &destRect, rotationAngleValue, rotationPoint);
 }
 
-inline void SetTextureTintColor(SDL_Texture *texture, const int64_t& color, uint8_t opacity) {
-    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+inline void SetTextureTintColor(SDL_Texture *texture, const int64_t& color, uint8_t opacity, SDLClient *client) {
+    uint8_t r, g, b, a;
 
     if (IsBigEndian()) {
-        SDL_SetTextureColorMod(texture, (color & 0xFF00) >> 8, (color & 0xFF0000) >> 16, (color & 0xFF000000) >> 24);
-        SDL_SetTextureAlphaMod(texture, color > COLOR32 ? static_cast<uint8_t>(color & 0xFF) : opacity);
+        r = (color & 0xFF00) >> 8;
+        g = (color & 0xFF0000) >> 16;
+        b = (color & 0xFF000000) >> 24;
+        a = color > COLOR32 ? static_cast<uint8_t>(color & 0xFF) : opacity;
     } else {
-        SDL_SetTextureColorMod(texture, (color & 0xFF0000) >> 16, (color & 0xFF00) >> 8, color & 0xFF);
-        SDL_SetTextureAlphaMod(texture, color > COLOR32 ? static_cast<uint8_t>((color & 0xFF000000) >> 24) : opacity);
+        r = (color & 0xFF0000) >> 16;
+        g = (color & 0xFF00) >> 8;
+        b = color & 0xFF;
+        a = color > COLOR32 ? static_cast<uint8_t>((color & 0xFF000000) >> 24) : opacity;
+    }
+
+    // With premultiplied alpha, the alpha modulation only scales the destination factor (1 - source alpha). The
+    // source colors must be scaled by the same alpha, so the tint color is premultiplied as well.
+    if (client->IsPremultipliedAlpha() && a != 255) {
+        r = (r * a + 127) / 255;
+        g = (g * a + 127) / 255;
+        b = (b * a + 127) / 255;
     }
+
+    SDL_SetTextureBlendMode(texture, client->GetTextureBlendMode());
+    SDL_SetTextureColorMod(texture, r, g, b);
+    SDL_SetTextureAlphaMod(texture, a);
 }
 
 inline void SetRenderDrawColor(SDL_Renderer *renderer, const int64_t& color, uint8_t opacity) {
@@ -38,7 +38,6 @@ public:
     void Destroy(const Napi::CallbackInfo& info);
 
 private:
-    static Napi::FunctionReference constructor;
     
     SDL_Renderer *renderer;
     int32_t wx;
@@ -8,6 +8,25 @@ import { assert } from 'chai'
 import { Image } from '../../../../lib/Core/Resource/Image'
 import { SourceType } from '../../../../lib/Core/Util'
 import { isRejected } from '../../../isRejected'
+import {
+  setImageCacheDirectory,
+  getImageCacheDirectory,
+  getPixelPoolStats,
+  trimPixelPool,
+  ImageStream
+} from '../../../../lib/Core/Util/small-screen-lib'
+import {
+  copyFileSync,
+  mkdtempSync,
+  readdirSync,
+  readFileSync,
+  rmdirSync,
+  unlinkSync,
+  utimesSync,
+  writeFileSync
+} from 'fs'
+import { tmpdir } from 'os'
+import { join } from 'path'
 
 const TEST_IMG = 'test/resources/tiger.png'
 const TEST_SVG = 'test/resources/tiger.svg'
@@ -19,6 +38,30 @@ const TEST_BAD_SVG_XML = 'this is not xml'
 
 const TEST_ONE = 'test/resources/one'
 
+const TEXTURE_FORMAT_RGB565 = 10
+const TEXTURE_FORMAT_RGBA4444 = 11
+const TEXTURE_FORMAT_RGBA5551 = 12
+
+// Premultiplied colors are at most the straight colors, and alpha is unchanged, so every byte of a premultiplied
+// image is <= the byte of the straight alpha image, in any texture format.
+async function assertPremultiplied (source, options) {
+  const straight = new Image()
+  const premultiplied = new Image()
+
+  try {
+    await straight.load(source, options)
+    await premultiplied.load(source, { ...options, premultipliedAlpha: true })
+
+    assert.equal(premultiplied.width, straight.width)
+    assert.equal(premultiplied.height, straight.height)
+    assert.isFalse(premultiplied.buffer.equals(straight.buffer))
+    assert.isTrue(premultiplied.buffer.every((value, i) => value <= straight.buffer[i]))
+  } finally {
+    straight.release()
+    premultiplied.release()
+  }
+}
+
 describe('Image', () => {
   let image
 
@@ -42,6 +85,20 @@ describe('Image', () => {
     it('should NOT load an image from corrupt Base64 encoded string', async () => {
       await isRejected(image.load(TEST_BAD_BASE64, { type: SourceType.BASE64 }))
     })
+    it('should load a png image with dimensions from file', async () => {
+      await image.load(TEST_IMG, { width: 100, height: 50 })
+
+      assert.equal(image.width, 100)
+      assert.equal(image.height, 50)
+      assert.isOk(image.buffer)
+    })
+    it('should load a png image with width only, preserving aspect ratio', async () => {
+      await image.load(TEST_IMG, { width: 150 })
+
+      assert.equal(image.width, 150)
+      assert.equal(image.height, 150)
+      assert.isOk(image.buffer)
+    })
     it('should load an SVG image from file', async () => {
       await image.load(TEST_SVG)
 
@@ -56,6 +113,23 @@ describe('Image', () => {
       assert.equal(image.height, 100)
       assert.isOk(image.buffer)
     })
+    it('should load an SVG image at several sizes', async () => {
+      const sizes = [ 32, 64, 32 ]
+      const images = sizes.map(() => new Image())
+
+      try {
+        for (let i = 0; i < sizes.length; i++) {
+          await images[i].load(TEST_SVG, { width: sizes[i], height: sizes[i] })
+
+          assert.equal(images[i].width, sizes[i])
+          assert.equal(images[i].height, sizes[i])
+        }
+
+        assert.isTrue(images[0].buffer.equals(images[2].buffer))
+      } finally {
+        images.forEach(image => image.release())
+      }
+    })
     it('should load an SVG image from an XML string', async () => {
       await image.load(TEST_SVG_XML, { type: SourceType.UTF8 })
 
@@ -70,23 +144,360 @@ describe('Image', () => {
       assert.equal(image.height, 1)
       assert.isOk(image.buffer)
     })
+    it('should find a file added to the directory when basename is set', async () => {
+      const dir = mkdtempSync(join(tmpdir(), 'image-basename-'))
+
+      try {
+        await isRejected(image.load(join(dir, 'tiger'), { basename: true }))
+
+        copyFileSync(TEST_IMG, join(dir, 'tiger.png'))
+
+        const other = new Image()
+
+        try {
+          await other.load(join(dir, 'tiger'), { basename: true })
+
+          assert.equal(other.width, 600)
+        } finally {
+          other.release()
+        }
+      } finally {
+        readdirSync(dir).forEach(file => unlinkSync(join(dir, file)))
+        rmdirSync(dir)
+      }
+    })
     it('should NOT load an image from a corrupt XML string', async () => {
       await isRejected(image.load(TEST_BAD_SVG_XML, { type: SourceType.UTF8 }))
     })
     it('should NOT load an SVG image from xml when no sourceType is set', async () => {
       await isRejected(image.load(TEST_SVG_XML))
     })
+    it('should share a decode between concurrent loads of the same file', async () => {
+      const other = new Image()
+
+      try {
+        await Promise.all([ image.load(TEST_IMG), other.load(TEST_IMG) ])
+
+        assert.equal(other.width, 600)
+        assert.equal(other.height, 600)
+        assert.isOk(image.buffer)
+        assert.isOk(other.buffer)
+        assert.notStrictEqual(image.buffer, other.buffer)
+        assert.isTrue(image.buffer.equals(other.buffer))
+      } finally {
+        other.release()
+      }
+    })
+    it('should load a png image with premultiplied alpha', async () => {
+      await assertPremultiplied(TEST_IMG, {})
+    })
+    it('should load a resized png image with premultiplied alpha', async () => {
+      await assertPremultiplied(TEST_IMG, { width: 100 })
+    })
+    it('should load an SVG image with premultiplied alpha', async () => {
+      await assertPremultiplied(TEST_SVG, { width: 100, height: 100 })
+    })
+    it('should load a png image in a 16 bit format', async () => {
+      for (const format of [TEXTURE_FORMAT_RGB565, TEXTURE_FORMAT_RGBA4444, TEXTURE_FORMAT_RGBA5551]) {
+        const other = new Image()
+
+        try {
+          await other.load(TEST_IMG, { width: 100, format })
+
+          assert.equal(other.format, format)
+          assert.equal(other.buffer.length, 100 * 100 * 2)
+        } finally {
+          other.release()
+        }
+      }
+    })
+    it('should load an SVG image in a 16 bit format', async () => {
+      await image.load(TEST_SVG, { width: 100, height: 100, format: TEXTURE_FORMAT_RGB565 })
+
+      assert.equal(image.buffer.length, 100 * 100 * 2)
+    })
+    it('should dither a png image reduced to a 16 bit format', async () => {
+      const dithered = new Image()
+
+      try {
+        await image.load(TEST_IMG, { width: 100, format: TEXTURE_FORMAT_RGBA4444 })
+        await dithered.load(TEST_IMG, { width: 100, format: TEXTURE_FORMAT_RGBA4444, dither: true })
+
+        assert.equal(dithered.buffer.length, image.buffer.length)
+        assert.isFalse(dithered.buffer.equals(image.buffer))
+      } finally {
+        dithered.release()
+      }
+    })
+    it('should load a png image with mip levels', async () => {
+      await image.load(TEST_IMG, { width: 100, mipmaps: true })
+
+      // 100x100, 50x50, 25x25, 12x12
+      assert.equal(image.levelCount, 4)
+      assert.equal(image.buffer.length, (100 * 100 + 50 * 50 + 25 * 25 + 12 * 12) * 4)
+    })
+    it('should load an SVG image with mip levels in a 16 bit format', async () => {
+      await image.load(TEST_SVG, { width: 100, height: 100, format: TEXTURE_FORMAT_RGB565, mipmaps: true })
+
+      assert.equal(image.levelCount, 4)
+      assert.equal(image.buffer.length, (100 * 100 + 50 * 50 + 25 * 25 + 12 * 12) * 2)
+    })
+    it('should load an image too small for mip levels', async () => {
+      await image.load(Buffer.from(TEST_BASE64, 'base64'), { type: SourceType.BASE64, mipmaps: true })
+
+      assert.equal(image.levelCount, 1)
+      assert.equal(image.buffer.length, 4)
+    })
+    it('should load a png image from a stream', async () => {
+      const bytes = readFileSync(TEST_IMG)
+      const stream = new ImageStream()
+      const other = new Image()
+      const load = image.load(stream)
+
+      // Write after the load starts, so the decode waits on the stream.
+      for (let i = 0; i < bytes.length; i += 4096) {
+        stream.write(bytes.slice(i, i + 4096))
+        await new Promise(resolve => setImmediate(resolve))
+      }
+
+      stream.end()
+
+      try {
+        await load
+        await other.load(TEST_IMG)
+
+        assert.equal(image.width, 600)
+        assert.equal(image.height, 600)
+        assert.isTrue(image.buffer.equals(other.buffer))
+      } finally {
+        other.release()
+      }
+    })
+    it('should load an SVG image from a stream', async () => {
+      const stream = new ImageStream()
+      const load = image.load(stream)
+
+      stream.write(Buffer.from(TEST_SVG_XML))
+      stream.end()
+      await load
+
+      assert.equal(image.width, 400)
+      assert.equal(image.height, 110)
+    })
+    it('should NOT load an image from an aborted stream', async () => {
+      const bytes = readFileSync(TEST_IMG)
+      const stream = new ImageStream()
+      const load = image.load(stream)
+
+      stream.write(bytes.slice(0, bytes.length / 2))
+      stream.abort()
+
+      await isRejected(load)
+    })
+    it('should load with a priority', async () => {
+      await image.load(TEST_IMG, { priority: Image.PRIORITY_BACKGROUND })
+
+      assert.equal(image.width, 600)
+      assert.isOk(image.buffer)
+    })
+  })
+  describe('release()', () => {
+    it('should reject a pending load', async () => {
+      const load = image.load(TEST_IMG)
+
+      image.release()
+
+      await isRejected(load)
+      assert.notExists(image.buffer)
+    })
+    it('should not affect other loads of the same file', async () => {
+      const other = new Image()
+
+      try {
+        const load = image.load(TEST_IMG)
+        const otherLoad = other.load(TEST_IMG)
+
+        image.release()
+
+        await isRejected(load)
+        await otherLoad
+        assert.equal(other.width, 600)
+        assert.isOk(other.buffer)
+      } finally {
+        other.release()
+      }
+    })
+    it('should cancel queued loads', async () => {
+      const images = []
+
+      Image.concurrency = 1
+
+      try {
+        for (let i = 0; i < 20; i++) {
+          const queued = new Image()
+
+          images.push(queued.load(TEST_IMG, { width: i + 1 }))
+          queued.release()
+        }
+
+        for (const load of images) {
+          await isRejected(load)
+        }
+      } finally {
+        Image.concurrency = 0
+      }
+    })
+  })
+  describe('image cache', () => {
+    let cacheDir
+
+    beforeEach(() => {
+      cacheDir = mkdtempSync(join(tmpdir(), 'image-cache-'))
+      setImageCacheDirectory(cacheDir)
+    })
+    afterEach(() => {
+      setImageCacheDirectory(null, 128 * 1024 * 1024)
+      readdirSync(cacheDir).forEach(file => unlinkSync(join(cacheDir, file)))
+      rmdirSync(cacheDir)
+    })
+    it('should set cache directory', () => {
+      assert.equal(getImageCacheDirectory(), cacheDir)
+      setImageCacheDirectory(null)
+      assert.isNull(getImageCacheDirectory())
+    })
+    it('should write image to cache', async () => {
+      await image.load(TEST_IMG, { width: 100 })
+
+      assert.lengthOf(readdirSync(cacheDir), 1)
+    })
+    it('should load image from cache', async () => {
+      const other = new Image()
+
+      try {
+        await image.load(TEST_IMG, { width: 100 })
+        await other.load(TEST_IMG, { width: 100 })
+
+        assert.equal(other.width, 100)
+        assert.equal(other.height, 100)
+        assert.isTrue(image.buffer.equals(other.buffer))
+      } finally {
+        other.release()
+      }
+    })
+    it('should remove least recently used images when over the size limit', async () => {
+      // Room for one 100x100 image.
+      setImageCacheDirectory(cacheDir, 50000)
+
+      await image.load(TEST_IMG, { width: 100 })
+      image.release()
+      image = new Image()
+      await image.load(TEST_IMG, { width: 99 })
+
+      assert.lengthOf(readdirSync(cacheDir), 1)
+    })
+    it('should remove stale temporary files', async () => {
+      const stale = join(cacheDir, 'stale.pixels.1.0.tmp')
+      const active = join(cacheDir, 'active.pixels.1.1.tmp')
+      const dayAgo = Date.now() / 1000 - 86400
+
+      writeFileSync(stale, Buffer.alloc(100))
+      utimesSync(stale, dayAgo, dayAgo)
+      writeFileSync(active, Buffer.alloc(100))
+
+      await image.load(TEST_IMG, { width: 100 })
+
+      assert.sameMembers(readdirSync(cacheDir).filter(file => file.endsWith('.tmp')), [ 'active.pixels.1.1.tmp' ])
+    })
+  })
+  describe('pixel pool', () => {
+    it('should return released image pixels to the pool', async () => {
+      await image.load(TEST_IMG)
+
+      const loaded = getPixelPoolStats()
+
+      image.release()
+      image = null
+
+      const released = getPixelPoolStats()
+
+      assert.isAtLeast(loaded.usedBytes, 600 * 600 * 4)
+      assert.isAtMost(released.usedBytes, loaded.usedBytes - 600 * 600 * 4)
+      assert.isAtLeast(released.cachedBytes, 600 * 600 * 4)
+    })
+    it('should reuse pooled pixels for the next image', async () => {
+      await image.load(TEST_IMG)
+      image.release()
+
+      const before = getPixelPoolStats()
+
+      image = new Image()
+      await image.load(TEST_IMG)
+
+      assert.isAbove(getPixelPoolStats().hits, before.hits)
+    })
+    it('should release cached pixels on trim', async () => {
+      await image.load(TEST_IMG)
+      image.release()
+      image = null
+      trimPixelPool()
+
+      assert.equal(getPixelPoolStats().cachedBytes, 0)
+    })
   })
   describe('concurrency()', () => {
     it('should update to 2', () => {
       Image.concurrency = 2
       assert.equal(Image.concurrency, 2)
-      Image.concurrency = 1
+      Image.concurrency = 0
     })
     it('should update to 0', () => {
       Image.concurrency = 0
       assert.equal(Image.concurrency, 0)
-      Image.concurrency = 1
+    })
+    it('should not wait for stream decodes when removing threads', async () => {
+      const bytes = readFileSync(TEST_IMG)
+      const streams = [ new ImageStream(), new ImageStream() ]
+      const images = [ new Image(), new Image() ]
+
+      Image.concurrency = 2
+
+      try {
+        const loads = images.map((i, index) => i.load(streams[index]).catch(e => e))
+
+        streams.forEach(stream => stream.write(bytes.slice(0, bytes.length / 2)))
+        await new Promise(resolve => setTimeout(resolve, 50))
+
+        // Both decodes are waiting on their streams, on stream threads. Removing a decode thread does not join them.
+        Image.concurrency = 1
+        streams.forEach(stream => stream.abort())
+
+        for (const load of loads) {
+          assert.instanceOf(await load, Error)
+        }
+      } finally {
+        images.forEach(i => i.release())
+        Image.concurrency = 0
+      }
+    })
+    it('should decode a file while streams wait for data', async () => {
+      const bytes = readFileSync(TEST_IMG)
+      const streams = [ new ImageStream(), new ImageStream() ]
+      const images = [ new Image(), new Image() ]
+      const loads = images.map((i, index) => i.load(streams[index]).catch(e => e))
+
+      try {
+        streams.forEach(stream => stream.write(bytes.slice(0, bytes.length / 2)))
+        await new Promise(resolve => setTimeout(resolve, 50))
+
+        // The streams are open and not ended. Their decodes must not hold the default 2 decode threads.
+        await image.load(TEST_IMG, { width: 100 })
+
+        assert.equal(image.width, 100)
+      } finally {
+        streams.forEach(stream => stream.abort())
+        await Promise.all(loads)
+        images.forEach(i => i.release())
+      }
     })
     it('should throw Error for negative numbers', () => {
       assert.throws(() => {
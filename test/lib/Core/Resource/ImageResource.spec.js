@@ -35,6 +35,20 @@ describe('ImageResource', () => {
       await isRejected(image._load({ graphics }))
     })
   })
+  describe('_cancel()', () => {
+    it('should put a loading resource in the INIT state', async () => {
+      const image = new ImageResource({ uri: 'test/resources/one.png', type: SourceType.FILE })
+      const load = image._load({ graphics })
+
+      assert.equal(image._state, Resource.LOADING)
+      image._cancel()
+
+      await load
+      assert.equal(image._state, Resource.INIT)
+      assert.isFalse(image.hasDimensions)
+      assert.notExists(image._image)
+    })
+  })
   describe('_attach()', () => {
     it('should put resource in the ATTACHED state with texture set', async () => {
       const image = new ImageResource({ uri: 'test/resources/one.png', type: SourceType.FILE })
@@ -9,6 +9,8 @@ import sinon from 'sinon'
 class Graphics {
   createTexture () {}
   destroyTexture () {}
+  createFontTexture () {}
+  destroyFontTexture () {}
 }
 
 export function createGraphics () {
@@ -6,7 +6,8 @@
 
 import { assert } from 'chai'
 import { Style } from '../../../../lib/Core/Style/Style'
-import { bindStyle } from '../../../../lib/Core/Style/StyleBindings'
+import { bindStyle, bindStyleProperty } from '../../../../lib/Core/Style/StyleBindings'
+import { Value as AnimatedValue } from '../../../../lib/Core/Style/Value'
 import {
   ALIGN_AUTO,
   ALIGN_CENTER,
@@ -166,6 +167,40 @@ describe('bindStyle()', () => {
       testPropertyWithInvalidValue('marginLeft', Node.prototype.getMargin, INVALID_INPUT_POINT_PERCENT_AUTO, EDGE_LEFT)
     })
   })
+  describe('compiled style', () => {
+    it('should apply the same style to multiple nodes', () => {
+      const style = Style({ width: 10, height: '50%', marginLeft: 'auto' })
+      const other = Node.create()
+
+      bindStyle(node, style)
+      bindStyle(other, style)
+
+      for (const n of [ node, other ]) {
+        assertValue(n.getWidth(), new Value(UNIT_POINT, 10))
+        assertValue(n.getHeight(), new Value(UNIT_PERCENT, 50))
+        assertValue(n.getMargin(EDGE_LEFT), new Value(UNIT_AUTO))
+      }
+
+      other.release()
+    })
+    it('should reset properties not in the new style', () => {
+      bindStyle(node, Style({ width: 10 }))
+      bindStyle(node, Style({ height: 10 }))
+
+      assert.equal(node.getWidth().unit, UNIT_AUTO)
+      assertValue(node.getHeight(), new Value(UNIT_POINT, 10))
+    })
+    it('should apply the current value of animated properties', () => {
+      const width = new AnimatedValue(10)
+      const style = Style({ width })
+
+      bindStyle(node, style)
+      assertValue(node.getWidth(), new Value(UNIT_POINT, 10))
+
+      bindStyleProperty(node, 'width', 20)
+      assertValue(node.getWidth(), new Value(UNIT_POINT, 20))
+    })
+  })
   beforeEach(() => {
     node = Node.create()
   })
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2019 Daniel Anderson
+ *
+ * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
+ */
+
+import { assert } from 'chai'
+import { Node, getInstanceCount } from '../../../../lib/Core/Util/Yoga'
+import { MutationLog } from '../../../../lib/Core/Util/MutationLog'
+
+describe('MutationLog', () => {
+  let log
+  let node
+  let childA
+  let childB
+  describe('pushChild()', () => {
+    it('should apply immediately outside of a batch', () => {
+      log.pushChild(node, childA)
+      assert.equal(node.getChildCount(), 1)
+      assert.equal(log.length, 0)
+    })
+    it('should defer until end()', () => {
+      log.begin()
+      log.pushChild(node, childA)
+      log.pushChild(node, childB)
+      assert.equal(node.getChildCount(), 0)
+      assert.equal(log.length, 2)
+      log.end()
+      assert.equal(node.getChildCount(), 2)
+      assert.equal(node.getChild(0), childA)
+      assert.equal(node.getChild(1), childB)
+      assert.equal(log.length, 0)
+    })
+    it('should coalesce remove and push into sendToBack', () => {
+      log.pushChild(node, childA)
+      log.pushChild(node, childB)
+      log.begin()
+      log.remove(childA, node)
+      log.pushChild(node, childA)
+      assert.equal(log.length, 1)
+      log.end()
+      assert.equal(node.getChild(0), childB)
+      assert.equal(node.getChild(1), childA)
+    })
+  })
+  describe('insertChild()', () => {
+    it('should insert at index when flushed', () => {
+      log.begin()
+      log.pushChild(node, childA)
+      log.insertChild(node, childB, 0)
+      log.end()
+      assert.equal(node.getChild(0), childB)
+      assert.equal(node.getChild(1), childA)
+    })
+  })
+  describe('remove()', () => {
+    it('should cancel out a preceding push of the same child', () => {
+      log.begin()
+      log.pushChild(node, childA)
+      log.remove(childA, node)
+      assert.equal(log.length, 0)
+      log.end()
+      assert.equal(node.getChildCount(), 0)
+    })
+  })
+  describe('sendToBack()', () => {
+    it('should drop a repeated sendToBack', () => {
+      log.pushChild(node, childA)
+      log.pushChild(node, childB)
+      log.begin()
+      log.sendToBack(childA)
+      log.sendToBack(childA)
+      assert.equal(log.length, 1)
+      log.end()
+      assert.equal(node.getChild(1), childA)
+    })
+  })
+  describe('release()', () => {
+    it('should coalesce remove and release', () => {
+      const child = Node.create()
+
+      log.pushChild(node, child)
+      log.begin()
+      log.remove(child, node)
+      log.release(child)
+      assert.equal(log.length, 1)
+      assert.equal(getInstanceCount(), 4)
+      log.end()
+      assert.equal(node.getChildCount(), 0)
+      assert.equal(getInstanceCount(), 3)
+    })
+  })
+  describe('end()', () => {
+    it('should only flush when the outermost batch ends', () => {
+      log.begin()
+      log.begin()
+      log.pushChild(node, childA)
+      log.end()
+      assert.equal(node.getChildCount(), 0)
+      log.end()
+      assert.equal(node.getChildCount(), 1)
+    })
+  })
+  describe('batch()', () => {
+    it('should end the batch when the commit throws', () => {
+      assert.throws(() => log.batch(() => {
+        log.pushChild(node, childA)
+        throw Error('commit failed')
+      }))
+      assert.equal(node.getChildCount(), 1)
+
+      log.pushChild(node, childB)
+      assert.equal(node.getChildCount(), 2)
+    })
+  })
+  describe('reset()', () => {
+    it('should recover from a batch that was never ended', () => {
+      log.begin()
+      log.pushChild(node, childA)
+      log.reset()
+      assert.equal(node.getChildCount(), 1)
+
+      log.pushChild(node, childB)
+      assert.equal(node.getChildCount(), 2)
+      log.end()
+      assert.equal(log.length, 0)
+    })
+  })
+  beforeEach(() => {
+    log = new MutationLog()
+    node = Node.create()
+    childA = Node.create()
+    childB = Node.create()
+  })
+  afterEach(() => {
+    childB.release()
+    childA.release()
+    node.release()
+    assert.equal(getInstanceCount(), 0)
+  })
+})
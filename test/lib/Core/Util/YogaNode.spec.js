@@ -6,12 +6,16 @@
 
 import { assert } from 'chai'
 import sinon from 'sinon'
+import { Worker } from 'worker_threads'
 import {
   Node,
   UNIT_AUTO,
   DIRECTION_LTR,
   EDGE_ALL,
   getInstanceCount,
+  getPoolStats,
+  reservePool,
+  shrinkPool,
   COMPUTED_LAYOUT_TOP,
   COMPUTED_LAYOUT_WIDTH,
   COMPUTED_LAYOUT_HEIGHT,
@@ -26,8 +30,12 @@ import {
   COMPUTED_BORDER_RIGHT,
   COMPUTED_BORDER_BOTTOM,
   COMPUTED_BORDER_LEFT,
-  COMPUTED_MARGIN_TOP, COMPUTED_MARGIN_RIGHT, COMPUTED_MARGIN_BOTTOM, COMPUTED_MARGIN_LEFT
+  COMPUTED_MARGIN_TOP, COMPUTED_MARGIN_RIGHT, COMPUTED_MARGIN_BOTTOM, COMPUTED_MARGIN_LEFT,
+  COMPUTED_FIELD_COUNT,
+  STYLE_HEIGHT,
+  UNIT_POINT
 } from '../../../../lib/Core/Util/Yoga'
+import { loadFont, TextLayout } from '../../../../lib/Core/Util/small-screen-lib'
 
 describe('Node', () => {
   let node
@@ -61,27 +69,36 @@ describe('Node', () => {
   describe('computed fields', () => {
     it('should be set after layout', () => {
       layout(node)
-      assert.equal(node[COMPUTED_LAYOUT_TOP], 5)
-      assert.equal(node[COMPUTED_LAYOUT_RIGHT], 5)
-      assert.equal(node[COMPUTED_LAYOUT_BOTTOM], 5)
-      assert.equal(node[COMPUTED_LAYOUT_LEFT], 5)
-      assert.equal(node[COMPUTED_LAYOUT_WIDTH], 100)
-      assert.equal(node[COMPUTED_LAYOUT_HEIGHT], 50)
 
-      assert.equal(node[COMPUTED_PADDING_TOP], 10)
-      assert.equal(node[COMPUTED_PADDING_RIGHT], 10)
-      assert.equal(node[COMPUTED_PADDING_BOTTOM], 10)
-      assert.equal(node[COMPUTED_PADDING_LEFT], 10)
+      const fields = Node.layout
+      const i = node.slot * COMPUTED_FIELD_COUNT
 
-      assert.equal(node[COMPUTED_MARGIN_TOP], 5)
-      assert.equal(node[COMPUTED_MARGIN_RIGHT], 5)
-      assert.equal(node[COMPUTED_MARGIN_BOTTOM], 5)
-      assert.equal(node[COMPUTED_MARGIN_LEFT], 5)
+      assert.equal(fields[i + COMPUTED_LAYOUT_TOP], 5)
+      assert.equal(fields[i + COMPUTED_LAYOUT_RIGHT], 5)
+      assert.equal(fields[i + COMPUTED_LAYOUT_BOTTOM], 5)
+      assert.equal(fields[i + COMPUTED_LAYOUT_LEFT], 5)
+      assert.equal(fields[i + COMPUTED_LAYOUT_WIDTH], 100)
+      assert.equal(fields[i + COMPUTED_LAYOUT_HEIGHT], 50)
 
-      assert.equal(node[COMPUTED_BORDER_TOP], 1)
-      assert.equal(node[COMPUTED_BORDER_RIGHT], 1)
-      assert.equal(node[COMPUTED_BORDER_BOTTOM], 1)
-      assert.equal(node[COMPUTED_BORDER_LEFT], 1)
+      assert.equal(fields[i + COMPUTED_PADDING_TOP], 10)
+      assert.equal(fields[i + COMPUTED_PADDING_RIGHT], 10)
+      assert.equal(fields[i + COMPUTED_PADDING_BOTTOM], 10)
+      assert.equal(fields[i + COMPUTED_PADDING_LEFT], 10)
+
+      assert.equal(fields[i + COMPUTED_MARGIN_TOP], 5)
+      assert.equal(fields[i + COMPUTED_MARGIN_RIGHT], 5)
+      assert.equal(fields[i + COMPUTED_MARGIN_BOTTOM], 5)
+      assert.equal(fields[i + COMPUTED_MARGIN_LEFT], 5)
+
+      assert.equal(fields[i + COMPUTED_BORDER_TOP], 1)
+      assert.equal(fields[i + COMPUTED_BORDER_RIGHT], 1)
+      assert.equal(fields[i + COMPUTED_BORDER_BOTTOM], 1)
+      assert.equal(fields[i + COMPUTED_BORDER_LEFT], 1)
+    })
+    it('should assign each node a distinct slot in the layout buffer', () => {
+      assert.notEqual(node.slot, childA.slot)
+      assert.instanceOf(Node.layout, Float32Array)
+      assert.isAtLeast(Node.layout.length, (Math.max(node.slot, childA.slot) + 1) * COMPUTED_FIELD_COUNT)
     })
   })
   describe('resetStyle()', () => {
@@ -195,6 +212,171 @@ describe('Node', () => {
       node.unsetMeasureFunc()
     })
   })
+  describe('calculateLayout()', () => {
+    it('should return only the nodes whose layout changed', () => {
+      node.pushChild(childA)
+      node.pushChild(childB)
+      childA.setHeight(10)
+      childB.setHeight(10)
+
+      assert.sameMembers(node.calculateLayout(100, 100, DIRECTION_LTR, true), [ node, childA, childB ])
+
+      childB.setHeight(20)
+
+      assert.sameMembers(node.calculateLayout(100, 100, DIRECTION_LTR, true), [ childB ])
+    })
+    it('should return undefined when changed nodes are not requested', () => {
+      assert.isUndefined(node.calculateLayout(100, 100, DIRECTION_LTR))
+    })
+  })
+  describe('calculateLayoutAsync()', () => {
+    it('should resolve with the nodes whose layout changed', async () => {
+      node.pushChild(childA)
+      childA.setHeight(10)
+
+      const changed = await node.calculateLayoutAsync(100, 100, DIRECTION_LTR, true)
+
+      assert.sameMembers(changed, [ node, childA ])
+      assert.equal(Node.layout[childA.slot * COMPUTED_FIELD_COUNT + COMPUTED_LAYOUT_HEIGHT], 10)
+    })
+    it('should reject mutations while layout is running', async () => {
+      const promise = node.calculateLayoutAsync(100, 100, DIRECTION_LTR)
+
+      assert.throws(() => node.setWidth(10))
+      assert.throws(() => node.pushChild(childA))
+      await promise
+      node.setWidth(10)
+    })
+    it('should reject computed layout reads while layout is running', async () => {
+      const promise = node.calculateLayoutAsync(100, 100, DIRECTION_LTR)
+
+      assert.throws(() => node.getBorderBox())
+      assert.throws(() => node.getPaddingBox())
+      assert.throws(() => node.getComputedBorder())
+      assert.throws(() => node.getComputedPadding())
+      assert.throws(() => node.getComputedMargin())
+      assert.throws(() => node.isDirty())
+      await promise
+      assert.sameOrderedMembers(node.getBorderBox(), [ 0, 0, 100, 100 ])
+    })
+    it('should defer applyStyle and markDirty until the layout is published', async () => {
+      node.pushChild(childA)
+      childA.setHeight(10)
+
+      const promise = node.calculateLayoutAsync(100, 100, DIRECTION_LTR)
+
+      childA.applyStyle(new Float32Array([ STYLE_HEIGHT, 0, UNIT_POINT, 20 ]), false)
+      childA.markDirty()
+      await promise
+
+      assert.equal(Node.layout[childA.slot * COMPUTED_FIELD_COUNT + COMPUTED_LAYOUT_HEIGHT], 10)
+      assert.isTrue(node.isDirty())
+
+      node.calculateLayout(100, 100, DIRECTION_LTR)
+      assert.equal(Node.layout[childA.slot * COMPUTED_FIELD_COUNT + COMPUTED_LAYOUT_HEIGHT], 20)
+    })
+    it('should lay out synchronously when the tree has a javascript measure function', async () => {
+      node.pushChild(childA)
+      childA.setMeasureFunc(() => ({ width: 10, height: 15 }))
+
+      const promise = node.calculateLayoutAsync(100, 100, DIRECTION_LTR)
+
+      assert.equal(Node.layout[childA.slot * COMPUTED_FIELD_COUNT + COMPUTED_LAYOUT_HEIGHT], 15)
+      await promise
+    })
+  })
+  describe('node pool', () => {
+    it('should pre-create pooled nodes', () => {
+      const { active, pooled } = getPoolStats()
+
+      reservePool(active + pooled + 4)
+
+      assert.equal(getPoolStats().pooled, pooled + 4)
+      assert.equal(getPoolStats().active, active)
+      reservePool(0)
+    })
+    it('should shrink the pool to the high-water mark', () => {
+      // Reset the high-water mark to the current active count and empty the pool.
+      shrinkPool()
+      shrinkPool()
+
+      const extra = [ Node.create(), Node.create() ]
+
+      extra.forEach(n => n.release())
+      shrinkPool()
+
+      // The two extra nodes were active since the last shrink, so they are kept.
+      assert.equal(getPoolStats().pooled, 2)
+      assert.equal(getPoolStats().highWaterMark, getPoolStats().active)
+
+      shrinkPool()
+
+      assert.equal(getPoolStats().pooled, 0)
+    })
+    it('should report arena capacity', () => {
+      const { arenaBlocks, arenaCapacity, arenaAvailable } = getPoolStats()
+
+      assert.isAtLeast(arenaBlocks, 1)
+      assert.isAtLeast(arenaCapacity, arenaAvailable)
+    })
+  })
+  describe('worker_threads', () => {
+    it('should keep node state per thread', async () => {
+      const active = getPoolStats().active
+      const source = `
+        const { parentPort } = require('worker_threads')
+        const { Node, getPoolStats } = require('bindings')('small-screen-lib').Yoga
+        const node = Node.create()
+
+        node.setWidth(30)
+        node.setHeight(20)
+        node.calculateLayout(100, 100, ${DIRECTION_LTR})
+        parentPort.postMessage({ slot: node.slot, width: Node.layout[node.slot * ${COMPUTED_FIELD_COUNT} + ${COMPUTED_LAYOUT_WIDTH}], active: getPoolStats().active })
+      `
+      const result = await new Promise((resolve, reject) => {
+        const worker = new Worker(source, { eval: true })
+
+        worker.once('message', resolve)
+        worker.once('error', reject)
+      })
+
+      assert.equal(result.width, 30)
+      assert.equal(result.active, 1)
+      assert.equal(getPoolStats().active, active)
+    })
+  })
+  describe('setTextMeasure()', () => {
+    it('should measure text on layout', async () => {
+      const fonts = await loadFont('test/resources/OpenSans-Regular.ttf')
+      const sample = await fonts[0].createSample(16)
+
+      node.pushChild(childA)
+      childA.setTextMeasure(new TextLayout(), sample, 'text', 0, false)
+      childA.markDirty()
+      node.calculateLayout(200, 200, DIRECTION_LTR)
+
+      assert.isAbove(childA.getBorderBox()[3], 0)
+    })
+    it('should measure zero size when font sample is not available', () => {
+      node.pushChild(childA)
+      childA.setTextMeasure(new TextLayout(), null, 'text', 0, false)
+      childA.markDirty()
+      node.calculateLayout(200, 200, DIRECTION_LTR)
+
+      assert.sameOrderedMembers(childA.getBorderBox(), [ 0, 0, 200, 0 ])
+    })
+    it('should be replaced by measure func', () => {
+      const measureFunc = sinon.spy(() => ({ width: 50, height: 50 }))
+
+      node.pushChild(childA)
+      childA.setTextMeasure(new TextLayout(), null, 'text', 0, false)
+      childA.setMeasureFunc(measureFunc)
+      childA.markDirty()
+      node.calculateLayout(200, 200, DIRECTION_LTR)
+
+      sinon.assert.calledOnce(measureFunc)
+    })
+  })
   beforeEach(() => {
     node = Node.create()
     childA = Node.create()
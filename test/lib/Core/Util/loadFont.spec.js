@@ -5,8 +5,16 @@
  */
 
 import { assert } from 'chai'
-import { loadFont } from '../../../../lib/Core/Util/small-screen-lib'
+import {
+  getFontCacheDirectory,
+  getMappedFileStats,
+  loadFont,
+  setFontCacheDirectory
+} from '../../../../lib/Core/Util/small-screen-lib'
 import { isRejected } from '../../../isRejected'
+import { mkdtempSync, readdirSync, writeFileSync, unlinkSync, rmdirSync } from 'fs'
+import { tmpdir } from 'os'
+import { join } from 'path'
 
 const TTF = 'test/resources/OpenSans-Regular.ttf'
 const TTC = 'test/resources/sample_font_collection.ttc'
@@ -41,10 +49,85 @@ describe('loadFont', () => {
 
     assert.equal(Object.getPrototypeOf(sample).constructor.name, 'StbFontSample')
   })
+  it('should load sample that spans multiple atlas pages', async () => {
+    const fonts = await loadFont(TTF)
+    const sample = await fonts[0].createSample(256)
+
+    assert.equal(Object.getPrototypeOf(sample).constructor.name, 'StbFontSample')
+    assert.isAbove(sample.pageCount, 1)
+  })
+  it('should load the same font file concurrently', async () => {
+    const before = getMappedFileStats()
+    const [ a, b ] = await Promise.all([ loadFont(TTF), loadFont(TTF) ])
+    const samples = await Promise.all([ a[0].createSample(14), b[0].createSample(16) ])
+    const after = getMappedFileStats()
+
+    samples.forEach(sample => assert.equal(Object.getPrototypeOf(sample).constructor.name, 'StbFontSample'))
+    // The second load reuses the mapping of the first, which the fonts keep alive.
+    assert.isAtLeast(after.sharedHits - before.sharedHits, 1)
+    assert.isAtMost(after.sharedMisses - before.sharedMisses, 1)
+  })
   it('should throw Error for file not found', async () => {
     await isRejected(loadFont('file.ttf'))
   })
   it('should throw Error for non-font file', async () => {
     await isRejected(loadFont('test/resources/one.png'))
   })
+  describe('font sample cache', () => {
+    let cacheDir
+
+    beforeEach(() => {
+      cacheDir = mkdtempSync(join(tmpdir(), 'font-cache-'))
+      setFontCacheDirectory(cacheDir)
+    })
+    afterEach(() => {
+      setFontCacheDirectory(null)
+      readdirSync(cacheDir).forEach(file => unlinkSync(join(cacheDir, file)))
+      rmdirSync(cacheDir)
+    })
+    it('should set cache directory', () => {
+      assert.equal(getFontCacheDirectory(), cacheDir)
+      setFontCacheDirectory(null)
+      assert.isNull(getFontCacheDirectory())
+    })
+    it('should write sample to cache', async () => {
+      const fonts = await loadFont(TTF)
+
+      await fonts[0].createSample(14)
+
+      assert.lengthOf(readdirSync(cacheDir), 1)
+    })
+    it('should cache samples of a font loaded before the cache directory was set', async () => {
+      setFontCacheDirectory(null)
+
+      const fonts = await loadFont(TTF)
+
+      setFontCacheDirectory(cacheDir)
+      await fonts[0].createSample(14)
+
+      assert.lengthOf(readdirSync(cacheDir), 1)
+    })
+    it('should load sample from cache', async () => {
+      await (await loadFont(TTF))[0].createSample(14)
+
+      const sample = await (await loadFont(TTF))[0].createSample(14)
+
+      assert.equal(Object.getPrototypeOf(sample).constructor.name, 'StbFontSample')
+      assert.lengthOf(readdirSync(cacheDir), 1)
+    })
+    it('should replace corrupt cache file', async () => {
+      const fonts = await loadFont(TTF)
+
+      await fonts[0].createSample(14)
+
+      const [ file ] = readdirSync(cacheDir)
+
+      writeFileSync(join(cacheDir, file), 'corrupt')
+
+      const sample = await fonts[0].createSample(14)
+
+      assert.equal(Object.getPrototypeOf(sample).constructor.name, 'StbFontSample')
+      assert.deepEqual(readdirSync(cacheDir), [ file ])
+    })
+  })
 })
@@ -7,6 +7,7 @@
 import { assert } from 'chai'
 import { FocusManager } from '../../../../lib/Core/Views/FocusManager'
 import { BoxView } from '../../../../lib/Core/Views/BoxView'
+import { RootView } from '../../../../lib/Core/Views/RootView'
 import sinon from 'sinon'
 import { LayoutManager } from '../../../../lib/Core/Views/LayoutManager'
 import { KeyEvent } from '../../../../lib/Core/Event/KeyEvent'
@@ -14,6 +15,7 @@ import { Direction } from '../../../../lib/Core/Views/Direction'
 import { StandardKey } from '../../../../lib/Core/Input/StandardKey'
 import { StandardMapping } from '../../../../lib/Core/Input/StandardMapping'
 import { ResourceManager } from '../../../../lib/Core/Resource/ResourceManager'
+import { DIRECTION_LTR, EDGE_LEFT } from '../../../../lib/Core/Util/Yoga'
 
 describe('FocusManager', () => {
   let app
@@ -79,9 +81,105 @@ describe('FocusManager', () => {
 
       sinon.assert.calledOnce(view.onKeyDown)
     })
+    it('should move focus to the nearest view in the key direction', () => {
+      const [ a, b ] = createGrid([ [ 0, 0 ], [ 150, 0 ] ])
+
+      app.focus.setFocus(a)
+      app.focus.onKeyDown(createKeyDown(StandardKey.RIGHT, Direction.RIGHT))
+
+      assert.strictEqual(app.focus.focused, b)
+    })
+    it('should prefer the candidate of a focus delegate over the nearest view', () => {
+      const [ a, b, c ] = createGrid([ [ 0, 0 ], [ 150, 0 ], [ 300, 0 ] ])
+
+      app.focus.setFocus(a)
+      a.parent.focusDelegate = { focusDelegateNavigate: (view, navigate) => navigate.continue(c) }
+      app.focus.onKeyDown(createKeyDown(StandardKey.RIGHT, Direction.RIGHT))
+
+      assert.strictEqual(app.focus.focused, c)
+      sinon.assert.notCalled(b.onFocus)
+    })
+  })
+  describe('findNext()', () => {
+    it('should find the nearest view in each direction', () => {
+      const [ topLeft, topRight, bottomLeft, bottomRight ] = createGrid([ [ 0, 0 ], [ 100, 0 ], [ 0, 100 ], [ 100, 100 ] ])
+
+      assert.strictEqual(app.focus.findNext(topLeft, Direction.RIGHT), topRight)
+      assert.strictEqual(app.focus.findNext(topLeft, Direction.DOWN), bottomLeft)
+      assert.strictEqual(app.focus.findNext(bottomRight, Direction.LEFT), bottomLeft)
+      assert.strictEqual(app.focus.findNext(bottomRight, Direction.UP), topRight)
+      assert.isNull(app.focus.findNext(topLeft, Direction.LEFT))
+      assert.isNull(app.focus.findNext(topLeft, Direction.UP))
+    })
+    it('should prefer a view in the beam over a closer diagonal view', () => {
+      const [ source, aligned ] = createGrid([ [ 0, 0 ], [ 400, 0 ], [ 120, 120 ] ])
+
+      assert.strictEqual(app.focus.findNext(source, Direction.RIGHT), aligned)
+    })
+    it('should follow layout changes', () => {
+      const [ source, moving, fixed ] = createGrid([ [ 0, 0 ], [ 200, 0 ], [ 400, 0 ] ])
+
+      assert.strictEqual(app.focus.findNext(source, Direction.RIGHT), moving)
+
+      moving.node.setPosition(EDGE_LEFT, 600)
+      moving.parent.node.calculateLayout(1000, 1000, DIRECTION_LTR)
+
+      assert.strictEqual(app.focus.findNext(source, Direction.RIGHT), fixed)
+    })
+    it('should ignore unregistered views', () => {
+      const [ source, removed, remaining ] = createGrid([ [ 0, 0 ], [ 200, 0 ], [ 400, 0 ] ])
+
+      removed.updateProps({ ...removed.props, focusable: false })
+
+      assert.strictEqual(app.focus.findNext(source, Direction.RIGHT), remaining)
+    })
+    it('should ignore invisible views', () => {
+      const [ source, hidden, remaining ] = createGrid([ [ 0, 0 ], [ 200, 0 ], [ 400, 0 ] ])
+
+      hidden.updateProps({ ...hidden.props, visible: false })
+      assert.strictEqual(app.focus.findNext(source, Direction.RIGHT), remaining)
+
+      hidden.updateProps({ ...hidden.props, visible: true })
+      assert.strictEqual(app.focus.findNext(source, Direction.RIGHT), hidden)
+    })
+    it('should ignore views in an invisible subtree', () => {
+      const [ source ] = createGrid([ [ 0, 0 ] ])
+      const container = createView(false, { position: 'absolute', left: 200, top: 0, width: 200, height: 100 })
+      const child = createView(true, { width: 100, height: 100 })
+
+      container.appendChild(child)
+      source.parent.appendChild(container)
+      source.parent.node.calculateLayout(1000, 1000, DIRECTION_LTR)
+      assert.strictEqual(app.focus.findNext(source, Direction.RIGHT), child)
+
+      container.updateProps({ ...container.props, visible: false })
+      assert.isNull(app.focus.findNext(source, Direction.RIGHT))
+    })
+    it('should ignore views removed from the tree until they are attached again', () => {
+      const [ source, removed ] = createGrid([ [ 0, 0 ], [ 200, 0 ] ])
+      const root = source.parent
+
+      root.removeChild(removed)
+      root.node.calculateLayout(1000, 1000, DIRECTION_LTR)
+      assert.isNull(app.focus.findNext(source, Direction.RIGHT))
+
+      root.appendChild(removed)
+      root.node.calculateLayout(1000, 1000, DIRECTION_LTR)
+      assert.strictEqual(app.focus.findNext(source, Direction.RIGHT), removed)
+    })
+  })
+  describe('destroy()', () => {
+    it('should release all indexed views', () => {
+      createGrid([ [ 0, 0 ], [ 200, 0 ] ])
+
+      assert.strictEqual(app.focus._index.getSize(), 2)
+      app.focus.destroy()
+      assert.strictEqual(app.focus._index.getSize(), 0)
+    })
   })
   beforeEach(() => {
     app = {
+      root: {},
       focus: new FocusManager(),
       layout: sinon.createStubInstance(LayoutManager),
       resource: sinon.createStubInstance(ResourceManager)
@@ -91,14 +189,30 @@ describe('FocusManager', () => {
     views.forEach(view => view.destroy())
     views.length = 0
   })
-  function createView (focusable = false) {
+  function createView (focusable = false, style = undefined) {
     const props = focusable ? { focusable, onFocus: sinon.stub(), onBlur: sinon.stub(), onKeyDown: sinon.stub() } : { focusable }
-    const view = new BoxView(props, app)
+    const view = new BoxView({ ...props, style }, app)
 
     views.push(view)
 
     return view
   }
+  function createGrid (positions) {
+    const root = new RootView(app)
+
+    views.push(root)
+    const cells = positions.map(([ left, top ]) => {
+      const cell = createView(true, { position: 'absolute', left, top, width: 100, height: 100 })
+
+      root.appendChild(cell)
+
+      return cell
+    })
+
+    root.node.calculateLayout(1000, 1000, DIRECTION_LTR)
+
+    return cells
+  }
 })
 
 function createKeyDown (key, direction) {
@@ -7,6 +7,8 @@
 import { assert } from 'chai'
 import { ImageView } from '../../../../lib/Core/Views/ImageView'
 import { View } from '../../../../lib/Core/Views/View'
+import { DIRECTION_LTR, Node } from '../../../../lib/Core/Util/Yoga'
+import { LayoutManager } from '../../../../lib/Core/Views/LayoutManager'
 
 describe('ImageView Test', () => {
   const app = {
@@ -39,6 +41,26 @@ describe('ImageView Test', () => {
     })
   })
 
+  describe('constructor()', () => {
+    it('should be created while an asynchronous layout is pending', async () => {
+      const layout = new LayoutManager({ async: true })
+      const root = Node.create()
+
+      root.setWidth(10)
+      layout.run(root, 100, 100)
+      assert.isTrue(layout.isPending())
+
+      view = new ImageView({ }, app)
+
+      await layout._pending
+      root.pushChild(view.node)
+      root.calculateLayout(100, 100, DIRECTION_LTR)
+
+      root.removeChild(view.node)
+      root.release()
+    })
+  })
+
   afterEach(() => {
     child && child.destroy()
     view && view.destroy()
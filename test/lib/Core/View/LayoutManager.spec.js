@@ -4,8 +4,10 @@
  * This source code is licensed under the MIT license found in the LICENSE file in the root directory of this source tree.
  */
 
+import { assert } from 'chai'
 import sinon from 'sinon'
 import { LayoutManager } from '../../../../lib/Core/Views/LayoutManager'
+import { Node } from '../../../../lib/Core/Util/Yoga'
 
 function mockYogaNode (dirty) {
   const node = {
@@ -26,7 +28,7 @@ describe('LayoutManager', () => {
 
       mock.expects('calculateLayout').never()
 
-      layout.run(mock.object, 100, 100)
+      assert.isFalse(layout.run(mock.object, 100, 100))
 
       mock.verify()
     })
@@ -36,9 +38,79 @@ describe('LayoutManager', () => {
 
       mock.expects('calculateLayout').once().withArgs(100, 100, 1)
 
-      layout.run(mock.object, 100, 100)
+      assert.isTrue(layout.run(mock.object, 100, 100))
 
       mock.verify()
     })
+    it('should call onLayout for listeners with a changed layout', () => {
+      const layout = new LayoutManager()
+      const root = Node.create()
+      const child = Node.create()
+      const view = { node: child, onLayout: sinon.spy() }
+
+      root.pushChild(child)
+      child.setWidth(50)
+      child.setHeight(25)
+      layout.on(view)
+
+      layout.run(root, 100, 100)
+      sinon.assert.calledOnce(view.onLayout)
+      sinon.assert.calledWith(view.onLayout, 0, 0, 50, 25)
+
+      const sibling = Node.create()
+
+      sibling.setHeight(10)
+      root.pushChild(sibling)
+      layout.run(root, 100, 100)
+      sinon.assert.calledOnce(view.onLayout)
+
+      layout.off(view)
+      root.release(true)
+    })
+    it('should calculate layout asynchronously when async is enabled', async () => {
+      const layout = new LayoutManager({ async: true })
+      const root = Node.create()
+      const child = Node.create()
+      const view = { node: child, onLayout: sinon.spy() }
+
+      root.pushChild(child)
+      child.setWidth(50)
+      child.setHeight(25)
+      layout.on(view)
+
+      assert.isFalse(layout.run(root, 100, 100))
+      assert.isTrue(layout.isPending())
+      assert.isFalse(layout.run(root, 100, 100))
+
+      await layout._pending
+
+      assert.isFalse(layout.isPending())
+      sinon.assert.calledOnce(view.onLayout)
+      sinon.assert.calledWith(view.onLayout, 0, 0, 50, 25)
+      assert.isTrue(layout.run(root, 100, 100))
+
+      layout.off(view)
+      root.release(true)
+    })
+    it('should fall back to synchronous layout when asynchronous layout fails', async () => {
+      const layout = new LayoutManager({ async: true })
+      const mock = mockYogaNode(true)
+      const consoleLog = sinon.stub(console, 'log')
+
+      mock.object.calculateLayoutAsync = () => Promise.reject(Error('layout failed'))
+      mock.expects('calculateLayout').once().withArgs(100, 100, 1)
+
+      try {
+        assert.isFalse(layout.run(mock.object, 100, 100))
+        await layout._pending
+      } finally {
+        consoleLog.restore()
+      }
+
+      mock.verify()
+      sinon.assert.calledOnce(consoleLog)
+      assert.isFalse(layout.isPending())
+      assert.isTrue(layout.run(mock.object, 100, 100))
+    })
   })
 })
@@ -9,6 +9,8 @@ import { Resource } from '../../../lib/Public/Resource'
 import { testSetApplication } from '../../../lib/Public'
 import sinon from 'sinon'
 import { ResourceManager } from '../../../lib/Core/Resource/ResourceManager'
+import { getPixelPoolStats } from '../../../lib/Core/Util/small-screen-lib'
+import { SDL } from '../../../lib/Core/Platform/small-screen-sdl'
 
 const IMAGES = [ 'one.png', 'two.png' ]
 const SAMPLES = [ 'one.wav', 'two.wav' ]
@@ -52,6 +54,16 @@ describe('Resource', () => {
       sinon.assert.calledWith(app.resource.addImage, SAMPLES[1])
     })
   })
+  describe('getImageMemoryStats()', () => {
+    it('should include the pixel pools of all native modules', () => {
+      const stats = Resource.getImageMemoryStats()
+      const pools = [ getPixelPoolStats(), SDL.getPixelPoolStats ? SDL.getPixelPoolStats() : {} ]
+
+      for (const key of [ 'usedBlocks', 'usedBytes', 'cachedBlocks', 'cachedBytes', 'hits', 'misses' ]) {
+        assert.equal(stats[key], pools.reduce((sum, pool) => sum + (pool[key] || 0), 0))
+      }
+    })
+  })
   beforeEach(() => {
     testSetApplication(app = {
       resource: sinon.createStubInstance(ResourceManager)